@@ -0,0 +1,211 @@
+/*
+ * Wire format shared by imu_tx (glove) and dongle_rx (dongle).
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _GLOVE_PROTO_H_
+#define _GLOVE_PROTO_H_
+
+#include <stdint.h>
+
+/*
+ * ESB payload (glove -> dongle)
+ *
+ * Byte 0 is a header. Bit 0 is the button state, which is where the original
+ * one-byte button flag lived, so a plain raw payload is unchanged on the air.
+ * Bit 1 says button edges are appended (Button_TrailerPacked). The upper
+ * nibble says what follows the header.
+ */
+#define PAYLOAD_BUTTON_MSK  0x01
+#define PAYLOAD_EDGES_MSK   0x02
+#define PAYLOAD_KIND_SHIFT  4
+#define PAYLOAD_KIND_MSK    0xF0
+
+#define PAYLOAD_HDR(kind, button) \
+	((uint8_t)(((kind) << PAYLOAD_KIND_SHIFT) | ((button) ? PAYLOAD_BUTTON_MSK : 0)))
+#define PAYLOAD_KIND(hdr)   (((hdr) & PAYLOAD_KIND_MSK) >> PAYLOAD_KIND_SHIFT)
+
+enum payload_kind {
+	PAYLOAD_KIND_RAW      = 0, /* IMU_DataPacked */
+	PAYLOAD_KIND_AHRS     = 1, /* AHRS_DataPacked */
+	PAYLOAD_KIND_RAW_AHRS = 2, /* IMU_DataPacked, then AHRS_DataPacked */
+	PAYLOAD_KIND_EVENT    = 3, /* Gesture_EventPacked */
+	PAYLOAD_KIND_RAW_BATCH = 4, /* IMU_DataPacked x N, oldest first, N from length */
+	PAYLOAD_KIND_STATUS   = 5, /* Glove_StatusPacked, after a Config_Packed */
+};
+
+/* On-glove attitude estimate. Quaternion is w, x, y, z (body -> world);
+ * linear acceleration is the body-frame accel with gravity removed, in m/s^2.
+ */
+typedef struct __attribute__((packed)) {
+	float q[4];
+	float lin_accel[3];
+} AHRS_DataPacked;
+
+enum gesture_type {
+	GESTURE_SLASH = 1,
+};
+
+/* Detected on the glove, sent instead of (or between) raw samples */
+typedef struct __attribute__((packed)) {
+	uint8_t type;      /* enum gesture_type */
+	uint32_t t_ms;     /* glove uptime at the acceleration peak */
+	int8_t dir[3];     /* unit direction of the peak, body frame, x127 */
+	uint16_t magnitude; /* peak linear accel, 0.01 m/s^2 */
+} Gesture_EventPacked;
+
+/*
+ * Button edges ride at the end of any payload with PAYLOAD_EDGES_MSK set:
+ *   payload | Button_EdgePacked x count, oldest first | Button_TrailerPacked
+ * The count is the last byte, so the dongle can take the edges off before
+ * the payload's own length rules apply. The glove repeats an edge in every
+ * payload until one carrying it is acked; seq tells repeats apart.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t seq;       /* counts edges, wraps */
+	uint8_t pressed;   /* 1: press, 0: release */
+	uint32_t t_us;     /* glove uptime at the first bounce, wraps */
+} Button_EdgePacked;
+
+typedef struct __attribute__((packed)) {
+	uint32_t now_us;   /* glove uptime when the payload was built */
+	uint8_t count;
+} Button_TrailerPacked;
+
+/* Most edges one payload carries */
+#define BUTTON_EDGES_MAX    4
+/* Most edges a glove holds unacked; anything older is dropped, not repeated */
+#define BUTTON_EDGE_WINDOW  8
+
+/*
+ * ACK payload (dongle -> glove)
+ *
+ * Rides on the ACK of the glove's next packet, so it always describes the
+ * packet before the one being acknowledged. Byte 0 says what follows.
+ */
+enum ack_kind {
+	ACK_KIND_BEACON = 1, /* Beacon_Packed */
+	ACK_KIND_CONFIG = 2, /* Config_Packed */
+};
+
+/* TDMA timing. Slot n starts n * slot_us into the dongle's superframe of
+ * n_slots * slot_us; a packet should finish guard_us after its slot starts.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t kind;       /* ACK_KIND_BEACON */
+	uint8_t slot;       /* slot assigned to this pipe */
+	uint8_t n_slots;
+	uint16_t slot_us;
+	uint16_t guard_us;
+	int16_t offset_us;  /* previous packet arrived this long after its target */
+} Beacon_Packed;
+
+/* Glove settings that can be changed at runtime */
+typedef struct __attribute__((packed)) {
+	uint16_t odr_hz;       /* accel/gyro output data rate */
+	uint8_t accel_fs_g;    /* 2, 4, 8 or 16 */
+	uint16_t gyro_fs_dps;  /* 125, 245, 500, 1000 or 2000 */
+	uint8_t batch;         /* raw samples per payload */
+	uint8_t stream;        /* enum payload_kind: RAW, AHRS or RAW_AHRS */
+} Glove_SettingsPacked;
+
+/* Which Glove_SettingsPacked fields a Config_Packed changes */
+#define CONFIG_FIELD_ODR      0x01
+#define CONFIG_FIELD_ACCEL_FS 0x02
+#define CONFIG_FIELD_GYRO_FS  0x04
+#define CONFIG_FIELD_BATCH    0x08
+#define CONFIG_FIELD_STREAM   0x10
+
+/* Settings change from the host. The dongle repeats it in ACK payloads
+ * until the glove answers with a Glove_StatusPacked carrying the same id;
+ * the glove applies each id once and answers every repeat.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t kind;          /* ACK_KIND_CONFIG */
+	uint8_t id;
+	uint8_t fields;        /* CONFIG_FIELD_* */
+	Glove_SettingsPacked settings;
+} Config_Packed;
+
+/* Glove -> dongle: settings in force after applying config id */
+typedef struct __attribute__((packed)) {
+	uint8_t id;
+	uint8_t rejected;      /* CONFIG_FIELD_* the glove could not apply */
+	Glove_SettingsPacked settings;
+} Glove_StatusPacked;
+
+/*
+ * Host frames (dongle -> Pi over USB)
+ *
+ * Sample frame (unchanged from the original protocol):
+ *   77 55 AA | pipe:u8 button:u8 seq:u16 accel:3f gyro:3f | crc16
+ *
+ * Extended frame, for everything that is not a plain raw sample:
+ *   77 55 AB | type:u8 len:u8 | body[len] | crc16
+ *
+ * CRC is CRC-16/CCITT-FALSE over everything between the header and the CRC,
+ * little-endian on the wire.
+ *
+ * The host sends commands the other way in the same extended frame, with
+ * enum host_cmd_type as the type.
+ */
+#define HOST_HEADER0        0x77
+#define HOST_HEADER1        0x55
+#define HOST_HEADER2_SAMPLE 0xAA
+#define HOST_HEADER2_EXT    0xAB
+
+enum host_frame_type {
+	HOST_FRAME_AHRS    = 1, /* pipe:u8 button:u8 seq:u16 AHRS_DataPacked */
+	HOST_FRAME_GESTURE = 2, /* pipe:u8 button:u8 Gesture_EventPacked */
+	HOST_FRAME_STATS   = 3, /* Dongle_StatsPacked */
+	HOST_FRAME_SAMPLE_TS = 4, /* pipe:u8 button:u8 seq:u16 rx_us:u32 out_us:u32 IMU_DataPacked */
+	HOST_FRAME_MULTI   = 5, /* present:u8, then Multi_EntryPacked per set bit */
+	HOST_FRAME_GLOVE_STATUS = 6, /* pipe:u8 Glove_StatusPacked */
+	HOST_FRAME_BUTTON  = 7, /* pipe:u8 Button_EdgePacked age_us:u32 */
+};
+
+enum host_cmd_type {
+	HOST_CMD_GLOVE_CONFIG = 1, /* pipe:u8 id:u8 fields:u8 Glove_SettingsPacked */
+};
+
+/*
+ * HOST_FRAME_SAMPLE_TS replaces the sample frame on dongles built with
+ * CONFIG_DONGLE_RX_TIMESTAMP. Both times are dongle microseconds, wrapping
+ * at 2^32: rx_us when the radio handed the packet over, out_us when the
+ * frame was queued for USB. Samples unpacked from one RAW_BATCH payload
+ * share rx_us.
+ */
+
+/*
+ * HOST_FRAME_BUTTON is one button edge, sent once however many payloads
+ * repeated it. age_us is how long before the glove built the payload that
+ * got through the edge happened; t_us differences give exact press lengths.
+ */
+
+/*
+ * HOST_FRAME_MULTI replaces the sample frame on dongles built with
+ * CONFIG_DONGLE_RX_AGGREGATE: raw samples from every glove heard within a
+ * short window under one header and CRC. Bit n of present means pipe n has
+ * an entry; entries follow in pipe order.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t button;
+	uint16_t seq;           /* as the sample frame would have carried */
+	uint8_t imu[24];        /* IMU_DataPacked: accel x,y,z, gyro x,y,z as float */
+} Multi_EntryPacked;
+
+/* Counters since the dongle booted, one entry per ESB pipe */
+typedef struct __attribute__((packed)) {
+	uint32_t received;       /* ESB payloads read from the RX FIFO */
+	uint32_t queue_dropped;  /* frames lost because the USB ring was full */
+	uint32_t fifo_overrun;   /* RX FIFO found full with this pipe's packets in it */
+} Pipe_StatsPacked;
+
+typedef struct __attribute__((packed)) {
+	uint32_t uptime_ms;
+	uint16_t ring_high_water; /* deepest the USB ring got since the last frame */
+	uint16_t ring_size;
+	Pipe_StatsPacked pipe[8];
+} Dongle_StatsPacked;
+
+#endif
@@ -0,0 +1,325 @@
+/*
+ * Building and taking apart the messages in glove_proto.h.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include "glove_wire.h"
+
+#include <string.h>
+
+uint16_t wire_crc16(const uint8_t *data, size_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (size_t i = 0; i < len; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int j = 0; j < 8; j++) {
+			if (crc & 0x8000) {
+				crc = (crc << 1) ^ 0x1021;
+			} else {
+				crc <<= 1;
+			}
+		}
+	}
+	return crc;
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)(v & 0xFF);
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+	put_le16(p, (uint16_t)(v & 0xFFFF));
+	put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+size_t wire_sample_payload(uint8_t *out, uint8_t kind, bool button,
+			   const void *imu, const AHRS_DataPacked *ahrs)
+{
+	size_t len = 1;
+
+	out[0] = PAYLOAD_HDR(kind, button);
+	if (kind != PAYLOAD_KIND_AHRS) {
+		memcpy(&out[len], imu, WIRE_IMU_BYTES);
+		len += WIRE_IMU_BYTES;
+	}
+	if (kind != PAYLOAD_KIND_RAW) {
+		memcpy(&out[len], ahrs, sizeof(*ahrs));
+		len += sizeof(*ahrs);
+	}
+	return len;
+}
+
+size_t wire_batch_payload(uint8_t *out, bool button, const void *const *imu, uint8_t n)
+{
+	size_t len = 1;
+
+	out[0] = PAYLOAD_HDR(PAYLOAD_KIND_RAW_BATCH, button);
+	for (uint8_t i = 0; i < n; i++) {
+		memcpy(&out[len], imu[i], WIRE_IMU_BYTES);
+		len += WIRE_IMU_BYTES;
+	}
+	return len;
+}
+
+size_t wire_event_payload(uint8_t *out, bool button, const Gesture_EventPacked *ev)
+{
+	out[0] = PAYLOAD_HDR(PAYLOAD_KIND_EVENT, button);
+	memcpy(&out[1], ev, sizeof(*ev));
+	return 1 + sizeof(*ev);
+}
+
+size_t wire_status_payload(uint8_t *out, const Glove_StatusPacked *st)
+{
+	out[0] = PAYLOAD_HDR(PAYLOAD_KIND_STATUS, false);
+	memcpy(&out[1], st, sizeof(*st));
+	return 1 + sizeof(*st);
+}
+
+size_t wire_append_edges(uint8_t *out, size_t len, size_t max_len,
+			 const Button_EdgePacked *edges, uint8_t n, uint32_t now_us,
+			 uint8_t *added)
+{
+	Button_TrailerPacked trailer = { .now_us = now_us };
+	size_t room = max_len > len + sizeof(trailer) ? max_len - len - sizeof(trailer) : 0;
+	size_t fit = room / sizeof(Button_EdgePacked);
+
+	if (n > BUTTON_EDGES_MAX) {
+		n = BUTTON_EDGES_MAX;
+	}
+	trailer.count = (uint8_t)(fit < n ? fit : n);
+	*added = trailer.count;
+	if (trailer.count == 0) {
+		return len;
+	}
+
+	memcpy(&out[len], edges, trailer.count * sizeof(Button_EdgePacked));
+	len += trailer.count * sizeof(Button_EdgePacked);
+	memcpy(&out[len], &trailer, sizeof(trailer));
+	out[0] |= PAYLOAD_EDGES_MSK;
+	return len + sizeof(trailer);
+}
+
+/* Length of the edges and trailer at the end of a payload, 0 if none, -1 if malformed */
+static int edges_len(const uint8_t *data, size_t len)
+{
+	if (len < 1 || !(data[0] & PAYLOAD_EDGES_MSK)) {
+		return 0;
+	}
+
+	uint8_t count = data[len - 1];
+	size_t n = sizeof(Button_TrailerPacked) + count * sizeof(Button_EdgePacked);
+
+	if (count == 0 || count > BUTTON_EDGES_MAX || len < 1 + n) {
+		return -1;
+	}
+	return (int)n;
+}
+
+bool wire_payload_last_edge(const uint8_t *data, size_t len, uint8_t *seq)
+{
+	int n = edges_len(data, len);
+	Button_EdgePacked edge;
+
+	if (n <= 0) {
+		return false;
+	}
+	memcpy(&edge, &data[len - sizeof(Button_TrailerPacked) - sizeof(edge)], sizeof(edge));
+	*seq = edge.seq;
+	return true;
+}
+
+size_t wire_payload_min_len(uint8_t kind)
+{
+	switch (kind) {
+	case PAYLOAD_KIND_RAW:
+		return 1 + WIRE_IMU_BYTES;
+	case PAYLOAD_KIND_AHRS:
+		return 1 + sizeof(AHRS_DataPacked);
+	case PAYLOAD_KIND_RAW_AHRS:
+		return 1 + WIRE_IMU_BYTES + sizeof(AHRS_DataPacked);
+	case PAYLOAD_KIND_EVENT:
+		return 1 + sizeof(Gesture_EventPacked);
+	case PAYLOAD_KIND_RAW_BATCH:
+		return 1 + WIRE_IMU_BYTES;
+	case PAYLOAD_KIND_STATUS:
+		return 1 + sizeof(Glove_StatusPacked);
+	default:
+		return 0;
+	}
+}
+
+int wire_unpack_payload(uint8_t pipe, const uint8_t *data, size_t len,
+			uint32_t rx_us, wire_frame_fn fn, void *ctx)
+{
+	int trailer = edges_len(data, len);
+
+	if (len < 1 || trailer < 0) {
+		return -1;
+	}
+	len -= (size_t)trailer;
+
+	uint8_t kind = PAYLOAD_KIND(data[0]);
+	size_t expected = wire_payload_min_len(kind);
+
+	if (expected == 0 || len < expected) {
+		return -1;
+	}
+
+	struct wire_frame frame;
+	const uint8_t *p = &data[1];
+	int edges = 0;
+
+	memset(&frame, 0, sizeof(frame));
+	frame.pipe = pipe;
+	frame.button = data[0] & PAYLOAD_BUTTON_MSK;
+	frame.rx_us = rx_us;
+
+	if (trailer > 0) {
+		Button_TrailerPacked t;
+		const uint8_t *e = &data[len];
+
+		memcpy(&t, &data[len + trailer - sizeof(t)], sizeof(t));
+		frame.kind = WIRE_KIND_BUTTON;
+		for (edges = 0; edges < t.count; edges++) {
+			memcpy(&frame.edge, e, sizeof(frame.edge));
+			e += sizeof(frame.edge);
+			frame.edge_age_us = t.now_us - frame.edge.t_us;
+			fn(&frame, ctx);
+		}
+		memset(&frame.edge, 0, sizeof(frame.edge));
+		frame.edge_age_us = 0;
+	}
+	frame.kind = kind;
+
+	switch (kind) {
+	case PAYLOAD_KIND_RAW_BATCH: {
+		// Unpacked here, the host sees ordinary sample frames
+		int n = (int)((len - 1) / WIRE_IMU_BYTES);
+
+		frame.kind = PAYLOAD_KIND_RAW;
+		for (int i = 0; i < n; i++) {
+			memcpy(frame.imu, p, WIRE_IMU_BYTES);
+			p += WIRE_IMU_BYTES;
+			fn(&frame, ctx);
+		}
+		return edges + n;
+	}
+	case PAYLOAD_KIND_EVENT:
+		memcpy(&frame.event, p, sizeof(frame.event));
+		break;
+	case PAYLOAD_KIND_STATUS:
+		memcpy(&frame.status, p, sizeof(frame.status));
+		break;
+	default:
+		if (kind != PAYLOAD_KIND_AHRS) {
+			memcpy(frame.imu, p, WIRE_IMU_BYTES);
+			p += WIRE_IMU_BYTES;
+		}
+		if (kind != PAYLOAD_KIND_RAW) {
+			memcpy(&frame.ahrs, p, sizeof(frame.ahrs));
+		}
+		break;
+	}
+
+	fn(&frame, ctx);
+	return edges + 1;
+}
+
+/* Extended frame: header + type + len + body + crc(type, len, body) */
+size_t wire_ext_frame(uint8_t *out, uint8_t type, const uint8_t *body, uint8_t len)
+{
+	size_t n = 0;
+
+	out[n++] = HOST_HEADER0;
+	out[n++] = HOST_HEADER1;
+	out[n++] = HOST_HEADER2_EXT;
+	out[n++] = type;
+	out[n++] = len;
+	memcpy(&out[n], body, len);
+	n += len;
+
+	put_le16(&out[n], wire_crc16(&out[3], n - 3));
+	return n + 2;
+}
+
+/* Legacy fixed-size sample frame: header + pipe + button + seq + imu + crc(payload) */
+size_t wire_sample_frame(uint8_t *out, const struct wire_frame *f, uint16_t seq)
+{
+	size_t n = 0;
+
+	out[n++] = HOST_HEADER0;
+	out[n++] = HOST_HEADER1;
+	out[n++] = HOST_HEADER2_SAMPLE;
+	out[n++] = f->pipe;
+	out[n++] = f->button;
+	put_le16(&out[n], seq);
+	n += 2;
+	memcpy(&out[n], f->imu, WIRE_IMU_BYTES);
+	n += WIRE_IMU_BYTES;
+
+	put_le16(&out[n], wire_crc16(&out[3], n - 3));
+	return n + 2;
+}
+
+size_t wire_timed_sample_frame(uint8_t *out, const struct wire_frame *f, uint16_t seq,
+			       uint32_t out_us)
+{
+	uint8_t body[1 + 1 + 2 + 4 + 4 + WIRE_IMU_BYTES];
+
+	body[0] = f->pipe;
+	body[1] = f->button;
+	put_le16(&body[2], seq);
+	put_le32(&body[4], f->rx_us);
+	put_le32(&body[8], out_us);
+	memcpy(&body[12], f->imu, WIRE_IMU_BYTES);
+
+	return wire_ext_frame(out, HOST_FRAME_SAMPLE_TS, body, sizeof(body));
+}
+
+size_t wire_ahrs_frame(uint8_t *out, const struct wire_frame *f, uint16_t seq)
+{
+	uint8_t body[1 + 1 + 2 + sizeof(AHRS_DataPacked)];
+
+	body[0] = f->pipe;
+	body[1] = f->button;
+	put_le16(&body[2], seq);
+	memcpy(&body[4], &f->ahrs, sizeof(AHRS_DataPacked));
+
+	return wire_ext_frame(out, HOST_FRAME_AHRS, body, sizeof(body));
+}
+
+size_t wire_gesture_frame(uint8_t *out, const struct wire_frame *f)
+{
+	uint8_t body[1 + 1 + sizeof(Gesture_EventPacked)];
+
+	body[0] = f->pipe;
+	body[1] = f->button;
+	memcpy(&body[2], &f->event, sizeof(Gesture_EventPacked));
+
+	return wire_ext_frame(out, HOST_FRAME_GESTURE, body, sizeof(body));
+}
+
+size_t wire_status_frame(uint8_t *out, const struct wire_frame *f)
+{
+	uint8_t body[1 + sizeof(Glove_StatusPacked)];
+
+	body[0] = f->pipe;
+	memcpy(&body[1], &f->status, sizeof(Glove_StatusPacked));
+
+	return wire_ext_frame(out, HOST_FRAME_GLOVE_STATUS, body, sizeof(body));
+}
+
+size_t wire_button_frame(uint8_t *out, const struct wire_frame *f)
+{
+	uint8_t body[1 + sizeof(Button_EdgePacked) + 4];
+
+	body[0] = f->pipe;
+	memcpy(&body[1], &f->edge, sizeof(Button_EdgePacked));
+	put_le32(&body[1 + sizeof(Button_EdgePacked)], f->edge_age_us);
+
+	return wire_ext_frame(out, HOST_FRAME_BUTTON, body, sizeof(body));
+}
@@ -0,0 +1,87 @@
+/*
+ * Building and taking apart the messages in glove_proto.h.
+ *
+ * Shared by imu_tx, dongle_rx and the Linux simulation in
+ * microcontroller/host, so the simulated pipeline runs the same packing,
+ * unpacking, framing and CRC code as the hardware. Plain C, no Zephyr.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _GLOVE_WIRE_H_
+#define _GLOVE_WIRE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glove_proto.h"
+
+/* IMU_DataPacked: accel x,y,z then gyro x,y,z, float */
+#define WIRE_IMU_BYTES 24
+
+/* Largest host frame: extended header, type, len, body, crc */
+#define WIRE_FRAME_MAX (3 + 2 + UINT8_MAX + 2)
+
+/* wire_frame.kind of a button edge taken off a payload's trailer */
+#define WIRE_KIND_BUTTON 0x10
+
+/* One sample, event, status or button edge from a glove payload, as the dongle queues it */
+struct wire_frame {
+	uint8_t pipe;
+	uint8_t button;
+	uint8_t kind;               /* enum payload_kind, RAW for unpacked batches, or WIRE_KIND_BUTTON */
+	uint32_t rx_us;             /* dongle receive time, 0 if not kept */
+	uint8_t imu[WIRE_IMU_BYTES];
+	AHRS_DataPacked ahrs;
+	Gesture_EventPacked event;
+	Glove_StatusPacked status;
+	Button_EdgePacked edge;
+	uint32_t edge_age_us;       /* edge to payload built, glove clock */
+};
+
+typedef void (*wire_frame_fn)(const struct wire_frame *frame, void *ctx);
+
+uint16_t wire_crc16(const uint8_t *data, size_t len);
+
+/* Glove side: build an ESB payload into out, return its length */
+size_t wire_sample_payload(uint8_t *out, uint8_t kind, bool button,
+			   const void *imu, const AHRS_DataPacked *ahrs);
+size_t wire_batch_payload(uint8_t *out, bool button, const void *const *imu, uint8_t n);
+size_t wire_event_payload(uint8_t *out, bool button, const Gesture_EventPacked *ev);
+size_t wire_status_payload(uint8_t *out, const Glove_StatusPacked *st);
+
+/*
+ * Append up to n button edges to a built payload of len bytes, as many as
+ * fit in max_len, and set PAYLOAD_EDGES_MSK. Returns the new length; the
+ * number appended is written to *added.
+ */
+size_t wire_append_edges(uint8_t *out, size_t len, size_t max_len,
+			 const Button_EdgePacked *edges, uint8_t n, uint32_t now_us,
+			 uint8_t *added);
+
+/* seq of the newest edge a payload carries; false if it carries none */
+bool wire_payload_last_edge(const uint8_t *data, size_t len, uint8_t *seq);
+
+/* Shortest valid payload of this kind, 0 if the kind is unknown */
+size_t wire_payload_min_len(uint8_t kind);
+
+/*
+ * Dongle side: call fn once per frame in the payload, a batch giving one
+ * RAW frame per sample and appended button edges one WIRE_KIND_BUTTON
+ * frame each, ahead of the rest. Returns the number of frames, or -1 if the payload
+ * is malformed (nothing is called).
+ */
+int wire_unpack_payload(uint8_t pipe, const uint8_t *data, size_t len,
+			uint32_t rx_us, wire_frame_fn fn, void *ctx);
+
+/* Host frames, written into out (WIRE_FRAME_MAX bytes), return the length */
+size_t wire_ext_frame(uint8_t *out, uint8_t type, const uint8_t *body, uint8_t len);
+size_t wire_sample_frame(uint8_t *out, const struct wire_frame *f, uint16_t seq);
+size_t wire_timed_sample_frame(uint8_t *out, const struct wire_frame *f, uint16_t seq,
+			       uint32_t out_us);
+size_t wire_ahrs_frame(uint8_t *out, const struct wire_frame *f, uint16_t seq);
+size_t wire_gesture_frame(uint8_t *out, const struct wire_frame *f);
+size_t wire_status_frame(uint8_t *out, const struct wire_frame *f);
+size_t wire_button_frame(uint8_t *out, const struct wire_frame *f);
+
+#endif
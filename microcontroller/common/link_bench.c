@@ -0,0 +1,105 @@
+/*
+ * ESB link benchmark: the sweep, the messages and the results.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include "link_bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Payload 9 is the smallest data packet, 25 one raw sample, 97 a batch of
+ * 4. 600 us x 3 is what the glove uses.
+ */
+#define POINTS_FOR(len, kbps) \
+	{ len, kbps,  600, 3, true }, \
+	{ len, kbps, 1500, 3, true }, \
+	{ len, kbps,  600, 8, true }, \
+	{ len, kbps,  600, 0, true }, \
+	{ len, kbps,    0, 0, false }
+
+const struct link_bench_point link_bench_points[] = {
+	POINTS_FOR(9, 2000),
+	POINTS_FOR(25, 2000),
+	POINTS_FOR(97, 2000),
+	POINTS_FOR(LINK_BENCH_PAYLOAD_MAX, 2000),
+	POINTS_FOR(9, 1000),
+	POINTS_FOR(25, 1000),
+	POINTS_FOR(97, 1000),
+	POINTS_FOR(LINK_BENCH_PAYLOAD_MAX, 1000),
+};
+
+const size_t link_bench_point_count =
+	sizeof(link_bench_points) / sizeof(link_bench_points[0]);
+
+const char link_bench_header[] =
+	"source,payload,bitrate_kbps,delay_us,count,ack,seconds,sent,acked,failed,"
+	"retransmits,prx_received,pkt_per_s,goodput_kbps,rtt_p50_us,rtt_p99_us,"
+	"rtt_max_us,echo_bad";
+
+void link_bench_reset(struct link_bench_result *r)
+{
+	memset(r, 0, sizeof(*r));
+}
+
+void link_bench_add_rtt(struct link_bench_result *r, uint32_t us)
+{
+	uint32_t bin = us / LINK_BENCH_RTT_BIN_US;
+
+	if (bin >= LINK_BENCH_RTT_BINS) {
+		bin = LINK_BENCH_RTT_BINS - 1;
+	}
+	if (r->rtt_hist[bin] != UINT16_MAX) {
+		r->rtt_hist[bin]++;
+	}
+	if (us > r->rtt_max_us) {
+		r->rtt_max_us = us;
+	}
+}
+
+uint32_t link_bench_rtt_percentile(const struct link_bench_result *r, uint32_t permille)
+{
+	uint32_t total = 0, seen = 0;
+
+	for (int i = 0; i < LINK_BENCH_RTT_BINS; i++) {
+		total += r->rtt_hist[i];
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	uint32_t want = (total * permille + 999) / 1000;
+
+	for (int i = 0; i < LINK_BENCH_RTT_BINS; i++) {
+		seen += r->rtt_hist[i];
+		if (seen >= want) {
+			/* Upper edge of the bin, never past the slowest seen */
+			uint32_t us = (uint32_t)(i + 1) * LINK_BENCH_RTT_BIN_US;
+
+			return us < r->rtt_max_us ? us : r->rtt_max_us;
+		}
+	}
+	return r->rtt_max_us;
+}
+
+int link_bench_format(char *buf, size_t len, const char *source,
+		      const struct link_bench_point *p, const struct link_bench_result *r)
+{
+	/* Integer maths only: the firmware may be built without float printf */
+	uint32_t ms = r->elapsed_us / 1000 ? r->elapsed_us / 1000 : 1;
+	uint32_t pkt_per_s = (uint32_t)((uint64_t)r->prx_received * 1000 / ms);
+	uint32_t goodput_kbps = (uint32_t)((uint64_t)r->prx_received * p->payload_len * 8 / ms);
+
+	return snprintf(buf, len,
+			"%s,%u,%u,%u,%u,%u,%u.%03u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u",
+			source, p->payload_len, p->bitrate_kbps,
+			p->retransmit_delay_us, p->retransmit_count, p->ack ? 1 : 0,
+			(unsigned)(ms / 1000), (unsigned)(ms % 1000),
+			(unsigned)r->sent, (unsigned)r->acked, (unsigned)r->failed,
+			(unsigned)r->retransmits, (unsigned)r->prx_received,
+			(unsigned)pkt_per_s, (unsigned)goodput_kbps,
+			(unsigned)link_bench_rtt_percentile(r, 500),
+			(unsigned)link_bench_rtt_percentile(r, 990),
+			(unsigned)r->rtt_max_us, (unsigned)r->echo_bad);
+}
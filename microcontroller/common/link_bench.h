@@ -0,0 +1,110 @@
+/*
+ * ESB link benchmark: the sweep, the messages and the results.
+ *
+ * Shared by demos/esb_ptx_test and demos/esb_prx_test, which run it on
+ * hardware, and host/link_bench, which runs the same sweep over the
+ * simulated channel, so both print lines that can be compared directly.
+ *
+ * The PTX drives the sweep. Control messages always go at 2 Mbps; for each
+ * point the PTX sends LINK_BENCH_START, both sides switch to the point's
+ * bitrate, the PTX sends back to back for the point's duration, then both
+ * go back to 2 Mbps and the PTX collects the PRX's counts with
+ * LINK_BENCH_REPORT.
+ *
+ * Every data packet carries the PTX's clock at the start of its first
+ * attempt. The PRX echoes the last one it got in its ACK payloads; ESB
+ * loads an ACK payload before the packet it answers arrives, so the echo
+ * is of the packet before. The PTX checks echoes against what it sent and
+ * times each packet from its own stamp to the ACK.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _LINK_BENCH_H_
+#define _LINK_BENCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LINK_BENCH_PAYLOAD_MAX  192     /* CONFIG_ESB_MAX_PAYLOAD_LENGTH */
+#define LINK_BENCH_CTRL_KBPS    2000
+#define LINK_BENCH_RTT_BIN_US   10
+#define LINK_BENCH_RTT_BINS     1024    /* the last bin takes everything longer */
+
+/*
+ * Point timing, from the PTX seeing START acked: the PRX switches bitrate
+ * at SWITCH_MS, the PTX sends from SETTLE_MS for the point's duration, the
+ * PRX goes back to 2 Mbps at duration + REVERT_MS and the PTX asks for the
+ * report from duration + REPORT_MS.
+ */
+#define LINK_BENCH_SWITCH_MS    2
+#define LINK_BENCH_SETTLE_MS    5
+#define LINK_BENCH_REVERT_MS    25
+#define LINK_BENCH_REPORT_MS    40
+
+enum link_bench_msg {
+	LINK_BENCH_DATA   = 0xB0,   /* Bench_DataPacked, padded to the point's length */
+	LINK_BENCH_START  = 0xB1,   /* Bench_CtrlPacked */
+	LINK_BENCH_REPORT = 0xB2,   /* Bench_CtrlPacked */
+};
+
+typedef struct __attribute__((packed)) {
+	uint8_t type;
+	uint32_t seq;
+	uint32_t tx_stamp;      /* PTX clock, only meaningful to the PTX */
+} Bench_DataPacked;
+
+typedef struct __attribute__((packed)) {
+	uint8_t type;
+	uint8_t point;          /* index into link_bench_points */
+	uint16_t duration_ms;   /* how long the PTX sends for */
+} Bench_CtrlPacked;
+
+/* PRX ACK payload */
+typedef struct __attribute__((packed)) {
+	uint8_t point;
+	uint8_t report;         /* 1: answer to LINK_BENCH_REPORT, counts are final */
+	uint32_t received;      /* data packets this point, ESB drops duplicates */
+	uint32_t bytes;
+	uint32_t echo_seq;
+	uint32_t echo_stamp;
+} Bench_AckPacked;
+
+struct link_bench_point {
+	uint8_t payload_len;
+	uint16_t bitrate_kbps;
+	uint16_t retransmit_delay_us;
+	uint8_t retransmit_count;
+	bool ack;
+};
+
+struct link_bench_result {
+	uint32_t elapsed_us;
+	uint32_t sent;          /* payloads given to the radio */
+	uint32_t acked;
+	uint32_t failed;
+	uint32_t retransmits;
+	uint32_t prx_received;
+	uint32_t echo_bad;      /* ACK payload echo that matches nothing sent */
+	uint32_t rtt_max_us;
+	uint16_t rtt_hist[LINK_BENCH_RTT_BINS];
+};
+
+extern const struct link_bench_point link_bench_points[];
+extern const size_t link_bench_point_count;
+
+/* CSV header line, without the newline */
+extern const char link_bench_header[];
+
+void link_bench_reset(struct link_bench_result *r);
+
+void link_bench_add_rtt(struct link_bench_result *r, uint32_t us);
+
+/* permille of the acked packets came back within the returned time */
+uint32_t link_bench_rtt_percentile(const struct link_bench_result *r, uint32_t permille);
+
+/* One CSV line for the point, without the newline; returns snprintf's length */
+int link_bench_format(char *buf, size_t len, const char *source,
+		      const struct link_bench_point *p, const struct link_bench_result *r);
+
+#endif
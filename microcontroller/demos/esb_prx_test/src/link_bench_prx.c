@@ -0,0 +1,141 @@
+/*
+ * ESB link benchmark, receiver side. See common/link_bench.h.
+ *
+ * Counts the data packets of the current point and keeps one ACK payload
+ * loaded with the counts and the last packet's stamp. Bitrate changes need
+ * the radio stopped, so they run from the system work queue.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <esb.h>
+#include <string.h>
+
+#include "link_bench.h"
+#include "link_bench_prx.h"
+
+LOG_MODULE_REGISTER(link_bench_prx, CONFIG_ESB_PRX_APP_LOG_LEVEL);
+
+BUILD_ASSERT(CONFIG_ESB_MAX_PAYLOAD_LENGTH >= LINK_BENCH_PAYLOAD_MAX);
+
+static struct esb_payload rx_payload;
+static struct esb_payload ack_payload;
+
+static Bench_AckPacked counts = {
+	.point = UINT8_MAX,
+	.echo_seq = UINT32_MAX,
+};
+static bool counting;
+static uint16_t point_kbps;
+
+static void switch_handler(struct k_work *work);
+static void revert_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(switch_work, switch_handler);
+static K_WORK_DELAYABLE_DEFINE(revert_work, revert_handler);
+
+static void set_bitrate(uint16_t kbps)
+{
+	int err;
+
+	esb_stop_rx();
+	err = esb_set_bitrate(kbps >= 2000 ? ESB_BITRATE_2MBPS : ESB_BITRATE_1MBPS);
+	if (err) {
+		LOG_ERR("Bitrate change failed, err %d", err);
+	}
+	err = esb_start_rx();
+	if (err) {
+		LOG_ERR("RX restart failed, err %d", err);
+	}
+}
+
+static void switch_handler(struct k_work *work)
+{
+	set_bitrate(point_kbps);
+}
+
+static void revert_handler(struct k_work *work)
+{
+	counting = false;
+	set_bitrate(LINK_BENCH_CTRL_KBPS);
+}
+
+/* Queue the counts as the next ACK payload; a full FIFO keeps the old ones */
+static void load_ack(void)
+{
+	ack_payload.pipe = 0;
+	ack_payload.length = sizeof(counts);
+	memcpy(ack_payload.data, &counts, sizeof(counts));
+	(void)esb_write_payload(&ack_payload);
+}
+
+static void handle_payload(const struct esb_payload *p)
+{
+	Bench_DataPacked d;
+	Bench_CtrlPacked c;
+
+	switch (p->data[0]) {
+	case LINK_BENCH_DATA:
+		if (!counting || p->length < sizeof(d)) {
+			break;
+		}
+		memcpy(&d, p->data, sizeof(d));
+		counts.received++;
+		counts.bytes += p->length;
+		counts.echo_seq = d.seq;
+		counts.echo_stamp = d.tx_stamp;
+		load_ack();
+		break;
+	case LINK_BENCH_START:
+		if (p->length < sizeof(c)) {
+			break;
+		}
+		memcpy(&c, p->data, sizeof(c));
+		if (c.point >= link_bench_point_count ||
+		    (counting && c.point == counts.point)) {
+			break;
+		}
+		memset(&counts, 0, sizeof(counts));
+		counts.point = c.point;
+		counts.echo_seq = UINT32_MAX;
+		counting = true;
+		point_kbps = link_bench_points[c.point].bitrate_kbps;
+
+		esb_flush_tx();
+		load_ack();
+		k_work_reschedule(&switch_work, K_MSEC(LINK_BENCH_SWITCH_MS));
+		k_work_reschedule(&revert_work, K_MSEC(c.duration_ms + LINK_BENCH_REVERT_MS));
+		break;
+	case LINK_BENCH_REPORT:
+		if (p->length < sizeof(c)) {
+			break;
+		}
+		memcpy(&c, p->data, sizeof(c));
+		if (c.point != counts.point) {
+			break;
+		}
+		counting = false;
+		counts.report = 1;
+		esb_flush_tx();
+		load_ack();
+		break;
+	}
+}
+
+void link_bench_prx_event(struct esb_evt const *event)
+{
+	if (event->evt_id != ESB_EVENT_RX_RECEIVED) {
+		return;
+	}
+	while (esb_read_rx_payload(&rx_payload) == 0) {
+		handle_payload(&rx_payload);
+	}
+}
+
+int link_bench_prx_init(void)
+{
+	ack_payload.pipe = 0;
+	ack_payload.length = sizeof(counts);
+	memcpy(ack_payload.data, &counts, sizeof(counts));
+	return esb_write_payload(&ack_payload);
+}
@@ -0,0 +1,17 @@
+/*
+ * ESB link benchmark, receiver side. See common/link_bench.h.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _LINK_BENCH_PRX_H_
+#define _LINK_BENCH_PRX_H_
+
+#include <esb.h>
+
+/* ESB event handler while the benchmark runs */
+void link_bench_prx_event(struct esb_evt const *event);
+
+/* Load the first ACK payload; call before esb_start_rx() */
+int link_bench_prx_init(void);
+
+#endif
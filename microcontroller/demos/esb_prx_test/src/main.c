@@ -15,6 +15,9 @@
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
 #include <dk_buttons_and_leds.h>
+#if defined(CONFIG_ESB_PRX_LINK_BENCH)
+#include "link_bench_prx.h"
+#endif
 #if defined(CONFIG_CLOCK_CONTROL_NRF2)
 #include <hal/nrf_lrcconf.h>
 #endif
@@ -45,6 +48,10 @@ static void leds_update(uint8_t value)
 
 void event_handler(struct esb_evt const *event)
 {
+#if defined(CONFIG_ESB_PRX_LINK_BENCH)
+	link_bench_prx_event(event);
+	return;
+#endif
 	switch (event->evt_id) {
 	case ESB_EVENT_TX_SUCCESS:
 		LOG_DBG("TX SUCCESS EVENT");
@@ -224,7 +231,12 @@ int main(void)
 
 	LOG_INF("Initialization complete");
 
+#if defined(CONFIG_ESB_PRX_LINK_BENCH)
+	LOG_INF("Running link benchmark");
+	err = link_bench_prx_init();
+#else
 	err = esb_write_payload(&tx_payload);
+#endif
 	if (err) {
 		LOG_ERR("Write payload, err %d", err);
 		return 0;
@@ -0,0 +1,257 @@
+/*
+ * ESB link benchmark, transmitter side. See common/link_bench.h.
+ *
+ * One payload is in flight at a time and the next is written from the
+ * event handler as soon as the last one is acked or given up, so the
+ * point measures the link and not the thread. Times come from the DWT
+ * cycle counter; the kernel clock is a 32 kHz RTC on nRF52.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include <nrf.h>
+#include <esb.h>
+#include <string.h>
+
+#include "link_bench.h"
+#include "link_bench_ptx.h"
+
+LOG_MODULE_REGISTER(link_bench_ptx, CONFIG_ESB_PTX_APP_LOG_LEVEL);
+
+BUILD_ASSERT(sizeof(Bench_DataPacked) <= 9, "smallest point must hold a data packet");
+BUILD_ASSERT(CONFIG_ESB_MAX_PAYLOAD_LENGTH >= LINK_BENCH_PAYLOAD_MAX);
+
+#define BASE_DELAY_US   600
+#define BASE_COUNT      3
+#define CTRL_TRIES      50
+#define STAMP_RING      16      /* sent stamps kept to check ACK payload echoes */
+
+static K_SEM_DEFINE(tx_done_sem, 0, 1);
+static struct esb_payload tx_payload;
+static struct esb_payload rx_payload;
+
+static const struct link_bench_point *point;
+static struct link_bench_result result;
+static atomic_t running;
+static bool in_point;
+static bool last_ok;
+static uint32_t seq;
+static uint32_t stamps[STAMP_RING];
+static uint32_t first_cycles, last_cycles;
+static uint32_t cycles_per_us;
+
+static Bench_AckPacked report;
+static bool report_valid;
+
+static void send_data(void)
+{
+	Bench_DataPacked d = {
+		.type = LINK_BENCH_DATA,
+		.seq = seq,
+		.tx_stamp = DWT->CYCCNT,
+	};
+
+	memcpy(tx_payload.data, &d, sizeof(d));
+	tx_payload.length = point->payload_len;
+	tx_payload.noack = !point->ack;
+	stamps[seq % STAMP_RING] = d.tx_stamp;
+
+	if (esb_write_payload(&tx_payload) != 0) {
+		atomic_set(&running, 0);
+		in_point = false;
+		k_sem_give(&tx_done_sem);
+		return;
+	}
+	result.sent++;
+	seq++;
+}
+
+static void check_echo(const Bench_AckPacked *ack)
+{
+	/* Nothing received yet this point, or too old to check */
+	if (ack->echo_seq == UINT32_MAX || seq - ack->echo_seq > STAMP_RING) {
+		return;
+	}
+	if (ack->echo_seq >= seq || stamps[ack->echo_seq % STAMP_RING] != ack->echo_stamp) {
+		result.echo_bad++;
+	}
+}
+
+void link_bench_ptx_event(struct esb_evt const *event)
+{
+	uint32_t now = DWT->CYCCNT;
+
+	switch (event->evt_id) {
+	case ESB_EVENT_TX_SUCCESS:
+	case ESB_EVENT_TX_FAILED:
+		last_ok = event->evt_id == ESB_EVENT_TX_SUCCESS;
+		if (!in_point) {
+			k_sem_give(&tx_done_sem);
+			break;
+		}
+
+		if (!last_ok) {
+			result.failed++;
+		} else if (point->ack) {
+			result.acked++;
+			link_bench_add_rtt(&result, (now - stamps[(seq - 1) % STAMP_RING]) /
+					   cycles_per_us);
+		}
+		if (event->tx_attempts > 1) {
+			result.retransmits += event->tx_attempts - 1;
+		}
+		last_cycles = now;
+
+		if (atomic_get(&running)) {
+			send_data();
+		} else {
+			in_point = false;
+			k_sem_give(&tx_done_sem);
+		}
+		break;
+	case ESB_EVENT_RX_RECEIVED:
+		while (esb_read_rx_payload(&rx_payload) == 0) {
+			Bench_AckPacked ack;
+
+			if (rx_payload.length < sizeof(ack)) {
+				continue;
+			}
+			memcpy(&ack, rx_payload.data, sizeof(ack));
+			if (ack.report) {
+				report = ack;
+				report_valid = true;
+			} else if (in_point) {
+				check_echo(&ack);
+			}
+		}
+		break;
+	}
+}
+
+static int set_link(uint16_t bitrate_kbps, uint16_t delay_us, uint8_t count)
+{
+	int err;
+
+	err = esb_set_bitrate(bitrate_kbps >= 2000 ? ESB_BITRATE_2MBPS : ESB_BITRATE_1MBPS);
+	if (err) {
+		return err;
+	}
+	err = esb_set_retransmit_delay(delay_us);
+	if (err) {
+		return err;
+	}
+	return esb_set_retransmit_count(count);
+}
+
+/* Send a control message at the base settings; true once it is acked */
+static bool send_ctrl(uint8_t type, uint8_t index, uint16_t duration_ms)
+{
+	Bench_CtrlPacked c = {
+		.type = type,
+		.point = index,
+		.duration_ms = duration_ms,
+	};
+
+	memcpy(tx_payload.data, &c, sizeof(c));
+	tx_payload.length = sizeof(c);
+	tx_payload.noack = false;
+
+	k_sem_reset(&tx_done_sem);
+	if (esb_write_payload(&tx_payload) != 0) {
+		esb_flush_tx();
+		return false;
+	}
+	if (k_sem_take(&tx_done_sem, K_MSEC(100)) != 0) {
+		esb_flush_tx();
+		return false;
+	}
+	return last_ok;
+}
+
+static bool run_point(uint8_t index)
+{
+	const uint16_t duration_ms = CONFIG_ESB_PTX_LINK_BENCH_POINT_MS;
+	const struct link_bench_point *p = &link_bench_points[index];
+	int tries, err;
+
+	for (tries = 0; tries < CTRL_TRIES; tries++) {
+		if (send_ctrl(LINK_BENCH_START, index, duration_ms)) {
+			break;
+		}
+		k_sleep(K_MSEC(10));
+	}
+	if (tries == CTRL_TRIES) {
+		return false;
+	}
+
+	k_sleep(K_MSEC(LINK_BENCH_SETTLE_MS));
+	/* No-ACK points never retransmit, the delay only has to be valid */
+	err = set_link(p->bitrate_kbps, p->ack ? p->retransmit_delay_us : BASE_DELAY_US,
+		       p->retransmit_count);
+	if (err) {
+		LOG_ERR("Link settings for point %u rejected, err %d", index, err);
+	}
+
+	link_bench_reset(&result);
+	memset(tx_payload.data, 0, sizeof(tx_payload.data));
+	point = p;
+	seq = 0;
+	k_sem_reset(&tx_done_sem);
+	atomic_set(&running, 1);
+	in_point = true;
+	first_cycles = DWT->CYCCNT;
+	last_cycles = first_cycles;
+	send_data();
+
+	k_sleep(K_MSEC(duration_ms));
+	atomic_set(&running, 0);
+	if (k_sem_take(&tx_done_sem, K_MSEC(100)) != 0) {
+		in_point = false;
+		esb_flush_tx();
+	}
+	result.elapsed_us = (last_cycles - first_cycles) / cycles_per_us;
+
+	set_link(LINK_BENCH_CTRL_KBPS, BASE_DELAY_US, BASE_COUNT);
+	k_sleep(K_MSEC(LINK_BENCH_REPORT_MS - LINK_BENCH_SETTLE_MS));
+
+	/* The PRX loads the report as the ACK payload of the REPORT after the first */
+	report_valid = false;
+	for (tries = 0; tries < CTRL_TRIES; tries++) {
+		if (send_ctrl(LINK_BENCH_REPORT, index, duration_ms) &&
+		    report_valid && report.point == index) {
+			result.prx_received = report.received;
+			return true;
+		}
+		k_sleep(K_MSEC(2));
+	}
+	return false;
+}
+
+void link_bench_ptx_run(void)
+{
+	char line[200];
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	cycles_per_us = SystemCoreClock / 1000000;
+
+	tx_payload.pipe = 0;
+	set_link(LINK_BENCH_CTRL_KBPS, BASE_DELAY_US, BASE_COUNT);
+
+	while (1) {
+		printk("%s\n", link_bench_header);
+		for (size_t i = 0; i < link_bench_point_count; i++) {
+			if (!run_point(i)) {
+				printk("# point %u: no answer from the PRX\n", (unsigned)i);
+				set_link(LINK_BENCH_CTRL_KBPS, BASE_DELAY_US, BASE_COUNT);
+				continue;
+			}
+			link_bench_format(line, sizeof(line), "esb", &link_bench_points[i], &result);
+			printk("%s\n", line);
+		}
+	}
+}
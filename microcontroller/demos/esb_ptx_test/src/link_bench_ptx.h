@@ -0,0 +1,17 @@
+/*
+ * ESB link benchmark, transmitter side. See common/link_bench.h.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _LINK_BENCH_PTX_H_
+#define _LINK_BENCH_PTX_H_
+
+#include <esb.h>
+
+/* ESB event handler while the benchmark runs */
+void link_bench_ptx_event(struct esb_evt const *event);
+
+/* Run the sweep forever; ESB must be initialised at 2 Mbps */
+void link_bench_ptx_run(void);
+
+#endif
@@ -15,6 +15,9 @@
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
 #include <dk_buttons_and_leds.h>
+#if defined(CONFIG_ESB_PTX_LINK_BENCH)
+#include "link_bench_ptx.h"
+#endif
 #if defined(CONFIG_CLOCK_CONTROL_NRF2)
 #include <hal/nrf_lrcconf.h>
 #endif
@@ -40,6 +43,10 @@ static struct esb_payload tx_payload = ESB_CREATE_PAYLOAD(0,
 
 void event_handler(struct esb_evt const *event)
 {
+#if defined(CONFIG_ESB_PTX_LINK_BENCH)
+	link_bench_ptx_event(event);
+	return;
+#endif
 	ready = true;
 
 	switch (event->evt_id) {
@@ -226,6 +233,11 @@ int main(void)
 	}
 
 	LOG_INF("Initialization complete");
+
+#if defined(CONFIG_ESB_PTX_LINK_BENCH)
+	LOG_INF("Running link benchmark");
+	link_bench_ptx_run();
+#endif
 	LOG_INF("Sending test packet");
 
 	tx_payload.noack = false;
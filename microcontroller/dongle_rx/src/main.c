@@ -10,12 +10,15 @@
 #include <zephyr/drivers/clock_control.h>
 #include <zephyr/drivers/clock_control/nrf_clock_control.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/uart.h>
 #include <zephyr/irq.h>
 #include <zephyr/logging/log.h>
 #include <nrf.h>
 #include <esb.h>
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/ring_buffer.h>
 #include <dk_buttons_and_leds.h>
 #if defined(CONFIG_CLOCK_CONTROL_NRF2)
 #include <hal/nrf_lrcconf.h>
@@ -31,21 +34,384 @@
 #include <math.h>
 #include <stdint.h>
 #include "imu.h"
+#include "glove_proto.h"
+#include "glove_wire.h"
 
 LOG_MODULE_REGISTER(esb_prx, CONFIG_ESB_PRX_APP_LOG_LEVEL);
 
-typedef struct {
-    uint8_t pipe;
-    uint8_t button;
-    IMU_DataPacked imu;
-} imu_frame_t;
+/* rx_us is rx_clock_us() at the RX event, 0 without timestamps */
+typedef struct wire_frame imu_frame_t;
 
-K_MSGQ_DEFINE(imu_msgq, sizeof(imu_frame_t), 16, 4);
+BUILD_ASSERT(sizeof(IMU_DataPacked) == WIRE_IMU_BYTES);
 
+/*
+ * Frames from the ESB ISR to the USB writer in main. Single producer, single
+ * consumer: the ISR only moves ring_head and main only moves ring_tail, so
+ * neither side takes a lock. A full ring drops the new frame and counts it.
+ */
+#define FRAME_RING_SIZE CONFIG_DONGLE_RX_RING_SIZE
+BUILD_ASSERT((FRAME_RING_SIZE & (FRAME_RING_SIZE - 1)) == 0,
+	     "Frame ring size must be a power of two");
+
+#define PIPE_COUNT 8
+
+static imu_frame_t frame_ring[FRAME_RING_SIZE];
+static atomic_t ring_head;
+static atomic_t ring_tail;
+static atomic_t ring_high_water;
+static K_SEM_DEFINE(frame_sem, 0, 1);
+
+/* Bumped in the ISR, read by main for the stats frame */
+static struct {
+	atomic_t received;
+	atomic_t queue_dropped;
+	atomic_t fifo_overrun;
+} pipe_counters[PIPE_COUNT];
+
+static bool frame_ring_put(const imu_frame_t *frame)
+{
+	atomic_val_t head = atomic_get(&ring_head);
+	atomic_val_t used = head - atomic_get(&ring_tail);
+
+	if (used == FRAME_RING_SIZE) {
+		return false;
+	}
+	frame_ring[head & (FRAME_RING_SIZE - 1)] = *frame;
+	atomic_set(&ring_head, head + 1);
+
+	if (used + 1 > atomic_get(&ring_high_water)) {
+		atomic_set(&ring_high_water, used + 1);
+	}
+	return true;
+}
+
+static bool frame_ring_get(imu_frame_t *frame)
+{
+	atomic_val_t tail = atomic_get(&ring_tail);
+
+	if (tail == atomic_get(&ring_head)) {
+		return false;
+	}
+	*frame = frame_ring[tail & (FRAME_RING_SIZE - 1)];
+	atomic_set(&ring_tail, tail + 1);
+	return true;
+}
+
+/*
+ * Newest button edge passed on per pipe. Gloves repeat an edge in every
+ * payload until one is acked, so a repeat is anything in the window behind
+ * the newest; anything else, a glove reboot included, is a new edge.
+ */
+static uint8_t edge_last_seq[PIPE_COUNT];
+static bool edge_seen[PIPE_COUNT];
+
+static bool edge_is_new(const imu_frame_t *frame)
+{
+	uint8_t pipe = frame->pipe % PIPE_COUNT;
+	int8_t ahead = (int8_t)(frame->edge.seq - edge_last_seq[pipe]);
+
+	if (edge_seen[pipe] && ahead <= 0 && ahead > -BUTTON_EDGE_WINDOW) {
+		return false;
+	}
+	edge_seen[pipe] = true;
+	edge_last_seq[pipe] = frame->edge.seq;
+	return true;
+}
+
+static void queue_frame(const imu_frame_t *frame, void *ctx)
+{
+	ARG_UNUSED(ctx);
+
+	if (frame->kind == WIRE_KIND_BUTTON && !edge_is_new(frame)) {
+		return;
+	}
+
+	if (!frame_ring_put(frame)) {
+		atomic_inc(&pipe_counters[frame->pipe % PIPE_COUNT].queue_dropped);
+	}
+}
+
+#ifdef CONFIG_DONGLE_RX_TIMESTAMP
+/*
+ * Receive timestamps from the CPU cycle counter (DWT, 64 MHz on the
+ * nRF52840), extended in software so the microseconds on the wire wrap
+ * with their u32 rather than every 67 s with the counter. That needs a
+ * call at least once per counter wrap, which main makes with every stats
+ * frame.
+ */
+static struct k_spinlock clock_lock;
+static uint64_t clock_cycles;
+static uint32_t clock_last;
+
+static void rx_clock_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t rx_clock_us(void)
+{
+	uint64_t cycles;
+
+	K_SPINLOCK(&clock_lock) {
+		uint32_t now = DWT->CYCCNT;
+
+		clock_cycles += (uint32_t)(now - clock_last);
+		clock_last = now;
+		cycles = clock_cycles;
+	}
+	return (uint32_t)(cycles / (SystemCoreClock / 1000000));
+}
+#endif
+
+/* How often the per-slot counters are logged */
+#define STATS_REPORT_MS 5000
+
+/*
+ * ACK payloads. The PRX has one TX FIFO for every pipe and only attaches
+ * its head, and only to a packet from the head's pipe; the head is removed
+ * (ESB_EVENT_TX_SUCCESS) when the glove's next packet shows the ACK got
+ * there. So each pipe has at most one entry queued, acks.order[] mirrors the
+ * FIFO, and a head whose glove has gone quiet is flushed so it cannot hold
+ * up the others.
+ */
+#define ACK_STALE_MS 250
+
+static struct {
+	uint8_t order[CONFIG_ESB_TX_FIFO_SIZE];    /* pipes, oldest first */
+	uint8_t front;
+	uint8_t count;
+	uint8_t queued;                            /* pipe mask */
+	uint32_t last_rx_ms[PIPE_COUNT];
+	uint32_t written, sent, flushes;
+} acks;
+static struct k_spinlock ack_lock;
+
+/* Queue an ACK payload for the pipe's next packet. Returns 0, -EBUSY if the
+ * pipe's last one has not gone yet, or esb_write_payload()'s error. */
+static int ack_queue(uint8_t pipe, const void *data, uint8_t length)
+{
+	struct esb_payload ack = {
+		.pipe = pipe,
+		.length = length,
+	};
+	int err = -EBUSY;
+
+	memcpy(ack.data, data, length);
+	K_SPINLOCK(&ack_lock) {
+		if (acks.queued & BIT(pipe % PIPE_COUNT)) {
+			K_SPINLOCK_BREAK;
+		}
+		err = esb_write_payload(&ack);
+		if (err == 0) {
+			acks.order[(acks.front + acks.count) % CONFIG_ESB_TX_FIFO_SIZE] = pipe;
+			acks.count++;
+			acks.queued |= BIT(pipe % PIPE_COUNT);
+			acks.written++;
+		}
+	}
+	return err;
+}
+
+/* The head went out with an ACK */
+static void ack_on_sent(void)
+{
+	K_SPINLOCK(&ack_lock) {
+		if (acks.count == 0) {
+			K_SPINLOCK_BREAK;
+		}
+		acks.queued &= ~BIT(acks.order[acks.front] % PIPE_COUNT);
+		acks.front = (acks.front + 1) % CONFIG_ESB_TX_FIFO_SIZE;
+		acks.count--;
+		acks.sent++;
+	}
+}
+
+/* Before a packet's ACK payloads are chosen: drop a head no one will take */
+static void ack_on_rx(uint8_t pipe)
+{
+	uint32_t now = k_uptime_get_32();
+
+	K_SPINLOCK(&ack_lock) {
+		acks.last_rx_ms[pipe % PIPE_COUNT] = now;
+		if (acks.count == 0) {
+			K_SPINLOCK_BREAK;
+		}
+
+		uint8_t head = acks.order[acks.front];
+
+		if (head != pipe && now - acks.last_rx_ms[head % PIPE_COUNT] > ACK_STALE_MS &&
+		    esb_flush_tx() == 0) {
+			acks.count = 0;
+			acks.queued = 0;
+			acks.flushes++;
+		}
+	}
+}
+
+static void log_ack_stats(void)
+{
+	uint32_t written, sent, flushes;
+
+	K_SPINLOCK(&ack_lock) {
+		written = acks.written;
+		sent = acks.sent;
+		flushes = acks.flushes;
+		acks.written = acks.sent = acks.flushes = 0;
+	}
+	if (written > 0 || sent > 0) {
+		LOG_INF("ACK payloads: %u queued, %u sent, %u flushes", written, sent, flushes);
+	}
+}
+
+#ifdef CONFIG_DONGLE_RX_TDMA
+/*
+ * Superframe of TDMA_SLOTS slots on the dongle's uptime clock; pipe n owns
+ * slot n % TDMA_SLOTS. Every packet is timestamped against its slot and the
+ * offset goes back to the glove in the ACK payload of its next packet
+ * (Beacon_Packed), which the glove uses to line up its transmissions.
+ */
+#define TDMA_SLOTS         CONFIG_DONGLE_RX_TDMA_SLOTS
+#define TDMA_SLOT_US       CONFIG_DONGLE_RX_TDMA_SLOT_US
+#define TDMA_GUARD_US      CONFIG_DONGLE_RX_TDMA_GUARD_US
+#define TDMA_SUPERFRAME_US (TDMA_SLOTS * TDMA_SLOT_US)
+
+BUILD_ASSERT(TDMA_SLOTS <= CONFIG_ESB_TX_FIFO_SIZE,
+	     "One queued beacon per slot must fit in the ESB TX FIFO");
+
+struct slot_stats {
+	uint32_t received;
+	uint32_t in_slot;          /* finished inside its own slot */
+	uint32_t max_offset_us;    /* furthest from the target, either way */
+	uint64_t sum_offset_us;
+	uint32_t beacon_errors;    /* ACK payload could not be queued */
+};
+
+static struct slot_stats slot_stats[TDMA_SLOTS];
+static struct k_spinlock slot_lock;
+
+/* Timestamp a packet against its slot and queue the glove's next beacon */
+static void tdma_on_rx(uint8_t pipe, bool send_beacon)
+{
+	int64_t now = k_ticks_to_us_floor64(k_uptime_ticks());
+	uint8_t slot = pipe % TDMA_SLOTS;
+	int32_t offset = (int32_t)(now % TDMA_SUPERFRAME_US) -
+			 (slot * TDMA_SLOT_US + TDMA_GUARD_US);
+
+	if (offset >= TDMA_SUPERFRAME_US / 2) {
+		offset -= TDMA_SUPERFRAME_US;
+	} else if (offset < -TDMA_SUPERFRAME_US / 2) {
+		offset += TDMA_SUPERFRAME_US;
+	}
+
+	Beacon_Packed beacon = {
+		.kind = ACK_KIND_BEACON,
+		.slot = slot,
+		.n_slots = TDMA_SLOTS,
+		.slot_us = TDMA_SLOT_US,
+		.guard_us = TDMA_GUARD_US,
+		.offset_us = (int16_t)CLAMP(offset, INT16_MIN, INT16_MAX),
+	};
+	uint32_t dist = (uint32_t)(offset < 0 ? -offset : offset);
+	// Only a fresh one per pipe waits in the FIFO, see ack_queue()
+	int err = send_beacon ? ack_queue(pipe, &beacon, sizeof(beacon)) : -EBUSY;
+
+	K_SPINLOCK(&slot_lock) {
+		struct slot_stats *st = &slot_stats[slot];
+
+		st->received++;
+		if (offset >= -TDMA_GUARD_US && offset < TDMA_SLOT_US - TDMA_GUARD_US) {
+			st->in_slot++;
+		}
+		st->sum_offset_us += dist;
+		if (dist > st->max_offset_us) {
+			st->max_offset_us = dist;
+		}
+		// The ACK of this packet has gone already, this rides on a later one
+		if (err != 0 && err != -EBUSY) {
+			st->beacon_errors++;
+		}
+	}
+}
+
+static void log_slot_stats(void)
+{
+	struct slot_stats s[TDMA_SLOTS];
+
+	K_SPINLOCK(&slot_lock) {
+		memcpy(s, slot_stats, sizeof(s));
+		memset(slot_stats, 0, sizeof(slot_stats));
+	}
+
+	for (int i = 0; i < TDMA_SLOTS; i++) {
+		if (s[i].received == 0) {
+			continue;
+		}
+		LOG_INF("Slot %d: %u packets, %u in slot, offset us avg %u max %u, "
+			"beacon errors %u",
+			i, s[i].received, s[i].in_slot,
+			(uint32_t)(s[i].sum_offset_us / s[i].received),
+			s[i].max_offset_us, s[i].beacon_errors);
+	}
+}
+#endif
+
+/*
+ * Settings changes from the host, at most one outstanding per pipe. It is
+ * queued again each time the last copy has gone out with an ACK, until the
+ * glove's status payload confirms the id, since the glove may not have
+ * acted on it; one copy waits in the FIFO at a time (ack_queue()).
+ */
+static struct {
+	bool pending;
+	Config_Packed config;
+} glove_config[PIPE_COUNT];
+static struct k_spinlock config_lock;
+
+/* Queue the pipe's pending config for its next ACK. Returns true if queued. */
+static bool config_on_rx(uint8_t pipe)
+{
+	bool pending;
+	Config_Packed config;
+
+	K_SPINLOCK(&config_lock) {
+		pending = glove_config[pipe % PIPE_COUNT].pending;
+		config = glove_config[pipe % PIPE_COUNT].config;
+	}
+	return pending && ack_queue(pipe, &config, sizeof(config)) == 0;
+}
+
+static void config_on_status(uint8_t pipe, const Glove_StatusPacked *st)
+{
+	K_SPINLOCK(&config_lock) {
+		if (glove_config[pipe % PIPE_COUNT].config.id == st->id) {
+			glove_config[pipe % PIPE_COUNT].pending = false;
+		}
+	}
+}
+
+/* A newer config for the same glove replaces one not yet confirmed */
+static void config_set(uint8_t pipe, uint8_t id, uint8_t fields,
+		       const Glove_SettingsPacked *settings)
+{
+	if (pipe >= PIPE_COUNT) {
+		return;
+	}
+
+	K_SPINLOCK(&config_lock) {
+		Config_Packed *c = &glove_config[pipe].config;
+
+		c->kind = ACK_KIND_CONFIG;
+		c->id = id;
+		c->fields = fields;
+		memcpy(&c->settings, settings, sizeof(c->settings));
+		glove_config[pipe].pending = true;
+	}
+	LOG_INF("Config %u for pipe %u, fields 0x%02x", id, pipe, fields);
+}
 
 static struct esb_payload rx_payload;
-static struct esb_payload tx_payload = ESB_CREATE_PAYLOAD(0,
-	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17);
 
 static void leds_update(uint8_t value)
 {
@@ -58,66 +424,91 @@ static void leds_update(uint8_t value)
 	dk_set_leds(leds_mask);
 }
 
-uint16_t crc16_ccitt(const uint8_t *data, size_t len)
+static void handle_rx_payload(const struct esb_payload *rx, uint32_t rx_us)
 {
-    uint16_t crc = 0xFFFF;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= (uint16_t)data[i] << 8;
-        for (int j = 0; j < 8; j++) {
-            if (crc & 0x8000)
-                crc = (crc << 1) ^ 0x1021;
-            else
-                crc <<= 1;
-        }
-    }
-    return crc;
+	switch (rx->pipe) {
+		case 1:
+			//LOG_INF("Received from Transmitter A (pipe 1, prefix 0xA1)");
+			break;
+		case 2:
+			//LOG_INF("Received from Transmitter B (pipe 2, prefix 0xB1)");
+			break;
+		default:
+			LOG_DBG("Received from pipe %d", rx->pipe);
+	}
+	atomic_inc(&pipe_counters[rx->pipe % PIPE_COUNT].received);
+
+	uint8_t kind = PAYLOAD_KIND(rx->data[0]);
+	size_t expected = wire_payload_min_len(kind);
+	bool valid = expected != 0 && rx->length >= (int)expected;
+	Glove_StatusPacked status;
+
+	ack_on_rx(rx->pipe);
+
+	// Confirmed before the ACK payload is chosen, so it is not sent again
+	if (valid && kind == PAYLOAD_KIND_STATUS) {
+		memcpy(&status, &rx->data[1], sizeof(status));
+		config_on_status(rx->pipe, &status);
+	}
+#ifdef CONFIG_DONGLE_RX_TDMA
+	// A pending config takes the pipe's ACK payload slot before the beacon
+	tdma_on_rx(rx->pipe, !config_on_rx(rx->pipe));
+#else
+	(void)config_on_rx(rx->pipe);
+#endif
+
+	if (!valid) {
+		LOG_WRN("Unexpected payload kind %d length %d (expected >= %zu)",
+			kind, rx->length, expected);
+		return;
+	}
+
+	(void)wire_unpack_payload(rx->pipe, rx->data, rx->length, rx_us,
+				  queue_frame, NULL);
+
+	leds_update(rx->data[1]);
 }
 
 void event_handler(struct esb_evt const *event)
 {
 	switch (event->evt_id) {
 	case ESB_EVENT_TX_SUCCESS:
-		LOG_DBG("TX SUCCESS EVENT");
+		// As PRX: the oldest ACK payload reached its glove
+		ack_on_sent();
 		break;
 	case ESB_EVENT_TX_FAILED:
 		LOG_DBG("TX FAILED EVENT");
 		break;
-	case ESB_EVENT_RX_RECEIVED:
-		if (esb_read_rx_payload(&rx_payload) == 0) {
-			switch (rx_payload.pipe) {
-				case 1:
-					//LOG_INF("Received from Transmitter A (pipe 1, prefix 0xA1)");
-					break;
-				case 2:
-					//LOG_INF("Received from Transmitter B (pipe 2, prefix 0xB1)");
-					break;
-				default:
-					LOG_INF("Received from pipe %d", rx_payload.pipe);
+	case ESB_EVENT_RX_RECEIVED: {
+		uint32_t drained = 0;
+		uint8_t pipes_seen = 0;
+#ifdef CONFIG_DONGLE_RX_TIMESTAMP
+		// As close to the radio END event as the app gets
+		uint32_t rx_us = rx_clock_us();
+#else
+		uint32_t rx_us = 0;
+#endif
+
+		// Several packets can be waiting by the time the ISR runs
+		while (esb_read_rx_payload(&rx_payload) == 0) {
+			drained++;
+			pipes_seen |= BIT(rx_payload.pipe % PIPE_COUNT);
+			handle_rx_payload(&rx_payload, rx_us);
+		}
+		if (drained > 0) {
+			k_sem_give(&frame_sem);
+		}
+		// A full FIFO NAKs every packet until it is drained again
+		if (drained >= CONFIG_ESB_RX_FIFO_SIZE) {
+			for (int i = 0; i < PIPE_COUNT; i++) {
+				if (pipes_seen & BIT(i)) {
+					atomic_inc(&pipe_counters[i].fifo_overrun);
+				}
 			}
-			if (rx_payload.length >= (int)(1 + sizeof(IMU_DataPacked))) {
-                imu_frame_t frame;
-                frame.pipe = rx_payload.pipe;
-                frame.button = rx_payload.data[0];
-				// if(frame.button != 0){
-				// 	dk_set_leds(DK_LED1_MSK | DK_LED2_MSK | DK_LED3_MSK | DK_LED4_MSK);
-				// } else {
-				// 	dk_set_leds(0);
-				// }
-                memcpy(&frame.imu, &rx_payload.data[1], sizeof(IMU_DataPacked));
-                (void)k_msgq_put(&imu_msgq, &frame, K_NO_WAIT);
-
-                leds_update(rx_payload.data[1]);
-            } else {
-                LOG_WRN("Unexpected payload length %d (expected >= %zu)",
-                        rx_payload.length, 1 + sizeof(IMU_DataPacked));
-            }
-
-				//leds_update(rx_payload.data[1]);
-		} else {
-			LOG_ERR("Error while reading rx packet");
 		}
 		break;
 	}
+	}
 }
 
 #if defined(CONFIG_CLOCK_CONTROL_NRF)
@@ -247,6 +638,371 @@ int esb_initialize(void)
 	return 0;
 }
 
+/*
+ * Host output over the CDC ACM port. Frames are appended to usb_ring and
+ * released to the driver a batch at a time: once
+ * CONFIG_DONGLE_RX_USB_BATCH_BYTES are waiting or the oldest frame has
+ * waited CONFIG_DONGLE_RX_USB_MAX_LATENCY_US, whichever comes first. The
+ * driver then moves each batch in as few bulk transfers as it can rather
+ * than one short transfer per frame.
+ *
+ * Main appends and releases, the UART callback drains released bytes.
+ * Nothing else may write to the port: console and logs go to RTT (prj.conf).
+ */
+static const struct device *const usb_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+
+RING_BUF_DECLARE(usb_ring, CONFIG_DONGLE_RX_USB_BUF_SIZE);
+static struct k_spinlock usb_lock;
+static uint32_t usb_released;       /* bytes the callback may send, under usb_lock */
+
+/* Main thread only */
+static uint32_t usb_pending;        /* bytes appended since the last release */
+static uint32_t usb_pending_frames;
+static int64_t usb_deadline;        /* ticks, while usb_pending != 0 */
+
+static struct {
+	uint32_t frames;
+	uint32_t batches;
+	uint32_t bytes;
+	uint32_t dropped;               /* usb_ring full, host not reading */
+} usb_stats;
+
+/*
+ * Host commands come in on the same port in extended frames (glove_proto.h),
+ * parsed a byte at a time in the UART callback.
+ */
+static struct {
+	uint8_t sync;                   /* header bytes matched */
+	uint16_t len;
+	uint8_t buf[2 + UINT8_MAX + 2]; /* type, len, body, crc */
+} cmd;
+
+static void cmd_handle(uint8_t type, const uint8_t *body, uint8_t len)
+{
+	switch (type) {
+	case HOST_CMD_GLOVE_CONFIG: {
+		Glove_SettingsPacked settings;
+
+		if (len < 3 + sizeof(settings)) {
+			LOG_WRN("Short glove config command, len %u", len);
+			return;
+		}
+		memcpy(&settings, &body[3], sizeof(settings));
+		config_set(body[0], body[1], body[2], &settings);
+		break;
+	}
+	default:
+		LOG_WRN("Unknown host command %u", type);
+		break;
+	}
+}
+
+static void cmd_rx_byte(uint8_t b)
+{
+	static const uint8_t header[3] = {
+		HOST_HEADER0, HOST_HEADER1, HOST_HEADER2_EXT
+	};
+
+	if (cmd.sync < sizeof(header)) {
+		if (b == header[cmd.sync]) {
+			cmd.sync++;
+		} else {
+			cmd.sync = b == HOST_HEADER0 ? 1 : 0;
+		}
+		cmd.len = 0;
+		return;
+	}
+
+	cmd.buf[cmd.len++] = b;
+	if (cmd.len < 2 || cmd.len < 2 + cmd.buf[1] + 2) {
+		return;
+	}
+
+	uint8_t len = cmd.buf[1];
+	uint16_t crc = cmd.buf[2 + len] | (cmd.buf[3 + len] << 8);
+
+	if (wire_crc16(cmd.buf, 2 + len) == crc) {
+		cmd_handle(cmd.buf[0], &cmd.buf[2], len);
+	} else {
+		LOG_WRN("Host command CRC mismatch");
+	}
+	cmd.sync = 0;
+}
+
+static void usb_isr(const struct device *dev, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	if (!uart_irq_update(dev)) {
+		return;
+	}
+
+	if (uart_irq_rx_ready(dev)) {
+		uint8_t buf[32];
+		int n;
+
+		while ((n = uart_fifo_read(dev, buf, sizeof(buf))) > 0) {
+			for (int i = 0; i < n; i++) {
+				cmd_rx_byte(buf[i]);
+			}
+		}
+	}
+
+	if (!uart_irq_tx_ready(dev)) {
+		return;
+	}
+
+	K_SPINLOCK(&usb_lock) {
+		uint8_t *data;
+		uint32_t len = ring_buf_get_claim(&usb_ring, &data, usb_released);
+		int sent = len ? uart_fifo_fill(dev, data, len) : 0;
+
+		if (sent < 0) {
+			sent = 0;
+		}
+		ring_buf_get_finish(&usb_ring, sent);
+		usb_released -= sent;
+		// Anything left (driver full, or the ring wrapped) goes next callback
+		if (usb_released == 0) {
+			uart_irq_tx_disable(dev);
+		}
+	}
+}
+
+static int usb_init(void)
+{
+	int err;
+
+	if (!device_is_ready(usb_dev)) {
+		return -ENODEV;
+	}
+	err = uart_irq_callback_user_data_set(usb_dev, usb_isr, NULL);
+	if (err) {
+		return err;
+	}
+	uart_irq_rx_enable(usb_dev);
+	return 0;
+}
+
+static void usb_out_flush(void)
+{
+	if (usb_pending == 0) {
+		return;
+	}
+
+	K_SPINLOCK(&usb_lock) {
+		usb_released += usb_pending;
+	}
+	usb_stats.frames += usb_pending_frames;
+	usb_stats.bytes += usb_pending;
+	usb_stats.batches++;
+	usb_pending = 0;
+	usb_pending_frames = 0;
+
+	uart_irq_tx_enable(usb_dev);
+}
+
+/* Queue one complete host frame; it is dropped whole if it does not fit */
+static void usb_out_frame(const uint8_t *msg, size_t len)
+{
+	bool queued = false;
+
+	K_SPINLOCK(&usb_lock) {
+		if (ring_buf_space_get(&usb_ring) >= len) {
+			ring_buf_put(&usb_ring, msg, len);
+			queued = true;
+		}
+	}
+	if (!queued) {
+		usb_stats.dropped++;
+		return;
+	}
+
+	if (usb_pending == 0) {
+		usb_deadline = k_uptime_ticks() +
+			       k_us_to_ticks_ceil64(CONFIG_DONGLE_RX_USB_MAX_LATENCY_US);
+	}
+	usb_pending += len;
+	usb_pending_frames++;
+
+	if (usb_pending >= CONFIG_DONGLE_RX_USB_BATCH_BYTES) {
+		usb_out_flush();
+	}
+}
+
+/* Release a batch whose window has run out; returns how long main may sleep */
+static k_timeout_t usb_out_poll(void)
+{
+	if (usb_pending == 0) {
+		return K_MSEC(100);
+	}
+
+	int64_t left = usb_deadline - k_uptime_ticks();
+
+	if (left <= 0) {
+		usb_out_flush();
+		return K_MSEC(100);
+	}
+	return K_TICKS(left);
+}
+
+static void log_usb_stats(void)
+{
+	if (usb_stats.batches == 0) {
+		return;
+	}
+	uint32_t per_batch = usb_stats.frames * 100 / usb_stats.batches;
+
+	LOG_INF("USB: %u frames in %u transfers (%u.%02u per transfer), "
+		"%u bytes, %u dropped",
+		usb_stats.frames, usb_stats.batches, per_batch / 100, per_batch % 100,
+		usb_stats.bytes, usb_stats.dropped);
+	memset(&usb_stats, 0, sizeof(usb_stats));
+}
+
+/* Legacy fixed-size sample frame, see glove_proto.h */
+static void write_sample_frame(const imu_frame_t *frame, uint16_t seq)
+{
+        uint8_t msg[WIRE_FRAME_MAX];
+
+        usb_out_frame(msg, wire_sample_frame(msg, frame, seq));
+}
+
+static void write_ext_frame(uint8_t type, const uint8_t *body, uint8_t len)
+{
+        uint8_t msg[WIRE_FRAME_MAX];
+
+        usb_out_frame(msg, wire_ext_frame(msg, type, body, len));
+}
+
+#ifdef CONFIG_DONGLE_RX_TIMESTAMP
+static void write_timed_sample_frame(const imu_frame_t *frame, uint16_t seq)
+{
+        uint8_t msg[WIRE_FRAME_MAX];
+
+        usb_out_frame(msg, wire_timed_sample_frame(msg, frame, seq, rx_clock_us()));
+}
+#endif
+
+static void write_ahrs_frame(const imu_frame_t *frame, uint16_t seq)
+{
+        uint8_t msg[WIRE_FRAME_MAX];
+
+        usb_out_frame(msg, wire_ahrs_frame(msg, frame, seq));
+}
+
+static void write_gesture_frame(const imu_frame_t *frame)
+{
+        uint8_t msg[WIRE_FRAME_MAX];
+
+        usb_out_frame(msg, wire_gesture_frame(msg, frame));
+}
+
+static void write_button_frame(const imu_frame_t *frame)
+{
+        uint8_t msg[WIRE_FRAME_MAX];
+
+        usb_out_frame(msg, wire_button_frame(msg, frame));
+}
+
+#ifdef CONFIG_DONGLE_RX_AGGREGATE
+/*
+ * Raw samples collected for one HOST_FRAME_MULTI. Main thread only. A
+ * glove's second sample in the window sends the frame early rather than
+ * replacing the first, so nothing is lost to aggregation.
+ */
+static struct {
+	uint8_t present;
+	uint8_t expect;         /* pipes in the last frame sent */
+	int64_t deadline;       /* ticks, while present != 0 */
+	Multi_EntryPacked entry[PIPE_COUNT];
+} multi;
+
+static void write_multi_frame(void)
+{
+	uint8_t body[1 + PIPE_COUNT * sizeof(Multi_EntryPacked)];
+	size_t idx = 0;
+
+	if (multi.present == 0) {
+		return;
+	}
+
+	body[idx++] = multi.present;
+	for (int i = 0; i < PIPE_COUNT; i++) {
+		if (multi.present & BIT(i)) {
+			memcpy(&body[idx], &multi.entry[i], sizeof(Multi_EntryPacked));
+			idx += sizeof(Multi_EntryPacked);
+		}
+	}
+
+	write_ext_frame(HOST_FRAME_MULTI, body, idx);
+	multi.expect = multi.present;
+	multi.present = 0;
+}
+
+static void multi_add(const imu_frame_t *frame, uint16_t seq)
+{
+	uint8_t pipe = frame->pipe % PIPE_COUNT;
+
+	if (multi.present & BIT(pipe)) {
+		write_multi_frame();
+	}
+	if (multi.present == 0) {
+		multi.deadline = k_uptime_ticks() +
+				 k_us_to_ticks_ceil64(CONFIG_DONGLE_RX_AGGREGATE_WINDOW_US);
+	}
+
+	multi.present |= BIT(pipe);
+	multi.entry[pipe].button = frame->button;
+	multi.entry[pipe].seq = sys_cpu_to_le16(seq);
+	memcpy(multi.entry[pipe].imu, frame->imu, sizeof(multi.entry[pipe].imu));
+
+	// Everyone who was in the last frame is in: no point waiting
+	if ((multi.present & multi.expect) == multi.expect) {
+		write_multi_frame();
+	}
+}
+
+/* Send a frame whose window has run out; returns ticks until the next one is due */
+static int64_t multi_poll(void)
+{
+	if (multi.present == 0) {
+		return INT64_MAX;
+	}
+
+	int64_t left = multi.deadline - k_uptime_ticks();
+
+	if (left <= 0) {
+		write_multi_frame();
+		return INT64_MAX;
+	}
+	return left;
+}
+#endif
+
+static void write_status_frame(const imu_frame_t *frame)
+{
+        uint8_t msg[WIRE_FRAME_MAX];
+
+        usb_out_frame(msg, wire_status_frame(msg, frame));
+}
+
+static void write_stats_frame(void)
+{
+	Dongle_StatsPacked stats;
+
+	stats.uptime_ms = k_uptime_get_32();
+	stats.ring_high_water = (uint16_t)atomic_set(&ring_high_water, 0);
+	stats.ring_size = FRAME_RING_SIZE;
+	for (int i = 0; i < PIPE_COUNT; i++) {
+		stats.pipe[i].received = atomic_get(&pipe_counters[i].received);
+		stats.pipe[i].queue_dropped = atomic_get(&pipe_counters[i].queue_dropped);
+		stats.pipe[i].fifo_overrun = atomic_get(&pipe_counters[i].fifo_overrun);
+	}
+
+	write_ext_frame(HOST_FRAME_STATS, (const uint8_t *)&stats, sizeof(stats));
+}
+
 int main(void)
 {
 	int err;
@@ -272,14 +1028,18 @@ int main(void)
 		return 0;
 	}
 
-	LOG_INF("Initialization complete");
+#ifdef CONFIG_DONGLE_RX_TIMESTAMP
+	rx_clock_init();
+#endif
 
-	err = esb_write_payload(&tx_payload);
+	err = usb_init();
 	if (err) {
-		LOG_ERR("Write payload, err %d", err);
+		LOG_ERR("USB initialization failed, err %d", err);
 		return 0;
 	}
 
+	LOG_INF("Initialization complete");
+
 	LOG_INF("Setting up for packet receiption");
 
 	err = esb_start_rx();
@@ -290,42 +1050,69 @@ int main(void)
 
 	imu_frame_t frame;
 	static uint16_t seq = 0;
+	uint32_t last_report = k_uptime_get_32();
+	uint32_t last_stats = k_uptime_get_32();
 
 	while(1){
-		k_msgq_get(&imu_msgq, &frame, K_FOREVER);
-
-        // Build payload: pipe + button + seq + imu
-        uint8_t payload[1 + 1 + 2 + sizeof(IMU_DataPacked)];
-        size_t idx = 0;
-        payload[idx++] = frame.pipe;
-        payload[idx++] = frame.button;    /* include button */
-
-        // seq as little-endian u16
-        payload[idx++] = (uint8_t)(seq & 0xFF);
-        payload[idx++] = (uint8_t)((seq >> 8) & 0xFF);
-
-        memcpy(&payload[idx], &frame.imu, sizeof(IMU_DataPacked));
-        idx += sizeof(IMU_DataPacked);
-
-        // CRC over payload
-        uint16_t crc = crc16_ccitt(payload, idx);
+		if (k_uptime_get_32() - last_stats >= CONFIG_DONGLE_RX_STATS_PERIOD_MS) {
+			last_stats = k_uptime_get_32();
+			write_stats_frame();
+#ifdef CONFIG_DONGLE_RX_TIMESTAMP
+			// Keeps the cycle counter extension current with no gloves on
+			(void)rx_clock_us();
+#endif
+		}
+		if (k_uptime_get_32() - last_report >= STATS_REPORT_MS) {
+			last_report = k_uptime_get_32();
+			log_usb_stats();
+			log_ack_stats();
+#ifdef CONFIG_DONGLE_RX_TDMA
+			log_slot_stats();
+#endif
+		}
 
-        // Now build final wire frame: header + payload + crc
-        uint8_t msg[3 + sizeof(payload) + 2];
-        size_t midx = 0;
+#ifdef CONFIG_DONGLE_RX_AGGREGATE
+		int64_t multi_left = multi_poll();
+#endif
+		k_timeout_t idle = usb_out_poll();
 
-        msg[midx++] = 0x77;
-        msg[midx++] = 0x55;
-        msg[midx++] = 0xAA;
+#ifdef CONFIG_DONGLE_RX_AGGREGATE
+		if (multi_left < idle.ticks) {
+			idle = K_TICKS(multi_left);
+		}
+#endif
 
-        memcpy(&msg[midx], payload, idx);
-        midx += idx;
+		if (!frame_ring_get(&frame)) {
+			(void)k_sem_take(&frame_sem, idle);
+			continue;
+		}
 
-        msg[midx++] = (uint8_t)(crc & 0xFF);
-        msg[midx++] = (uint8_t)((crc >> 8) & 0xFF);
+        if (frame.kind == PAYLOAD_KIND_EVENT) {
+            write_gesture_frame(&frame);
+            continue;
+        }
+        if (frame.kind == PAYLOAD_KIND_STATUS) {
+            write_status_frame(&frame);
+            continue;
+        }
+        if (frame.kind == WIRE_KIND_BUTTON) {
+            write_button_frame(&frame);
+            continue;
+        }
 
-        fwrite(msg, 1, midx, stdout);
-        fflush(stdout);
+        // Raw and attitude halves of one sample share a seq
+        if (frame.kind != PAYLOAD_KIND_AHRS) {
+#if defined(CONFIG_DONGLE_RX_AGGREGATE)
+            multi_add(&frame, seq);
+#elif defined(CONFIG_DONGLE_RX_TIMESTAMP)
+            write_timed_sample_frame(&frame, seq);
+#else
+            write_sample_frame(&frame, seq);
+#endif
+        }
+        if (frame.kind != PAYLOAD_KIND_RAW) {
+            write_ahrs_frame(&frame, seq);
+        }
 
         seq++;
 	}
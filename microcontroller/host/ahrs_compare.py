@@ -0,0 +1,60 @@
+# ahrs_compare.py
+#
+# Runs a capture through both pi/testFinalProject/ahrs.py and the C filter
+# (./ahrs_replay) and reports how far apart the quaternions are and how long
+# each takes per sample.
+#
+# Usage: python3 ahrs_compare.py capture.csv   (dt,ax,ay,az,gx,gy,gz per line)
+import os
+import subprocess
+import sys
+import time
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             "..", "..", "pi", "testFinalProject"))
+
+from ahrs import MahonyFilter          # noqa: E402
+from datatypes import Vector3          # noqa: E402
+
+
+def load(path):
+    rows = []
+    with open(path) as f:
+        for line in f:
+            try:
+                rows.append([float(v) for v in line.strip().split(",")])
+            except ValueError:
+                continue  # header
+    return [r for r in rows if len(r) == 7]
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("usage: ahrs_compare.py capture.csv")
+        return 1
+
+    rows = load(sys.argv[1])
+    kp, ki = 1.2, 0.0
+
+    py = MahonyFilter(kp=kp, ki=ki)
+    py_q = []
+    t0 = time.perf_counter()
+    for dt, ax, ay, az, gx, gy, gz in rows:
+        py.update(Vector3(gx, gy, gz), Vector3(ax, ay, az), dt)
+        py_q.append((py.q.w, py.q.x, py.q.y, py.q.z))
+    py_ns = (time.perf_counter() - t0) * 1e9 / max(len(rows), 1)
+
+    with open(sys.argv[1]) as f:
+        out = subprocess.run(["./ahrs_replay", "-kp", str(kp), "-ki", str(ki)],
+                             stdin=f, capture_output=True, text=True, check=True)
+    c_q = [tuple(float(v) for v in line.split(",")[:4])
+           for line in out.stdout.splitlines()]
+
+    err = max(max(abs(a - b) for a, b in zip(p, c)) for p, c in zip(py_q, c_q))
+    print(f"{len(rows)} samples, max |q_py - q_c| = {err:.2e}")
+    print(f"ahrs.py: {py_ns:.0f} ns/update, C: {out.stderr.strip()}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,92 @@
+/*
+ * Replays a recorded IMU capture through the glove attitude filter.
+ *
+ * Input (stdin), one sample per line, gyro in rad/s and accel in m/s^2:
+ *   dt,ax,ay,az,gx,gy,gz
+ * Output (stdout), one line per sample:
+ *   qw,qx,qy,qz,lin_x,lin_y,lin_z
+ *
+ * Average time per filter update is printed to stderr.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ahrs.h"
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-madgwick] [-kp K] [-ki K] [-beta B] < capture.csv\n",
+		prog);
+}
+
+int main(int argc, char **argv)
+{
+	int madgwick = 0;
+	float kp = 1.2f, ki = 0.0f, beta = 0.1f;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-madgwick") == 0) {
+			madgwick = 1;
+		} else if (strcmp(argv[i], "-kp") == 0 && i + 1 < argc) {
+			kp = strtof(argv[++i], NULL);
+		} else if (strcmp(argv[i], "-ki") == 0 && i + 1 < argc) {
+			ki = strtof(argv[++i], NULL);
+		} else if (strcmp(argv[i], "-beta") == 0 && i + 1 < argc) {
+			beta = strtof(argv[++i], NULL);
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	struct ahrs filter;
+	char line[256];
+	long samples = 0;
+	double busy_ns = 0;
+
+	ahrs_init(&filter, kp, ki, beta);
+
+	while (fgets(line, sizeof(line), stdin)) {
+		float dt, accel[3], gyro[3], lin[3];
+
+		if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &dt, &accel[0],
+			   &accel[1], &accel[2], &gyro[0], &gyro[1],
+			   &gyro[2]) != 7) {
+			continue; /* header or blank line */
+		}
+
+		double t0 = now_ns();
+
+		if (madgwick) {
+			ahrs_madgwick_update(&filter, gyro, accel, dt);
+		} else {
+			ahrs_mahony_update(&filter, gyro, accel, dt);
+		}
+		ahrs_linear_accel(&filter, accel, lin);
+		busy_ns += now_ns() - t0;
+		samples++;
+
+		printf("%.7f,%.7f,%.7f,%.7f,%.5f,%.5f,%.5f\n", filter.q[0],
+		       filter.q[1], filter.q[2], filter.q[3], lin[0], lin[1],
+		       lin[2]);
+	}
+
+	if (samples > 0) {
+		fprintf(stderr, "%ld samples, %.1f ns/update\n", samples,
+			busy_ns / samples);
+	}
+	return 0;
+}
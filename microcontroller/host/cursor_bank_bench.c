@@ -0,0 +1,202 @@
+/*
+ * Acceleration-mode cursor step for many gloves: the SIMD cursor bank
+ * (pi/c-game/src/cursor_bank.c) against the per-cursor code the game runs
+ * (accel_motion_step + cursor_position_step), with a bitwise check of
+ * every position and velocity after every step.
+ *
+ * Inputs are random: mostly small accelerations that the deadzones
+ * swallow, with bursts large enough to hit the speed limit and the screen
+ * edges, and a few different sample periods.
+ *
+ * Output, one line per cursor count:
+ *   cursors,isa,bank_ns_per_cursor,scalar_ns_per_cursor,speedup,mismatches
+ * -check exits non-zero if any step differs in any bit.
+ *
+ * Build with -ffp-contract=off (the Makefile does); a fused multiply-add
+ * on one side is enough to change the last bit.
+ *
+ * Usage: cursor_bank_bench [-steps n] [-seed n] [-check]
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cursor_bank.h"
+
+#define MAX_CURSORS     64
+#define INPUT_STEPS     1024    /* input pattern, replayed */
+#define SCREEN_W        800.0f
+#define SCREEN_H        450.0f
+
+static const int cursor_counts[] = { 2, 4, 8, 16, 32, 64 };
+
+static float input_x[INPUT_STEPS][MAX_CURSORS];
+static float input_y[INPUT_STEPS][MAX_CURSORS];
+static float input_dt[INPUT_STEPS][MAX_CURSORS];
+
+static uint32_t rng_state = 1;
+
+static float frand(void)
+{
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return (rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+static float gauss(void)
+{
+	float u = frand() + 1e-7f, v = frand();
+
+	return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+static void make_inputs(void)
+{
+	static const float periods[] = { 1.0f / 104.0f, 0.0095f, 0.0098f, 1.0f / 208.0f };
+
+	for (int c = 0; c < MAX_CURSORS; c++) {
+		float burst = 0;
+
+		for (int k = 0; k < INPUT_STEPS; k++) {
+			if (frand() < 0.01f) {
+				burst = 20.0f * (2.0f * frand() - 1.0f);
+			} else if (frand() < 0.05f) {
+				burst = 0;
+			}
+			input_x[k][c] = 0.1f * gauss() + burst;
+			input_y[k][c] = 0.1f * gauss() - 0.5f * burst;
+			input_dt[k][c] = periods[frand() < 0.9f ? 0 : 1 + (int)(frand() * 3)];
+		}
+	}
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void load_step(struct cursor_bank *b, int k)
+{
+	memcpy(b->in_x, input_x[k % INPUT_STEPS], b->count * sizeof(float));
+	memcpy(b->in_y, input_y[k % INPUT_STEPS], b->count * sizeof(float));
+	memcpy(b->dt, input_dt[k % INPUT_STEPS], b->count * sizeof(float));
+}
+
+static void start_positions(struct cursor_bank *b)
+{
+	for (int i = 0; i < b->count; i++) {
+		b->pos_x[i] = SCREEN_W * (i + 1) / (b->count + 1);
+		b->pos_y[i] = SCREEN_H / 2;
+	}
+}
+
+static double time_steps(struct cursor_bank *b, int steps, int simd)
+{
+	double t0 = now_ns();
+
+	for (int k = 0; k < steps; k++) {
+		load_step(b, k);
+		if (simd) {
+			cursor_bank_step(b);
+		} else {
+			cursor_bank_step_scalar(b);
+		}
+	}
+	return (now_ns() - t0) / ((double)steps * b->count);
+}
+
+static long parity(int count, int steps)
+{
+	struct cursor_bank simd, scalar;
+	size_t bytes = count * sizeof(float);
+	long bad = 0;
+
+	if (cursor_bank_init(&simd, count, SCREEN_W, SCREEN_H) ||
+	    cursor_bank_init(&scalar, count, SCREEN_W, SCREEN_H)) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	start_positions(&simd);
+	start_positions(&scalar);
+
+	for (int k = 0; k < steps; k++) {
+		load_step(&simd, k);
+		load_step(&scalar, k);
+		cursor_bank_step(&simd);
+		cursor_bank_step_scalar(&scalar);
+		if (memcmp(simd.pos_x, scalar.pos_x, bytes) ||
+		    memcmp(simd.pos_y, scalar.pos_y, bytes) ||
+		    memcmp(simd.vel_x, scalar.vel_x, bytes) ||
+		    memcmp(simd.vel_y, scalar.vel_y, bytes)) {
+			bad++;
+			/* Carry on from the same state so one slip is one count */
+			memcpy(simd.pos_x, scalar.pos_x, bytes);
+			memcpy(simd.pos_y, scalar.pos_y, bytes);
+			memcpy(simd.vel_x, scalar.vel_x, bytes);
+			memcpy(simd.vel_y, scalar.vel_y, bytes);
+		}
+	}
+	cursor_bank_free(&simd);
+	cursor_bank_free(&scalar);
+	return bad;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-steps n] [-seed n] [-check]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	int steps = 200000;
+	int check = 0;
+	long total_bad = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-steps") && i + 1 < argc) {
+			steps = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-seed") && i + 1 < argc) {
+			rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+		} else if (!strcmp(argv[i], "-check")) {
+			check = 1;
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if (steps < 1) {
+		usage(argv[0]);
+		return 2;
+	}
+	make_inputs();
+
+	printf("cursors,isa,bank_ns_per_cursor,scalar_ns_per_cursor,speedup,mismatches\n");
+	for (size_t n = 0; n < sizeof(cursor_counts) / sizeof(cursor_counts[0]); n++) {
+		int count = cursor_counts[n];
+		struct cursor_bank b;
+		long bad = parity(count, steps < 20000 ? steps : 20000);
+
+		if (cursor_bank_init(&b, count, SCREEN_W, SCREEN_H)) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		start_positions(&b);
+		double scalar_ns = time_steps(&b, steps, 0);
+
+		start_positions(&b);
+		double bank_ns = time_steps(&b, steps, 1);
+
+		cursor_bank_free(&b);
+		total_bad += bad;
+		printf("%d,%s,%.2f,%.2f,%.2f,%ld\n", count, cursor_bank_isa(),
+		       bank_ns, scalar_ns, scalar_ns / bank_ns, bad);
+	}
+	return check && total_bad ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+/*
+ * Game cursor responsiveness on a recorded capture: acceleration mode
+ * against air-mouse mode (pi/c-game/src/cursor_motion.c), run the way
+ * pi/c-game/src/imu_cursor.c runs them but without the screen edges.
+ *
+ * Input (stdin) is the ahrs_replay capture format, one sample per line,
+ * gyro in rad/s and accel in m/s^2:
+ *   dt,ax,ay,az,gx,gy,gz
+ * gravity_bench -synth 60 -dump file.csv writes one if there is no glove
+ * to hand.
+ *
+ * Output, one line per mode:
+ *   mode,samples,ns_per_update,onsets,onset_ms_p50,onset_ms_p90,missed,
+ *   stop_ms_p50,still_px_s
+ * An onset is the glove starting to move after at least STILL_HOLD_S at
+ * rest; onset_ms is how long the cursor takes to gain ONSET_PX_S, and
+ * missed counts onsets it did not follow within ONSET_MAX_S. stop_ms is
+ * how long the cursor keeps moving once the glove is at rest again, and
+ * still_px_s is its mean speed while the glove stays at rest (drift).
+ * The background bias estimate's rest time and drift go to stderr.
+ *
+ * Usage: cursor_bench [-repeat n] < capture.csv
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bias_tracker.h"
+#include "cursor_motion.h"
+#include "imu_gravity.h"
+
+#define STILL_GYRO      0.1f    /* rad/s */
+#define STILL_ACCEL     0.3f    /* m/s^2 from 1 g */
+#define STILL_HOLD_S    0.25f
+#define ONSET_PX_S      50.0f
+#define ONSET_MAX_S     0.5f
+#define STOP_PX_S       20.0f
+#define STOP_MAX_S      1.0f
+#define MAX_EVENTS      4096
+
+struct sample {
+	float dt;
+	float accel[3];
+	float gyro[3];
+};
+
+struct cursor {
+	int mode;
+	struct imu_gravity gravity;
+	struct air_motion air;
+	struct bias_tracker tracker;
+	struct bias_metrics metrics;
+	float vel[2];
+};
+
+static struct sample *samples;
+static size_t sample_count, sample_cap;
+static float speed[1 << 20];
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void load_capture(FILE *f)
+{
+	char line[256];
+	struct sample s;
+
+	while (fgets(line, sizeof(line), f) && sample_count < sizeof(speed) / sizeof(speed[0])) {
+		if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &s.dt, &s.accel[0],
+			   &s.accel[1], &s.accel[2], &s.gyro[0], &s.gyro[1],
+			   &s.gyro[2]) != 7) {
+			continue; /* header or blank line */
+		}
+		if (sample_count == sample_cap) {
+			sample_cap = sample_cap ? sample_cap * 2 : 4096;
+			samples = realloc(samples, sample_cap * sizeof(*samples));
+			if (!samples) {
+				perror("realloc");
+				exit(1);
+			}
+		}
+		samples[sample_count++] = s;
+	}
+}
+
+static void cursor_init(struct cursor *c, int mode)
+{
+	memset(c, 0, sizeof(*c));
+	c->mode = mode;
+	imu_gravity_init(&c->gravity, IMU_GRAVITY_MAHONY);
+	air_motion_init(&c->air);
+	bias_tracker_init(&c->tracker);
+	bias_metrics_init(&c->metrics);
+}
+
+/* UpdateCursorSample() minus the sample clock, the cache and the screen */
+static void cursor_update(struct cursor *c, const struct sample *s)
+{
+	float lin[3], a[2];
+
+	imu_gravity_update(&c->gravity, s->accel, s->gyro, s->dt, lin);
+	cursor_accel_axes(lin, a);
+	int changed = bias_tracker_update(&c->tracker, s->accel, s->gyro, a, s->dt);
+
+	bias_metrics_update(&c->metrics, &c->tracker, changed, s->dt);
+
+	if (c->mode == CURSOR_MODE_AIR) {
+		air_motion_update(&c->air, s->gyro, s->dt, c->vel);
+		return;
+	}
+
+	a[0] -= c->tracker.accel_bias[0];
+	a[1] = -(a[1] - c->tracker.accel_bias[1]);
+	accel_motion_step(c->vel, a, s->dt);
+}
+
+static int is_still(const struct sample *s)
+{
+	float g = sqrtf(s->gyro[0] * s->gyro[0] + s->gyro[1] * s->gyro[1] +
+			s->gyro[2] * s->gyro[2]);
+	float a = sqrtf(s->accel[0] * s->accel[0] + s->accel[1] * s->accel[1] +
+			s->accel[2] * s->accel[2]);
+
+	return g < STILL_GYRO && fabsf(a - AHRS_GRAVITY) < STILL_ACCEL;
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+	float x = *(const float *)a, y = *(const float *)b;
+
+	return (x > y) - (x < y);
+}
+
+static float percentile(float *v, int n, float p)
+{
+	if (n == 0) {
+		return -1.0f;
+	}
+	qsort(v, n, sizeof(*v), cmp_float);
+	return v[(int)(p * (n - 1) + 0.5f)];
+}
+
+static void run(int mode, int repeat)
+{
+	static float onset_ms[MAX_EVENTS], stop_ms[MAX_EVENTS];
+	struct cursor c;
+	double busy_ns = 0, still_px = 0, still_s = 0;
+	int onsets = 0, missed = 0, stops = 0;
+
+	for (int r = 0; r < repeat; r++) {
+		cursor_init(&c, mode);
+		double t0 = now_ns();
+
+		for (size_t k = 0; k < sample_count; k++) {
+			cursor_update(&c, &samples[k]);
+		}
+		busy_ns += now_ns() - t0;
+	}
+
+	cursor_init(&c, mode);
+	for (size_t k = 0; k < sample_count; k++) {
+		cursor_update(&c, &samples[k]);
+		speed[k] = sqrtf(c.vel[0] * c.vel[0] + c.vel[1] * c.vel[1]);
+	}
+
+	/* Walk rest and motion periods */
+	float rest = 0;
+	int was_still = 1;
+
+	for (size_t k = 1; k < sample_count; k++) {
+		int still = is_still(&samples[k]);
+
+		if (still && rest >= STILL_HOLD_S) {
+			still_px += speed[k] * samples[k].dt;
+			still_s += samples[k].dt;
+		}
+		if (!still && was_still && rest >= STILL_HOLD_S && onsets < MAX_EVENTS) {
+			float t = 0, from = speed[k - 1];
+			size_t j = k;
+
+			/* Measured from the speed it already had, drift included */
+			while (j < sample_count && t <= ONSET_MAX_S && speed[j] < from + ONSET_PX_S) {
+				t += samples[j++].dt;
+			}
+			if (j < sample_count && t <= ONSET_MAX_S) {
+				onset_ms[onsets++] = t * 1e3f;
+			} else {
+				missed++;
+			}
+		}
+		if (still && !was_still && stops < MAX_EVENTS) {
+			float t = 0;
+			size_t j = k;
+
+			while (j < sample_count && t < STOP_MAX_S && speed[j] >= STOP_PX_S) {
+				t += samples[j++].dt;
+			}
+			stop_ms[stops++] = t * 1e3f;
+		}
+		rest = still ? rest + samples[k].dt : 0;
+		was_still = still;
+	}
+
+	if (mode == CURSOR_MODE_ACCEL) {
+		fprintf(stderr, "bias: at rest %.0f%% (%u times), %u updates, accel drift %.4f m/s^2 "
+			"(max %.4f), gyro %.4f rad/s (max %.4f)\n",
+			100.0 * c.metrics.rest_s / c.metrics.session_s,
+			(unsigned)c.metrics.rest_periods, (unsigned)c.metrics.updates,
+			c.metrics.accel_drift, c.metrics.max_accel_drift,
+			c.metrics.gyro_drift, c.metrics.max_gyro_drift);
+	}
+	printf("%s,%zu,%.1f,%d,%.1f,%.1f,%d,%.1f,%.2f\n", cursor_mode_name(mode),
+	       sample_count, busy_ns / ((double)sample_count * repeat),
+	       onsets + missed, percentile(onset_ms, onsets, 0.5f),
+	       percentile(onset_ms, onsets, 0.9f), missed,
+	       percentile(stop_ms, stops, 0.5f),
+	       still_s > 0 ? still_px / still_s : -1.0);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-repeat n] < capture.csv\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	int repeat = 20;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-repeat") && i + 1 < argc) {
+			repeat = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if (repeat < 1) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	load_capture(stdin);
+	if (sample_count < 2) {
+		fprintf(stderr, "no samples\n");
+		return 1;
+	}
+
+	printf("mode,samples,ns_per_update,onsets,onset_ms_p50,onset_ms_p90,"
+	       "missed,stop_ms_p50,still_px_s\n");
+	run(CURSOR_MODE_ACCEL, repeat);
+	run(CURSOR_MODE_AIR, repeat);
+	free(samples);
+	return 0;
+}
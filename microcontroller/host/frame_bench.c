@@ -0,0 +1,243 @@
+/*
+ * Host cost of per-sample frames vs HOST_FRAME_MULTI (CONFIG_DONGLE_RX_AGGREGATE).
+ *
+ * Builds the byte stream dongle_rx would send for the same samples from
+ * several gloves, once as one sample frame per sample and once as one
+ * combined frame per round, then times pi/dongleparse.c reading each back
+ * through dp_read_packet from a file, the way the game reads the tty.
+ * Both decodes must give the same samples in the same order.
+ *
+ * Output, one line per format:
+ *   format,gloves,samples,bytes_per_sample,ns_per_sample
+ *
+ * Usage: frame_bench [gloves (1-8, default 4)] [rounds (default 50000)]
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "glove_proto.h"
+#include "dongleparse.h"
+
+#define BENCH_RUNS 5
+
+struct stream {
+	uint8_t *buf;
+	size_t len;
+	size_t cap;
+};
+
+static void put(struct stream *s, const void *data, size_t len)
+{
+	if (s->len + len > s->cap) {
+		s->cap = (s->cap + len) * 2;
+		s->buf = realloc(s->buf, s->cap);
+		if (s->buf == NULL) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	memcpy(&s->buf[s->len], data, len);
+	s->len += len;
+}
+
+/* Same as dongle_rx */
+static uint16_t crc16_ccitt(const uint8_t *data, size_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (size_t i = 0; i < len; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int j = 0; j < 8; j++) {
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+static void put_crc(struct stream *s, const uint8_t *data, size_t len)
+{
+	uint16_t crc = crc16_ccitt(data, len);
+	uint8_t b[2] = { crc & 0xFF, crc >> 8 };
+
+	put(s, b, 2);
+}
+
+static void sample_values(int round, int pipe, float v[6])
+{
+	for (int i = 0; i < 6; i++) {
+		v[i] = sinf(0.01f * round + pipe + i) * (i < 3 ? 9.81f : 3.0f);
+	}
+}
+
+static void put_sample_frame(struct stream *s, uint8_t pipe, uint8_t button,
+			     uint16_t seq, const float v[6])
+{
+	uint8_t hdr[3] = { HOST_HEADER0, HOST_HEADER1, HOST_HEADER2_SAMPLE };
+	uint8_t payload[4 + 24];
+
+	payload[0] = pipe;
+	payload[1] = button;
+	payload[2] = seq & 0xFF;
+	payload[3] = seq >> 8;
+	memcpy(&payload[4], v, 24);
+
+	put(s, hdr, sizeof(hdr));
+	put(s, payload, sizeof(payload));
+	put_crc(s, payload, sizeof(payload));
+}
+
+static void put_multi_frame(struct stream *s, uint8_t present,
+			    const Multi_EntryPacked *entries, int n)
+{
+	uint8_t msg[3 + 2 + 1 + 8 * sizeof(Multi_EntryPacked)];
+	size_t len = 1 + n * sizeof(Multi_EntryPacked);
+
+	msg[0] = HOST_HEADER0;
+	msg[1] = HOST_HEADER1;
+	msg[2] = HOST_HEADER2_EXT;
+	msg[3] = HOST_FRAME_MULTI;
+	msg[4] = (uint8_t)len;
+	msg[5] = present;
+	memcpy(&msg[6], entries, n * sizeof(Multi_EntryPacked));
+
+	put(s, msg, 5 + len);
+	put_crc(s, &msg[3], 2 + len);
+}
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Decode the whole stream; returns seconds taken, fills out[] if given */
+static double decode(FILE *f, struct dp_packet *out, long expect, long *got)
+{
+	struct dp_packet pkt;
+	int fd = fileno(f);
+	double t0;
+
+	if (lseek(fd, 0, SEEK_SET) < 0) {
+		perror("lseek");
+		exit(1);
+	}
+
+	*got = 0;
+	t0 = now_s();
+	while (dp_read_packet(fd, &pkt) == 1) {
+		if (out != NULL && *got < expect) {
+			out[*got] = pkt;
+		}
+		(*got)++;
+	}
+	return now_s() - t0;
+}
+
+static FILE *to_file(const struct stream *s)
+{
+	FILE *f = tmpfile();
+
+	if (f == NULL || fwrite(s->buf, 1, s->len, f) != s->len || fflush(f) != 0) {
+		perror("tmpfile");
+		exit(1);
+	}
+	return f;
+}
+
+static int same(const struct dp_packet *a, const struct dp_packet *b)
+{
+	return a->pipe == b->pipe && a->button == b->button && a->seq == b->seq &&
+	       memcmp(&a->accel, &b->accel, sizeof(a->accel)) == 0 &&
+	       memcmp(&a->gyro, &b->gyro, sizeof(a->gyro)) == 0;
+}
+
+int main(int argc, char **argv)
+{
+	int gloves = argc > 1 ? atoi(argv[1]) : 4;
+	long rounds = argc > 2 ? atol(argv[2]) : 50000;
+	struct stream single = { 0 }, multi = { 0 };
+	uint16_t seq = 0;
+
+	if (gloves < 1 || gloves > 8 || rounds < 1) {
+		fprintf(stderr, "usage: %s [gloves 1-8] [rounds]\n", argv[0]);
+		return 2;
+	}
+
+	for (long r = 0; r < rounds; r++) {
+		Multi_EntryPacked entries[8];
+		uint8_t present = 0;
+
+		for (int p = 0; p < gloves; p++) {
+			uint8_t button = (r / 100 + p) % 7 == 0;
+			float v[6];
+
+			sample_values((int)r, p, v);
+			put_sample_frame(&single, (uint8_t)p, button, seq, v);
+
+			present |= 1u << p;
+			entries[p].button = button;
+			entries[p].seq = seq;
+			memcpy(entries[p].imu, v, sizeof(entries[p].imu));
+			seq++;
+		}
+		put_multi_frame(&multi, present, entries, gloves);
+	}
+
+	long samples = rounds * gloves;
+	struct dp_packet *a = malloc(samples * sizeof(*a));
+	struct dp_packet *b = malloc(samples * sizeof(*b));
+	FILE *fs = to_file(&single);
+	FILE *fm = to_file(&multi);
+	double best_s = INFINITY, best_m = INFINITY;
+	long got_s, got_m;
+
+	if (a == NULL || b == NULL) {
+		perror("malloc");
+		return 1;
+	}
+
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		double ts = decode(fs, run == 0 ? a : NULL, samples, &got_s);
+		double tm = decode(fm, run == 0 ? b : NULL, samples, &got_m);
+
+		best_s = fmin(best_s, ts);
+		best_m = fmin(best_m, tm);
+		if (got_s != samples || got_m != samples) {
+			fprintf(stderr, "FAIL: decoded %ld single, %ld multi, want %ld\n",
+				got_s, got_m, samples);
+			return 1;
+		}
+	}
+
+	for (long i = 0; i < samples; i++) {
+		if (!same(&a[i], &b[i])) {
+			fprintf(stderr, "FAIL: sample %ld differs between formats\n", i);
+			return 1;
+		}
+	}
+
+	printf("format,gloves,samples,bytes_per_sample,ns_per_sample\n");
+	printf("single,%d,%ld,%.1f,%.1f\n", gloves, samples,
+	       (double)single.len / samples, best_s * 1e9 / samples);
+	printf("multi,%d,%ld,%.1f,%.1f\n", gloves, samples,
+	       (double)multi.len / samples, best_m * 1e9 / samples);
+	fprintf(stderr, "multi: %.0f%% of the bytes, %.2fx faster to parse\n",
+		100.0 * multi.len / single.len, best_s / best_m);
+
+	fclose(fs);
+	fclose(fm);
+	free(a);
+	free(b);
+	free(single.buf);
+	free(multi.buf);
+	return 0;
+}
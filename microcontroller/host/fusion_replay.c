@@ -0,0 +1,395 @@
+/*
+ * Camera + IMU cursor fusion (pi/c-game/src/cursor_fusion.c) run offline.
+ *
+ * Replay: the IMU capture is run through the game cursor the way
+ * cursor_bench runs it, and the camera fixes are fed in -latency ms after
+ * their frame was taken, as they would reach the game. Output is the
+ * cursor with the IMU alone and fused, one line per IMU sample:
+ *   t,imu_x,imu_y,fused_x,fused_y
+ * The IMU capture is the ahrs_replay format on stdin (dt,ax,ay,az,gx,gy,gz,
+ * m/s^2 and rad/s), its first sample at t = dt. The camera file is what
+ * vision_dump.py writes from a recorded video, on the same clock:
+ *   t,valid,x,y     (x, y normalised 0..1 as in VisionData)
+ *
+ * -synth: a made-up glove path with a drifting, noisy IMU velocity and a
+ * 30 Hz camera that is late, noisy, misses frames and sometimes tracks the
+ * wrong blob. Each source is scored against the true path:
+ *   source,samples,rms_px,p95_px,max_px
+ * "imu" integrates the IMU alone, "camera" holds the newest fix, "fused"
+ * is the filter. -check exits 1 unless fused beats both and stays under
+ * CHECK_RMS_PX.
+ *
+ * Fusion counts (fixes used, rejected, resets, too late) go to stderr.
+ *
+ * Usage: fusion_replay -camera camera.csv [-mode accel|air] [-latency ms]
+ *                      [-screen w h] < capture.csv
+ *        fusion_replay -synth seconds [-latency ms] [-seed n] [-check]
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bias_tracker.h"
+#include "cursor_fusion.h"
+#include "cursor_motion.h"
+#include "imu_gravity.h"
+
+#define SYNTH_RATE_HZ   104.0f
+#define SYNTH_CAMERA_HZ 30.0f
+#define SYNTH_CAM_NOISE 3.0f    /* px */
+#define SYNTH_CAM_MISS  0.1f    /* frames with no blob */
+#define SYNTH_CAM_WRONG 0.02f   /* frames tracking something else */
+#define SYNTH_VEL_NOISE 20.0f   /* px/s */
+#define SYNTH_DRIFT     15.0f   /* px/s the IMU starts off by */
+#define SYNTH_DRIFT_WALK 5.0f   /* px/s per sqrt(s) */
+#define CHECK_RMS_PX    10.0f
+
+struct sample {
+	float dt;
+	float accel[3];
+	float gyro[3];
+};
+
+struct fix {
+	double t;
+	int valid;
+	float pos[2];
+};
+
+struct cursor {
+	int mode;
+	struct imu_gravity gravity;
+	struct air_motion air;
+	struct bias_tracker tracker;
+	float vel[2];
+};
+
+struct score {
+	double sum2;
+	float *err;
+	size_t n, cap;
+};
+
+static float screen_w = 800.0f, screen_h = 450.0f;
+static uint32_t rng_state;
+
+static void *grow(void *p, size_t n, size_t size)
+{
+	p = realloc(p, n * size);
+	if (!p) {
+		perror("realloc");
+		exit(1);
+	}
+	return p;
+}
+
+static float frand(void)
+{
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return (rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+static float gauss(void)
+{
+	float u = frand() + 1e-7f, v = frand();
+
+	return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+static void print_counts(const struct cursor_fusion *f)
+{
+	fprintf(stderr, "fusion: %u fixes used, %u rejected, %u resets, %u too late\n",
+		f->fixes, f->rejected, f->resets, f->stale);
+}
+
+/* --- replay -------------------------------------------------------------- */
+
+static struct fix *load_fixes(const char *path, size_t *count)
+{
+	FILE *f = fopen(path, "r");
+	struct fix *fixes = NULL;
+	size_t n = 0, cap = 0;
+	char line[128];
+	float x, y;
+	int valid;
+	double t;
+
+	if (!f) {
+		perror(path);
+		exit(1);
+	}
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "%lf,%d,%f,%f", &t, &valid, &x, &y) != 4) {
+			continue; /* header or blank line */
+		}
+		if (n == cap) {
+			cap = cap ? cap * 2 : 1024;
+			fixes = grow(fixes, cap, sizeof(*fixes));
+		}
+		fixes[n].t = t;
+		fixes[n].valid = valid;
+		fixes[n].pos[0] = x * screen_w;
+		fixes[n].pos[1] = y * screen_h;
+		n++;
+	}
+	fclose(f);
+	*count = n;
+	return fixes;
+}
+
+/* As cursor_bench: UpdateCursorSample() minus the sample clock, the cache
+   and the screen */
+static void cursor_init(struct cursor *c, int mode)
+{
+	memset(c, 0, sizeof(*c));
+	c->mode = mode;
+	imu_gravity_init(&c->gravity, IMU_GRAVITY_MAHONY);
+	air_motion_init(&c->air);
+	bias_tracker_init(&c->tracker);
+}
+
+static void cursor_update(struct cursor *c, const struct sample *s)
+{
+	float lin[3], a[2];
+
+	imu_gravity_update(&c->gravity, s->accel, s->gyro, s->dt, lin);
+	cursor_accel_axes(lin, a);
+	bias_tracker_update(&c->tracker, s->accel, s->gyro, a, s->dt);
+
+	if (c->mode == CURSOR_MODE_AIR) {
+		air_motion_update(&c->air, s->gyro, s->dt, c->vel);
+		return;
+	}
+	a[0] -= c->tracker.accel_bias[0];
+	a[1] = -(a[1] - c->tracker.accel_bias[1]);
+	accel_motion_step(c->vel, a, s->dt);
+}
+
+static int replay(const char *camera_path, int mode, float latency_s)
+{
+	size_t fix_count, next = 0;
+	struct fix *fixes = load_fixes(camera_path, &fix_count);
+	float start[2] = { screen_w / 2, screen_h / 2 };
+	float imu[2] = { start[0], start[1] }, fused[2];
+	struct cursor_fusion f;
+	struct cursor c;
+	char line[256];
+	struct sample s;
+	double t = 0;
+
+	cursor_init(&c, mode);
+	cursor_fusion_init(&f, NULL, start);
+
+	printf("t,imu_x,imu_y,fused_x,fused_y\n");
+	while (fgets(line, sizeof(line), stdin)) {
+		if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &s.dt, &s.accel[0],
+			   &s.accel[1], &s.accel[2], &s.gyro[0], &s.gyro[1],
+			   &s.gyro[2]) != 7) {
+			continue; /* header or blank line */
+		}
+		t += s.dt;
+		cursor_update(&c, &s);
+		cursor_fusion_imu(&f, t, c.vel, s.dt);
+		imu[0] += c.vel[0] * s.dt;
+		imu[1] += c.vel[1] * s.dt;
+
+		while (next < fix_count && fixes[next].t + latency_s <= t) {
+			if (fixes[next].valid) {
+				cursor_fusion_camera(&f, fixes[next].t, fixes[next].pos);
+			}
+			next++;
+		}
+		cursor_fusion_position(&f, fused);
+		printf("%.4f,%.1f,%.1f,%.1f,%.1f\n", t, imu[0], imu[1], fused[0], fused[1]);
+	}
+	print_counts(&f);
+	free(fixes);
+	return 0;
+}
+
+/* --- synthetic ----------------------------------------------------------- */
+
+/* Sweeps across most of the screen with a faster wobble on top */
+static void synth_path(double t, float pos[2], float vel[2])
+{
+	const double w1 = 2 * M_PI * 0.3, w2 = 2 * M_PI * 1.1;
+	const double w3 = 2 * M_PI * 0.23, w4 = 2 * M_PI * 0.9;
+
+	pos[0] = screen_w / 2 + 250 * sin(w1 * t) + 80 * sin(w2 * t + 1);
+	pos[1] = screen_h / 2 + 140 * sin(w3 * t + 0.5) + 50 * sin(w4 * t);
+	vel[0] = 250 * w1 * cos(w1 * t) + 80 * w2 * cos(w2 * t + 1);
+	vel[1] = 140 * w3 * cos(w3 * t + 0.5) + 50 * w4 * cos(w4 * t);
+}
+
+static void score_add(struct score *s, const float a[2], const float b[2])
+{
+	float dx = a[0] - b[0], dy = a[1] - b[1];
+	float e = sqrtf(dx * dx + dy * dy);
+
+	if (s->n == s->cap) {
+		s->cap = s->cap ? s->cap * 2 : 4096;
+		s->err = grow(s->err, s->cap, sizeof(*s->err));
+	}
+	s->err[s->n++] = e;
+	s->sum2 += (double)e * e;
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+	float x = *(const float *)a, y = *(const float *)b;
+
+	return (x > y) - (x < y);
+}
+
+static float score_print(const char *name, struct score *s)
+{
+	float rms = (float)sqrt(s->sum2 / s->n);
+
+	qsort(s->err, s->n, sizeof(*s->err), cmp_float);
+	printf("%s,%zu,%.2f,%.2f,%.2f\n", name, s->n, rms,
+	       s->err[(size_t)(0.95 * (s->n - 1) + 0.5)], s->err[s->n - 1]);
+	free(s->err);
+	return rms;
+}
+
+static int synth(float seconds, float latency_s, int check)
+{
+	const float dt = 1.0f / SYNTH_RATE_HZ;
+	const size_t steps = (size_t)(seconds * SYNTH_RATE_HZ);
+	const int cam_ring = 64;
+	struct fix cam[64];
+	int cam_head = 0, cam_count = 0;
+	struct score s_imu = { 0 }, s_cam = { 0 }, s_fused = { 0 };
+	struct cursor_fusion f;
+	float truth[2], vel[2], imu[2], held[2], fused[2], drift[2];
+	double next_frame = 0;
+	int have_held = 0;
+
+	synth_path(0, truth, vel);
+	memcpy(imu, truth, sizeof(imu));
+	/* The filter starts not knowing where the glove is */
+	cursor_fusion_init(&f, NULL, (float[2]){ screen_w / 2, screen_h / 2 });
+	drift[0] = SYNTH_DRIFT;
+	drift[1] = -SYNTH_DRIFT;
+
+	for (size_t k = 1; k <= steps; k++) {
+		double t = k * dt;
+		float measured[2];
+
+		synth_path(t, truth, vel);
+		for (int i = 0; i < 2; i++) {
+			drift[i] += SYNTH_DRIFT_WALK * sqrtf(dt) * gauss();
+			measured[i] = vel[i] + drift[i] + SYNTH_VEL_NOISE * gauss();
+			imu[i] += measured[i] * dt;
+		}
+		cursor_fusion_imu(&f, t, measured, dt);
+
+		/* Camera frames are taken now and arrive latency_s later */
+		if (t >= next_frame && cam_count < cam_ring) {
+			struct fix *c = &cam[(cam_head + cam_count) % cam_ring];
+			float r = frand();
+
+			c->t = t;
+			c->valid = r >= SYNTH_CAM_MISS;
+			if (r < SYNTH_CAM_MISS + SYNTH_CAM_WRONG) {
+				c->pos[0] = screen_w * frand();
+				c->pos[1] = screen_h * frand();
+			} else {
+				c->pos[0] = truth[0] + SYNTH_CAM_NOISE * gauss();
+				c->pos[1] = truth[1] + SYNTH_CAM_NOISE * gauss();
+			}
+			cam_count++;
+			next_frame += 1.0 / SYNTH_CAMERA_HZ;
+		}
+		while (cam_count && cam[cam_head].t + latency_s <= t) {
+			if (cam[cam_head].valid) {
+				cursor_fusion_camera(&f, cam[cam_head].t, cam[cam_head].pos);
+				memcpy(held, cam[cam_head].pos, sizeof(held));
+				have_held = 1;
+			}
+			cam_head = (cam_head + 1) % cam_ring;
+			cam_count--;
+		}
+		cursor_fusion_position(&f, fused);
+
+		/* Scored once everything has had a first fix */
+		if (have_held) {
+			score_add(&s_imu, imu, truth);
+			score_add(&s_cam, held, truth);
+			score_add(&s_fused, fused, truth);
+		}
+	}
+	if (!s_fused.n) {
+		fprintf(stderr, "too short for the camera latency\n");
+		return 1;
+	}
+
+	printf("source,samples,rms_px,p95_px,max_px\n");
+	float imu_rms = score_print("imu", &s_imu);
+	float cam_rms = score_print("camera", &s_cam);
+	float fused_rms = score_print("fused", &s_fused);
+
+	print_counts(&f);
+	if (check && (fused_rms >= imu_rms || fused_rms >= cam_rms || fused_rms > CHECK_RMS_PX)) {
+		fprintf(stderr, "check failed: fused %.2f px RMS\n", fused_rms);
+		return 1;
+	}
+	return 0;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s -camera camera.csv [-mode accel|air] [-latency ms]\n"
+		"          [-screen w h] < capture.csv\n"
+		"       %s -synth seconds [-latency ms] [-seed n] [-check]\n", prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+	const char *camera = NULL;
+	int mode = CURSOR_MODE_ACCEL, check = 0;
+	float seconds = 0, latency_ms = 60.0f;
+
+	rng_state = 1;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-camera") && i + 1 < argc) {
+			camera = argv[++i];
+		} else if (!strcmp(argv[i], "-synth") && i + 1 < argc) {
+			seconds = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-mode") && i + 1 < argc) {
+			i++;
+			if (!strcmp(argv[i], "air")) {
+				mode = CURSOR_MODE_AIR;
+			} else if (strcmp(argv[i], "accel")) {
+				usage(argv[0]);
+				return 2;
+			}
+		} else if (!strcmp(argv[i], "-latency") && i + 1 < argc) {
+			latency_ms = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-screen") && i + 2 < argc) {
+			screen_w = strtof(argv[++i], NULL);
+			screen_h = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-seed") && i + 1 < argc) {
+			rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+		} else if (!strcmp(argv[i], "-check")) {
+			check = 1;
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if ((!camera) == (seconds <= 0) || latency_ms < 0 || screen_w <= 0 || screen_h <= 0) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	if (camera) {
+		return replay(camera, mode, latency_ms * 1e-3f);
+	}
+	return synth(seconds, latency_ms * 1e-3f, check);
+}
@@ -0,0 +1,386 @@
+/*
+ * Gravity removal for the game cursor (pi/c-game/src/imu_gravity.c): the
+ * old high-pass filter against the gyro-aided attitude filters, on a
+ * recorded capture or on synthetic motion with known linear acceleration.
+ *
+ * Input (stdin) is the ahrs_replay capture format, one sample per line,
+ * gyro in rad/s and accel in m/s^2:
+ *   dt,ax,ay,az,gx,gy,gz
+ * -synth generates tilts, swipes and rests instead, with sensor noise and
+ * gyro bias, and also scores each filter against the true values.
+ *
+ * Output, one line per filter:
+ *   filter,samples,ns_per_update,core_pct_8_gloves,still_accel_rms,
+ *   still_vel_rms,err_rms,move_err_rms
+ * still_* are over samples where the glove is not moving (gyro and |accel|
+ * near rest): accel left after gravity removal, and the speed the cursor
+ * integrator would creep at. err_* are x/y linear accel against the truth,
+ * over all samples and while the glove is moving (-synth only, else -1).
+ * core_pct_8_gloves is one core's time spent on eight gloves at the
+ * capture's sample rate.
+ *
+ * -dump writes the samples out in the capture format, for the other tools.
+ *
+ * Usage: gravity_bench [-synth seconds [-dump file]] [-seed n] [-repeat n]
+ *                      [< capture.csv]
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "imu_gravity.h"
+
+#define SYNTH_RATE_HZ   104.0f
+#define SYNTH_REST_S    2.0f    /* at rest first, as the cursor calibration expects */
+#define GLOVES          8
+/* Rest detection, same idea as a human watching the trace */
+#define STILL_GYRO      0.1f    /* rad/s */
+#define STILL_ACCEL     0.3f    /* m/s^2 from 1 g */
+/* Cursor velocity damping in imu_cursor.c: 0.9 per 1/60 s */
+#define DAMPING         0.9f
+#define DAMPING_RATE_HZ 60.0f
+
+struct sample {
+	float dt;
+	float accel[3];
+	float gyro[3];
+	float lin[3];   /* truth, -synth only */
+	int moving;     /* truth, -synth only */
+};
+
+static struct sample *samples;
+static size_t sample_count, sample_cap;
+static int have_truth;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static struct sample *add_sample(void)
+{
+	if (sample_count == sample_cap) {
+		sample_cap = sample_cap ? sample_cap * 2 : 4096;
+		samples = realloc(samples, sample_cap * sizeof(*samples));
+		if (!samples) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	memset(&samples[sample_count], 0, sizeof(*samples));
+	return &samples[sample_count++];
+}
+
+static void load_capture(FILE *f)
+{
+	char line[256];
+
+	while (fgets(line, sizeof(line), f)) {
+		struct sample s;
+
+		if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &s.dt, &s.accel[0],
+			   &s.accel[1], &s.accel[2], &s.gyro[0], &s.gyro[1],
+			   &s.gyro[2]) != 7) {
+			continue; /* header or blank line */
+		}
+		struct sample *d = add_sample();
+
+		d->dt = s.dt;
+		memcpy(d->accel, s.accel, sizeof(s.accel));
+		memcpy(d->gyro, s.gyro, sizeof(s.gyro));
+	}
+}
+
+/* --- synthetic motion ---------------------------------------------------- */
+
+static uint32_t rng_state;
+
+static float frand(void)
+{
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return (rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+static float gauss(void)
+{
+	float u = frand() + 1e-7f, v = frand();
+
+	return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+static void quat_from_euler(float roll, float pitch, float yaw, float q[4])
+{
+	float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+	float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+	float cy = cosf(yaw * 0.5f), sy = sinf(yaw * 0.5f);
+
+	q[0] = cr * cp * cy + sr * sp * sy;
+	q[1] = sr * cp * cy - cr * sp * sy;
+	q[2] = cr * sp * cy + sr * cp * sy;
+	q[3] = cr * cp * sy - sr * sp * cy;
+}
+
+static void quat_mul(const float a[4], const float b[4], float out[4])
+{
+	out[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+	out[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+	out[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+	out[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+/* World vector into the body frame: conj(q) * v * q */
+static void to_body(const float q[4], const float v[3], float out[3])
+{
+	float qc[4] = { q[0], -q[1], -q[2], -q[3] };
+	float p[4] = { 0.0f, v[0], v[1], v[2] };
+	float t[4], r[4];
+
+	quat_mul(qc, p, t);
+	quat_mul(t, q, r);
+	out[0] = r[1];
+	out[1] = r[2];
+	out[2] = r[3];
+}
+
+static float smoothstep(float x)
+{
+	if (x <= 0.0f) {
+		return 0.0f;
+	}
+	if (x >= 1.0f) {
+		return 1.0f;
+	}
+	return x * x * (3.0f - 2.0f * x);
+}
+
+/*
+ * After SYNTH_REST_S at rest, two second cycles: 0.5 s turning to a new tilt (up to 40 degrees) and
+ * heading, 0.5 s held, a 0.4 s swipe across (one sine period of
+ * acceleration, so the hand ends at rest), 0.6 s still.
+ */
+static void synth(float seconds)
+{
+	const float dt = 1.0f / SYNTH_RATE_HZ;
+	const float max_tilt = 40.0f * (float)M_PI / 180.0f;
+	float bias[3], from[3] = { 0 }, to[3] = { 0 }, swipe[2] = { 0 };
+	float q_prev[4];
+	size_t n = (size_t)(seconds * SYNTH_RATE_HZ);
+
+	for (int i = 0; i < 3; i++) {
+		bias[i] = 0.02f * (2.0f * frand() - 1.0f);
+	}
+	quat_from_euler(0, 0, 0, q_prev);
+
+	for (size_t k = 0; k <= n; k++) {
+		float t = k * dt;
+		float phase = t < SYNTH_REST_S ? 1.9f : fmodf(t - SYNTH_REST_S, 2.0f);
+		float e[3], q[4], dq[4], qc[4], a_world[3] = { 0, 0, AHRS_GRAVITY };
+		int moving = 0;
+
+		if (phase < dt * 0.5f) {
+			memcpy(from, to, sizeof(from));
+			to[0] = max_tilt * (2.0f * frand() - 1.0f);
+			to[1] = max_tilt * (2.0f * frand() - 1.0f);
+			to[2] = from[2] + (float)M_PI * 0.5f * (2.0f * frand() - 1.0f);
+			float dir = 2.0f * (float)M_PI * frand();
+
+			swipe[0] = 8.0f * cosf(dir);
+			swipe[1] = 8.0f * sinf(dir);
+		}
+		float s = smoothstep(phase / 0.5f);
+
+		for (int i = 0; i < 3; i++) {
+			e[i] = from[i] + (to[i] - from[i]) * s;
+		}
+		if (phase < 0.5f) {
+			moving = 1;
+		} else if (phase >= 1.0f && phase < 1.4f) {
+			float w = sinf(2.0f * (float)M_PI * (phase - 1.0f) / 0.4f);
+
+			a_world[0] += swipe[0] * w;
+			a_world[1] += swipe[1] * w;
+			moving = 1;
+		}
+		quat_from_euler(e[0], e[1], e[2], q);
+
+		struct sample *d = add_sample();
+		float lin_world[3] = { a_world[0], a_world[1], 0.0f };
+
+		d->dt = dt;
+		d->moving = moving;
+		to_body(q, a_world, d->accel);
+		to_body(q, lin_world, d->lin);
+
+		/* Body rate from the attitude change: omega = 2 * conj(q) * dq/dt */
+		qc[0] = q_prev[0];
+		qc[1] = -q_prev[1];
+		qc[2] = -q_prev[2];
+		qc[3] = -q_prev[3];
+		quat_mul(qc, q, dq);
+		if (dq[0] < 0.0f) {
+			for (int i = 0; i < 4; i++) {
+				dq[i] = -dq[i];
+			}
+		}
+		for (int i = 0; i < 3; i++) {
+			d->gyro[i] = (k ? 2.0f * dq[i + 1] / dt : 0.0f) + bias[i] + 0.005f * gauss();
+			d->accel[i] += 0.05f * gauss();
+		}
+		memcpy(q_prev, q, sizeof(q_prev));
+	}
+	have_truth = 1;
+}
+
+/* --- scoring -------------------------------------------------------------- */
+
+static int is_still(const struct sample *s)
+{
+	float g = sqrtf(s->gyro[0] * s->gyro[0] + s->gyro[1] * s->gyro[1] +
+			s->gyro[2] * s->gyro[2]);
+	float a = sqrtf(s->accel[0] * s->accel[0] + s->accel[1] * s->accel[1] +
+			s->accel[2] * s->accel[2]);
+
+	if (have_truth) {
+		return !s->moving;
+	}
+	return g < STILL_GYRO && fabsf(a - AHRS_GRAVITY) < STILL_ACCEL;
+}
+
+static void run(int mode, int repeat)
+{
+	struct imu_gravity g;
+	double busy_ns = 0, total_s = 0;
+	double still_a = 0, still_v = 0, err = 0, move_err = 0;
+	size_t still_n = 0, move_n = 0;
+	float lin[3], vel[2] = { 0 };
+
+	/* Timing pass, repeated so short captures still give a stable figure */
+	for (int r = 0; r < repeat; r++) {
+		imu_gravity_init(&g, mode);
+		double t0 = now_ns();
+
+		for (size_t k = 0; k < sample_count; k++) {
+			imu_gravity_update(&g, samples[k].accel, samples[k].gyro,
+					   samples[k].dt, lin);
+		}
+		busy_ns += now_ns() - t0;
+	}
+
+	imu_gravity_init(&g, mode);
+	for (size_t k = 0; k < sample_count; k++) {
+		const struct sample *s = &samples[k];
+		float damping = powf(DAMPING, s->dt * DAMPING_RATE_HZ);
+
+		imu_gravity_update(&g, s->accel, s->gyro, s->dt, lin);
+		total_s += s->dt;
+		vel[0] = (vel[0] + lin[0] * s->dt) * damping;
+		vel[1] = (vel[1] + lin[1] * s->dt) * damping;
+
+		if (is_still(s)) {
+			still_a += lin[0] * lin[0] + lin[1] * lin[1];
+			still_v += vel[0] * vel[0] + vel[1] * vel[1];
+			still_n++;
+		}
+		if (have_truth) {
+			float ex = lin[0] - s->lin[0], ey = lin[1] - s->lin[1];
+
+			err += ex * ex + ey * ey;
+			if (s->moving) {
+				move_err += ex * ex + ey * ey;
+				move_n++;
+			}
+		}
+	}
+
+	double ns = busy_ns / ((double)sample_count * repeat);
+	double rate = total_s > 0 ? sample_count / total_s : 0;
+
+	printf("%s,%zu,%.1f,%.4f,%.4f,%.4f,%.4f,%.4f\n", imu_gravity_name(mode),
+	       sample_count, ns, ns * 1e-9 * rate * GLOVES * 100.0,
+	       still_n ? sqrt(still_a / still_n) : -1.0,
+	       still_n ? sqrt(still_v / still_n) : -1.0,
+	       have_truth ? sqrt(err / sample_count) : -1.0,
+	       have_truth && move_n ? sqrt(move_err / move_n) : -1.0);
+}
+
+static void dump(const char *path)
+{
+	FILE *f = fopen(path, "w");
+
+	if (!f) {
+		perror(path);
+		exit(1);
+	}
+	fprintf(f, "dt,ax,ay,az,gx,gy,gz\n");
+	for (size_t k = 0; k < sample_count; k++) {
+		const struct sample *s = &samples[k];
+
+		fprintf(f, "%.7f,%.5f,%.5f,%.5f,%.6f,%.6f,%.6f\n", s->dt,
+			s->accel[0], s->accel[1], s->accel[2], s->gyro[0],
+			s->gyro[1], s->gyro[2]);
+	}
+	fclose(f);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-synth seconds [-dump file]] [-seed n] [-repeat n]\n"
+		"          [< capture.csv]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	float synth_s = 0;
+	const char *dump_path = NULL;
+	int repeat = 20;
+
+	rng_state = 1;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-synth") && i + 1 < argc) {
+			synth_s = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-dump") && i + 1 < argc) {
+			dump_path = argv[++i];
+		} else if (!strcmp(argv[i], "-seed") && i + 1 < argc) {
+			rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+		} else if (!strcmp(argv[i], "-repeat") && i + 1 < argc) {
+			repeat = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if (repeat < 1 || (dump_path && synth_s <= 0)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	if (synth_s > 0) {
+		synth(synth_s);
+	} else {
+		load_capture(stdin);
+	}
+	if (sample_count == 0) {
+		fprintf(stderr, "no samples\n");
+		return 1;
+	}
+
+	if (dump_path) {
+		dump(dump_path);
+	}
+
+	printf("filter,samples,ns_per_update,core_pct_8_gloves,still_accel_rms,"
+	       "still_vel_rms,err_rms,move_err_rms\n");
+	run(IMU_GRAVITY_HIGHPASS, repeat);
+	run(IMU_GRAVITY_MAHONY, repeat);
+	run(IMU_GRAVITY_MADGWICK, repeat);
+	free(samples);
+	return 0;
+}
@@ -0,0 +1,423 @@
+/*
+ * Deterministic model of the glove radio link, for checking the adaptive
+ * link controller (imu_tx/src/link_ctrl.c) without hardware.
+ *
+ * One glove samples at params.odr_hz, packs params.batch samples per payload
+ * and queues payloads the way imu_tx does with CONFIG_IMU_TX_PIPELINED
+ * (queue depth, max age, oldest-waiting payload superseded when full). Each
+ * transmit attempt is lost with the scenario's probability; in the crowded
+ * scenario other gloves collide with us, and a retry lands on their retry
+ * again unless the retransmit delay is long compared with the packet.
+ *
+ * Output, one line per scenario phase:
+ *   scenario,mode,phase,taken,delivered,mean_ms,max_ms,delay_us,count,batch,odr
+ *
+ * -check runs every scenario, adaptive and fixed, and exits non-zero if the
+ * controller broke its latency bound or left its limits, delivered fewer
+ * samples than the fixed settings on a bad link, or is not repeatable.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "link_ctrl.h"
+
+#define SIM_PHASES       3
+#define SIM_PHASE_US     (20u * 1000000u)
+#define SIM_WINDOW_US    500000u     /* CONFIG_IMU_TX_LINK_PERIOD_MS */
+#define SIM_QUEUE_DEPTH  4           /* CONFIG_IMU_TX_QUEUE_DEPTH */
+#define SIM_MAX_AGE_US   20000u      /* CONFIG_IMU_TX_MAX_AGE_MS */
+#define SIM_BATCH_MAX    4
+
+struct scenario {
+	const char *name;
+	float loss[SIM_PHASES];     /* per-attempt loss from noise */
+	int others[SIM_PHASES];     /* other gloves on the channel */
+};
+
+static const struct scenario scenarios[] = {
+	{ "clean",   { 0.01f, 0.01f, 0.01f }, { 0, 0, 0 } },
+	{ "noisy",   { 0.01f, 0.60f, 0.01f }, { 0, 0, 0 } },
+	{ "crowded", { 0.01f, 0.01f, 0.01f }, { 0, 6, 0 } },
+};
+
+#define OTHER_PKT_PER_S 104.0
+
+struct payload {
+	uint64_t t_first_us;    /* first sample in the payload */
+	uint64_t t_queued_us;
+	uint32_t period_us;
+	uint8_t n;
+};
+
+struct phase_stats {
+	uint64_t taken;
+	uint64_t delivered;
+	double lat_sum_ms;
+	double lat_max_ms;
+	struct link_params params;   /* at the end of the phase */
+};
+
+struct result {
+	struct phase_stats phase[SIM_PHASES];
+	int violations;
+};
+
+static uint32_t rng_state;
+
+static double rng_uniform(void)
+{
+	/* xorshift32, fixed seed per run so results are repeatable */
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return (rng_state >> 8) * (1.0 / 16777216.0);
+}
+
+struct sim {
+	const struct scenario *sc;
+	struct link_ctrl ctrl;
+	int adaptive;
+
+	struct payload queue[SIM_QUEUE_DEPTH];
+	int q_head, q_count;
+	int busy;
+	int busy_ok;
+	uint32_t busy_attempts;
+	uint64_t busy_until_us;
+
+	uint64_t batch_t_first_us;
+	uint8_t batch_n;
+
+	struct link_window win;
+	struct result *res;
+};
+
+static struct payload *q_at(struct sim *s, int i)
+{
+	return &s->queue[(s->q_head + i) % SIM_QUEUE_DEPTH];
+}
+
+static void q_drop_head(struct sim *s)
+{
+	s->q_head = (s->q_head + 1) % SIM_QUEUE_DEPTH;
+	s->q_count--;
+}
+
+static int phase_of(uint64_t t_us)
+{
+	int p = (int)(t_us / SIM_PHASE_US);
+
+	return p < SIM_PHASES ? p : SIM_PHASES - 1;
+}
+
+/* Probability one attempt is lost; collided says the previous one collided */
+static double attempt_loss(const struct sim *s, uint64_t t_us, uint32_t airtime_us,
+			   int collided)
+{
+	int ph = phase_of(t_us);
+	double noise = s->sc->loss[ph];
+	int others = s->sc->others[ph];
+	double hit = 0.0;
+
+	if (others > 0) {
+		/* Any other packet overlapping ours, either way round */
+		double busy = others * OTHER_PKT_PER_S * 2.0 * airtime_us * 1e-6;
+
+		hit = 1.0 - exp(-busy);
+		if (collided) {
+			/* The glove we hit is retrying on the same schedule */
+			double again = 2.0 * airtime_us /
+				       (double)s->ctrl.params.retransmit_delay_us;
+
+			hit = hit + (1.0 - hit) * (again > 1.0 ? 1.0 : again);
+		}
+	}
+	return 1.0 - (1.0 - noise) * (1.0 - hit);
+}
+
+static void radio_kick(struct sim *s, uint64_t now)
+{
+	const struct link_params *p = &s->ctrl.params;
+
+	while (s->q_count > 0 && now - q_at(s, 0)->t_queued_us > SIM_MAX_AGE_US) {
+		q_drop_head(s);
+		s->win.dropped++;
+	}
+	if (s->busy || s->q_count == 0) {
+		return;
+	}
+
+	uint32_t len = 1 + q_at(s, 0)->n * s->ctrl.cfg.sample_bytes;
+	uint32_t air = link_airtime_us(len);
+	uint32_t slot = air + 150 + link_ack_airtime_us();
+	int collided = 0;
+	uint32_t a;
+
+	if (p->retransmit_delay_us > slot) {
+		slot = p->retransmit_delay_us;
+	}
+
+	s->busy_ok = 0;
+	for (a = 1; a <= (uint32_t)p->retransmit_count + 1u; a++) {
+		double loss = attempt_loss(s, now, air, collided);
+
+		if (rng_uniform() >= loss) {
+			s->busy_ok = 1;
+			break;
+		}
+		collided = s->sc->others[phase_of(now)] > 0;
+	}
+	if (!s->busy_ok) {
+		a = p->retransmit_count + 1u;
+	}
+
+	s->busy = 1;
+	s->busy_attempts = a;
+	s->busy_until_us = now + (uint64_t)a * slot;
+}
+
+static void radio_done(struct sim *s)
+{
+	struct payload *pl = q_at(s, 0);
+	uint64_t now = s->busy_until_us;
+
+	s->win.retransmits += s->busy_attempts - 1;
+	if (s->busy_ok) {
+		struct phase_stats *ps = &s->res->phase[phase_of(now)];
+
+		s->win.success++;
+		for (int i = 0; i < pl->n; i++) {
+			double ms = (now - (pl->t_first_us + (uint64_t)i * pl->period_us)) / 1000.0;
+
+			ps->delivered++;
+			ps->lat_sum_ms += ms;
+			if (ms > ps->lat_max_ms) {
+				ps->lat_max_ms = ms;
+			}
+		}
+	} else {
+		s->win.failed++;
+	}
+	s->busy = 0;
+	q_drop_head(s);
+	radio_kick(s, now);
+}
+
+static void enqueue(struct sim *s, uint64_t now, uint32_t period_us)
+{
+	if (s->q_count == SIM_QUEUE_DEPTH) {
+		int first = s->busy ? 1 : 0;
+
+		for (int i = first; i + 1 < s->q_count; i++) {
+			*q_at(s, i) = *q_at(s, i + 1);
+		}
+		s->q_count--;
+		s->win.dropped++;
+	}
+
+	struct payload *pl = q_at(s, s->q_count);
+
+	pl->t_first_us = s->batch_t_first_us;
+	pl->t_queued_us = now;
+	pl->period_us = period_us;
+	pl->n = s->batch_n;
+	s->q_count++;
+	s->batch_n = 0;
+	radio_kick(s, now);
+}
+
+static int check_params(const struct link_ctrl *c)
+{
+	const struct link_params *p = &c->params;
+	int bad = 0;
+
+	if (link_worst_latency_us(&c->cfg, p) > c->cfg.latency_target_us) {
+		bad++;
+	}
+	if (p->batch < 1 || p->batch > c->cfg.batch_max ||
+	    p->odr_hz < c->cfg.odr_min_hz || p->odr_hz > c->home.odr_hz ||
+	    !link_odr_valid(p->odr_hz) ||
+	    p->retransmit_count > c->cfg.count_max ||
+	    p->retransmit_delay_us > c->cfg.delay_max_us) {
+		bad++;
+	}
+	return bad;
+}
+
+static void run(const struct scenario *sc, int adaptive, uint32_t seed,
+		struct result *res)
+{
+	struct link_ctrl_config cfg;
+	struct link_params start = {
+		.retransmit_delay_us = 600,
+		.retransmit_count = 3,
+		.batch = 1,
+		.odr_hz = 104,
+	};
+	static struct sim s;
+
+	memset(&s, 0, sizeof(s));
+	memset(res, 0, sizeof(*res));
+	rng_state = seed ? seed : 1;
+
+	link_ctrl_default_config(&cfg);
+	cfg.batch_max = SIM_BATCH_MAX;
+	link_ctrl_init(&s.ctrl, &cfg, &start);
+	s.sc = sc;
+	s.adaptive = adaptive;
+	s.res = res;
+
+	uint64_t end = (uint64_t)SIM_PHASES * SIM_PHASE_US;
+	uint64_t next_sample = 0;
+	uint64_t next_window = SIM_WINDOW_US;
+	int last_phase = 0;
+
+	while (next_sample < end) {
+		if (s.busy && s.busy_until_us <= next_sample &&
+		    s.busy_until_us <= next_window) {
+			radio_done(&s);
+			continue;
+		}
+		if (next_window <= next_sample) {
+			if (adaptive) {
+				link_ctrl_update(&s.ctrl, &s.win);
+				res->violations += check_params(&s.ctrl);
+			}
+			memset(&s.win, 0, sizeof(s.win));
+			next_window += SIM_WINDOW_US;
+			continue;
+		}
+
+		uint64_t now = next_sample;
+		uint32_t period = 1000000u / s.ctrl.params.odr_hz;
+		int ph = phase_of(now);
+
+		if (ph != last_phase) {
+			res->phase[last_phase].params = s.ctrl.params;
+			last_phase = ph;
+		}
+		res->phase[ph].taken++;
+		if (s.batch_n == 0) {
+			s.batch_t_first_us = now;
+		}
+		s.batch_n++;
+		if (s.batch_n >= s.ctrl.params.batch) {
+			enqueue(&s, now, period);
+		}
+		next_sample += period;
+	}
+	res->phase[last_phase].params = s.ctrl.params;
+}
+
+static void print_result(const struct scenario *sc, int adaptive,
+			 const struct result *res)
+{
+	for (int i = 0; i < SIM_PHASES; i++) {
+		const struct phase_stats *ps = &res->phase[i];
+
+		printf("%s,%s,%d,%llu,%llu,%.2f,%.2f,%u,%u,%u,%u\n",
+		       sc->name, adaptive ? "adaptive" : "fixed", i,
+		       (unsigned long long)ps->taken,
+		       (unsigned long long)ps->delivered,
+		       ps->delivered ? ps->lat_sum_ms / ps->delivered : 0.0,
+		       ps->lat_max_ms,
+		       ps->params.retransmit_delay_us, ps->params.retransmit_count,
+		       ps->params.batch, ps->params.odr_hz);
+	}
+}
+
+static uint64_t total_delivered(const struct result *res)
+{
+	uint64_t n = 0;
+
+	for (int i = 0; i < SIM_PHASES; i++) {
+		n += res->phase[i].delivered;
+	}
+	return n;
+}
+
+static int check(uint32_t seed)
+{
+	int failures = 0;
+
+	for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+		const struct scenario *sc = &scenarios[i];
+		struct result adaptive, again, fixed;
+
+		run(sc, 1, seed, &adaptive);
+		run(sc, 1, seed, &again);
+		run(sc, 0, seed, &fixed);
+		print_result(sc, 1, &adaptive);
+		print_result(sc, 0, &fixed);
+
+		if (adaptive.violations) {
+			printf("FAIL %s: %d windows outside latency target or limits\n",
+			       sc->name, adaptive.violations);
+			failures++;
+		}
+		if (memcmp(&adaptive, &again, sizeof(adaptive)) != 0) {
+			printf("FAIL %s: not repeatable\n", sc->name);
+			failures++;
+		}
+		if (total_delivered(&adaptive) < total_delivered(&fixed)) {
+			printf("FAIL %s: adaptive delivered %llu < fixed %llu\n",
+			       sc->name,
+			       (unsigned long long)total_delivered(&adaptive),
+			       (unsigned long long)total_delivered(&fixed));
+			failures++;
+		}
+	}
+	printf("%s\n", failures ? "FAILED" : "OK");
+	return failures ? 1 : 0;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-scenario clean|noisy|crowded] [-fixed] [-seed N] [-check]\n",
+		prog);
+}
+
+int main(int argc, char **argv)
+{
+	const char *name = NULL;
+	int adaptive = 1;
+	int do_check = 0;
+	uint32_t seed = 12345;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-scenario") == 0 && i + 1 < argc) {
+			name = argv[++i];
+		} else if (strcmp(argv[i], "-fixed") == 0) {
+			adaptive = 0;
+		} else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) {
+			seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+		} else if (strcmp(argv[i], "-check") == 0) {
+			do_check = 1;
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (do_check) {
+		return check(seed);
+	}
+
+	printf("scenario,mode,phase,taken,delivered,mean_ms,max_ms,delay_us,count,batch,odr\n");
+	for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+		struct result res;
+
+		if (name && strcmp(name, scenarios[i].name) != 0) {
+			continue;
+		}
+		run(&scenarios[i], adaptive, seed, &res);
+		print_result(&scenarios[i], adaptive, &res);
+	}
+	return 0;
+}
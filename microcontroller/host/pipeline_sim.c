@@ -0,0 +1,817 @@
+/*
+ * Glove -> dongle -> Pi pipeline on one Linux machine.
+ *
+ * Simulated gloves sample at -odr (synthetic motion, or a capture replayed
+ * with -capture), pack payloads with the same common/glove_wire.c code as
+ * imu_tx and queue them the way CONFIG_IMU_TX_PIPELINED does. Payloads
+ * cross a shared simulated channel (sim_radio.c: Bernoulli or
+ * Gilbert-Elliott loss, airtime, ACK/retransmit timing, collisions between
+ * gloves) and are unpacked and framed by the dongle's glove_wire.c code.
+ * Each glove's sample clock is off by a few tenths of a percent, as real
+ * IMUs are, so gloves drift through each other's slots.
+ *
+ * By default it runs in real time: frames are batched like the dongle's USB
+ * output and written to a pseudo-terminal, so the game or testFinalProject
+ * can be pointed at the printed /dev/pts path instead of /dev/ttyACM0.
+ * -bench reads the pty back with pi/dongleparse.c in a second thread and
+ * reports, per sample, glove sampling -> dongle receive (radio) and
+ * glove sampling -> dp_read_packet returning (end to end), one line:
+ *   gloves,odr_hz,batch,loss,generated,radio_delivered,host_received,
+ *   radio_p50_us,radio_p99_us,e2e_p50_us,e2e_p90_us,e2e_p99_us,e2e_max_us
+ *
+ * -virtual runs the same gloves, channel and dongle in simulated time with
+ * no pty and reports the channel, and -sweep does that for a built-in set
+ * of configurations, one line each:
+ *   name,gloves,odr_hz,batch,bitrate_kbps,delay_us,count,ack,
+ *   p_gb,p_bg,loss_good,loss_bad,generated,delivered,delivered_pct,
+ *   p50_us,p90_us,p99_us,max_us,duplicates,collisions,failed,dropped
+ * Latency there is glove sampling -> dongle receive; duplicates are copies
+ * ESB's PID check discards after a lost ACK; failed payloads ran out of
+ * retransmits; dropped ones aged out or were superseded in the glove queue.
+ *
+ * Usage: pipeline_sim [-gloves n] [-odr hz] [-batch n] [-bitrate 1000|2000]
+ *                     [-loss p | -ge p_gb p_bg loss_good loss_bad]
+ *                     [-retransmit delay_us count] [-noack] [-timestamp]
+ *                     [-capture file.csv] [-seconds s]
+ *                     [-bench | -virtual | -sweep]
+ *
+ * Created by Robbie Leslie 2025
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "glove_wire.h"
+#include "dongleparse.h"
+#include "sim_radio.h"
+
+#define SIM_GLOVES_MAX      7           /* pipes 1-7 */
+#define SIM_QUEUE_DEPTH     4           /* CONFIG_IMU_TX_QUEUE_DEPTH */
+#define SIM_MAX_AGE_US      20000u      /* CONFIG_IMU_TX_MAX_AGE_MS */
+#define SIM_BATCH_MAX       7           /* CONFIG_IMU_TX_BATCH_MAX range */
+#define SIM_PAYLOAD_MAX     192         /* CONFIG_ESB_MAX_PAYLOAD_LENGTH */
+
+#define USB_BUF_SIZE        2048        /* CONFIG_DONGLE_RX_USB_BUF_SIZE */
+#define USB_BATCH_BYTES     256         /* CONFIG_DONGLE_RX_USB_BATCH_BYTES */
+#define USB_MAX_LATENCY_US  1000        /* CONFIG_DONGLE_RX_USB_MAX_LATENCY_US */
+#define STATS_PERIOD_US     1000000u    /* CONFIG_DONGLE_RX_STATS_PERIOD_MS */
+
+#define SEQ_SPACE           65536
+
+enum mode {
+	MODE_REALTIME,
+	MODE_BENCH,
+	MODE_VIRTUAL,
+	MODE_SWEEP,
+};
+
+struct config {
+	const char *name;
+	int gloves;
+	uint32_t odr_hz;
+	int batch;
+	uint16_t bitrate_kbps;
+	struct sim_loss loss;
+	struct sim_radio_config radio;
+	bool timestamp;
+	double seconds;
+};
+
+struct sim_payload {
+	uint8_t data[SIM_PAYLOAD_MAX];
+	uint8_t len;
+	uint8_t n;                          /* samples */
+	uint64_t t_gen[SIM_BATCH_MAX];      /* when each sample was taken */
+	uint64_t t_queued;
+};
+
+struct glove {
+	uint8_t pipe;
+	float clock_scale;                  /* this glove's sample clock error */
+	struct sim_radio radio;
+	uint64_t next_sample;
+	uint32_t sample_index;
+
+	uint8_t batch_imu[SIM_BATCH_MAX][WIRE_IMU_BYTES];
+	struct sim_payload batch;
+
+	/* queue[q_head] is on the air while the radio is busy */
+	struct sim_payload queue[SIM_QUEUE_DEPTH];
+	int q_head, q_count;
+};
+
+/* Sample latencies, us */
+struct lat {
+	uint32_t *us;
+	size_t n, cap;
+};
+
+struct result {
+	uint64_t generated;
+	uint64_t delivered;
+	uint32_t duplicates;
+	uint32_t failed;
+	uint32_t dropped;
+	uint32_t collisions;
+	struct lat radio;
+};
+
+/* Capture replayed by every glove, dt,ax,ay,az,gx,gy,gz per line */
+static struct {
+	float (*imu)[6];
+	float *dt;
+	size_t n;
+} capture;
+
+static bool virtual_time;
+static uint64_t sim_clock;
+
+static struct {
+	int master;                         /* -1 in simulated time */
+	uint8_t buf[USB_BUF_SIZE];
+	size_t len;
+	uint64_t deadline;                  /* while len != 0 */
+	uint32_t dropped;
+} usb = { .master = -1 };
+
+static struct {
+	uint16_t seq;
+	uint64_t epoch;
+	uint32_t pipe_received[8];
+	uint64_t next_stats;
+} dongle;
+
+/* Ground truth for -bench, indexed by the dongle's seq */
+static uint64_t truth_gen[SEQ_SPACE];
+static uint64_t truth_rx[SEQ_SPACE];
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static uint64_t sim_now(void)
+{
+	return virtual_time ? sim_clock : now_us();
+}
+
+static void sleep_until(uint64_t t_us)
+{
+	struct timespec ts = {
+		.tv_sec = t_us / 1000000u,
+		.tv_nsec = (t_us % 1000000u) * 1000,
+	};
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+	}
+}
+
+static void lat_add(struct lat *l, uint32_t us)
+{
+	if (l->n == l->cap) {
+		l->cap = l->cap ? l->cap * 2 : 4096;
+		l->us = realloc(l->us, l->cap * sizeof(*l->us));
+		if (l->us == NULL) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	l->us[l->n++] = us;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void lat_sort(struct lat *l)
+{
+	qsort(l->us, l->n, sizeof(*l->us), cmp_u32);
+}
+
+static uint32_t percentile(const struct lat *sorted, double p)
+{
+	return sorted->n ? sorted->us[(size_t)(p * (sorted->n - 1) + 0.5)] : 0;
+}
+
+static int load_capture(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	size_t cap = 0;
+
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f)) {
+		float dt, v[6];
+
+		if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &dt, &v[0], &v[1], &v[2],
+			   &v[3], &v[4], &v[5]) != 7) {
+			continue;
+		}
+		if (capture.n == cap) {
+			cap = cap ? cap * 2 : 1024;
+			capture.imu = realloc(capture.imu, cap * sizeof(*capture.imu));
+			capture.dt = realloc(capture.dt, cap * sizeof(*capture.dt));
+			if (capture.imu == NULL || capture.dt == NULL) {
+				perror("realloc");
+				exit(1);
+			}
+		}
+		memcpy(capture.imu[capture.n], v, sizeof(v));
+		capture.dt[capture.n] = dt;
+		capture.n++;
+	}
+	fclose(f);
+	if (capture.n == 0) {
+		fprintf(stderr, "%s: no dt,ax,ay,az,gx,gy,gz lines\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+/* ---- Dongle: USB output ---- */
+
+static void usb_flush(void)
+{
+	size_t off = 0;
+
+	while (usb.master >= 0 && off < usb.len) {
+		ssize_t w = write(usb.master, &usb.buf[off], usb.len - off);
+
+		if (w < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;  /* pty full: keep the rest for the next flush */
+		}
+		off += (size_t)w;
+	}
+	if (usb.master < 0) {
+		off = usb.len;
+	}
+	memmove(usb.buf, &usb.buf[off], usb.len - off);
+	usb.len -= off;
+	if (usb.len != 0) {
+		usb.deadline = sim_now() + USB_MAX_LATENCY_US;
+	}
+}
+
+/* Same policy as dongle_rx usb_out_frame: whole frames or nothing */
+static void usb_out_frame(const uint8_t *msg, size_t len)
+{
+	if (USB_BUF_SIZE - usb.len < len) {
+		usb.dropped++;
+		return;
+	}
+	if (usb.len == 0) {
+		usb.deadline = sim_now() + USB_MAX_LATENCY_US;
+	}
+	memcpy(&usb.buf[usb.len], msg, len);
+	usb.len += len;
+	if (usb.len >= USB_BATCH_BYTES) {
+		usb_flush();
+	}
+}
+
+/* Host commands are not acted on, but are read so the game never blocks */
+static void usb_drain_input(void)
+{
+	uint8_t buf[256];
+
+	while (usb.master >= 0 && read(usb.master, buf, sizeof(buf)) > 0) {
+	}
+}
+
+/* ---- Dongle: payload handling ---- */
+
+struct rx_ctx {
+	const struct config *cfg;
+	const struct sim_payload *pl;
+	struct result *res;
+	uint64_t t_rx;
+	int index;
+};
+
+static void dongle_frame(const struct wire_frame *frame, void *arg)
+{
+	struct rx_ctx *ctx = arg;
+	uint8_t msg[WIRE_FRAME_MAX];
+	uint16_t seq = dongle.seq++;
+	uint64_t t_gen = ctx->pl->t_gen[ctx->index++];
+
+	lat_add(&ctx->res->radio, (uint32_t)(ctx->t_rx - t_gen));
+	truth_gen[seq] = t_gen;
+	truth_rx[seq] = ctx->t_rx;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	if (ctx->cfg->timestamp) {
+		usb_out_frame(msg, wire_timed_sample_frame(msg, frame, seq,
+							   (uint32_t)(sim_now() - dongle.epoch)));
+	} else {
+		usb_out_frame(msg, wire_sample_frame(msg, frame, seq));
+	}
+}
+
+static void dongle_rx(const struct config *cfg, struct result *res, const struct glove *g,
+		      const struct sim_payload *pl, uint64_t t_rx)
+{
+	struct rx_ctx ctx = { .cfg = cfg, .pl = pl, .res = res, .t_rx = t_rx };
+
+	dongle.pipe_received[g->pipe]++;
+	if (wire_unpack_payload(g->pipe, pl->data, pl->len,
+				(uint32_t)(t_rx - dongle.epoch), dongle_frame, &ctx) < 0) {
+		fprintf(stderr, "pipe %u: malformed payload\n", g->pipe);
+		return;
+	}
+	res->delivered += pl->n;
+}
+
+static void dongle_stats(void)
+{
+	Dongle_StatsPacked stats;
+	uint8_t msg[WIRE_FRAME_MAX];
+
+	memset(&stats, 0, sizeof(stats));
+	stats.uptime_ms = (uint32_t)((sim_now() - dongle.epoch) / 1000);
+	for (int i = 0; i < 8; i++) {
+		stats.pipe[i].received = dongle.pipe_received[i];
+	}
+	usb_out_frame(msg, wire_ext_frame(msg, HOST_FRAME_STATS,
+					  (const uint8_t *)&stats, sizeof(stats)));
+}
+
+/* ---- Gloves ---- */
+
+static struct sim_payload *q_at(struct glove *g, int i)
+{
+	return &g->queue[(g->q_head + i) % SIM_QUEUE_DEPTH];
+}
+
+static void q_drop_head(struct glove *g)
+{
+	g->q_head = (g->q_head + 1) % SIM_QUEUE_DEPTH;
+	g->q_count--;
+}
+
+/* Start the next payload if the radio is free, dropping ones that aged out */
+static void glove_kick(struct glove *g, struct result *res, uint64_t now)
+{
+	if (sim_radio_busy(&g->radio)) {
+		return;
+	}
+	while (g->q_count > 0 && now - q_at(g, 0)->t_queued > SIM_MAX_AGE_US) {
+		q_drop_head(g);
+		res->dropped++;
+	}
+	if (g->q_count > 0) {
+		sim_radio_start(&g->radio, now, q_at(g, 0)->len);
+	}
+}
+
+static void glove_enqueue(struct glove *g, struct result *res, const struct sim_payload *pl,
+			  uint64_t now)
+{
+	// Full: the oldest payload not already on the air makes room
+	if (g->q_count == SIM_QUEUE_DEPTH) {
+		int first = sim_radio_busy(&g->radio) ? 1 : 0;
+
+		for (int i = first; i + 1 < g->q_count; i++) {
+			*q_at(g, i) = *q_at(g, i + 1);
+		}
+		g->q_count--;
+		res->dropped++;
+	}
+	*q_at(g, g->q_count) = *pl;
+	q_at(g, g->q_count)->t_queued = now;
+	g->q_count++;
+	glove_kick(g, res, now);
+}
+
+/* Take one sample at now; returns the time until the next one */
+static uint32_t glove_sample(struct glove *g, const struct config *cfg, struct result *res,
+			     uint64_t now)
+{
+	float v[6];
+	uint32_t k = g->sample_index++;
+	float period_s = 1.0f / cfg->odr_hz;
+
+	if (capture.n != 0) {
+		size_t i = (k + g->pipe * 97u) % capture.n;
+
+		memcpy(v, capture.imu[i], sizeof(v));
+		if (capture.dt[i] > 0) {
+			period_s = capture.dt[i];
+		}
+	} else {
+		for (int i = 0; i < 6; i++) {
+			v[i] = sinf(6.2832f * k / cfg->odr_hz + g->pipe + i) * (i < 3 ? 9.81f : 3.0f);
+		}
+	}
+
+	struct sim_payload *b = &g->batch;
+
+	memcpy(g->batch_imu[b->n], v, WIRE_IMU_BYTES);
+	b->t_gen[b->n++] = now;
+	res->generated++;
+	if (b->n >= cfg->batch) {
+		bool button = (k / 200 + g->pipe) % 5 == 0;
+
+		if (b->n == 1) {
+			b->len = (uint8_t)wire_sample_payload(b->data, PAYLOAD_KIND_RAW, button,
+							      g->batch_imu[0], NULL);
+		} else {
+			const void *imu[SIM_BATCH_MAX];
+
+			for (int i = 0; i < b->n; i++) {
+				imu[i] = g->batch_imu[i];
+			}
+			b->len = (uint8_t)wire_batch_payload(b->data, button, imu, b->n);
+		}
+		glove_enqueue(g, res, b, now);
+		b->n = 0;
+	}
+
+	return (uint32_t)(period_s * g->clock_scale * 1e6f);
+}
+
+static void glove_radio_event(struct glove *g, const struct config *cfg, struct result *res)
+{
+	uint64_t t = sim_radio_next_event(&g->radio);
+
+	switch (sim_radio_step(&g->radio)) {
+	case SIM_RADIO_RX:
+		dongle_rx(cfg, res, g, q_at(g, 0), t);
+		break;
+	case SIM_RADIO_DUPLICATE:
+		res->duplicates++;
+		break;
+	case SIM_RADIO_DONE:
+		if (!g->radio.tx.acked) {
+			res->failed++;
+		}
+		q_drop_head(g);
+		glove_kick(g, res, t);
+		break;
+	default:
+		break;
+	}
+}
+
+/* ---- Pi side for -bench ---- */
+
+struct bench {
+	const char *path;
+	struct lat radio;
+	struct lat e2e;
+};
+
+static void *bench_reader(void *arg)
+{
+	struct bench *b = arg;
+	struct dp_packet pkt;
+	int fd = dp_open(b->path, 115200);
+
+	if (fd < 0) {
+		perror(b->path);
+		return NULL;
+	}
+	while (dp_read_packet(fd, &pkt) == 1) {
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		lat_add(&b->radio, (uint32_t)(truth_rx[pkt.seq] - truth_gen[pkt.seq]));
+		lat_add(&b->e2e, (uint32_t)(pkt.host_us - truth_gen[pkt.seq]));
+	}
+	dp_close(fd);
+	return NULL;
+}
+
+/* ---- Main loop ---- */
+
+static int open_pty(char *slave_path, size_t len)
+{
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	struct termios tty;
+
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0 ||
+	    ptsname_r(master, slave_path, len) != 0) {
+		perror("pty");
+		return -1;
+	}
+
+	// Raw before anyone opens it, or the line discipline echoes frames back
+	int slave = open(slave_path, O_RDWR | O_NOCTTY);
+
+	if (slave < 0 || tcgetattr(slave, &tty) != 0) {
+		perror(slave_path);
+		return -1;
+	}
+	cfmakeraw(&tty);
+	tcsetattr(slave, TCSANOW, &tty);
+	// Held open so the pty stays up between readers; never read
+
+	fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+	return master;
+}
+
+/*
+ * Run every glove, radio and dongle event in time order. In simulated time
+ * the clock jumps from event to event; in real time each batch of due
+ * events is handled, then the loop sleeps until the next one.
+ */
+static void run(const struct config *cfg, struct result *res, uint64_t start)
+{
+	struct sim_channel channel;
+	struct glove gloves[SIM_GLOVES_MAX];
+	uint64_t end = cfg->seconds > 0 ? start + (uint64_t)(cfg->seconds * 1e6) : UINT64_MAX;
+
+	memset(res, 0, sizeof(*res));
+	memset(&dongle, 0, sizeof(dongle));
+	usb.len = 0;
+	usb.dropped = 0;
+
+	sim_channel_init(&channel, cfg->bitrate_kbps, &cfg->loss);
+	memset(gloves, 0, sizeof(gloves));
+	for (int i = 0; i < cfg->gloves; i++) {
+		struct glove *g = &gloves[i];
+
+		g->pipe = (uint8_t)(i + 1);
+		g->clock_scale = 1.0f + 0.0015f * (float)((i * 5) % 7 - 3) / 3.0f;
+		g->next_sample = start + (uint64_t)i * (1000000u / cfg->odr_hz) / cfg->gloves;
+		sim_radio_init(&g->radio, &channel, i, &cfg->radio, 0x9E3779B9u * (i + 1));
+	}
+	dongle.epoch = start;
+	dongle.next_stats = start + STATS_PERIOD_US;
+	sim_clock = start;
+
+	for (;;) {
+		uint64_t now = virtual_time ? end : now_us();
+		uint64_t next;
+
+		for (;;) {
+			struct glove *due = NULL;
+			bool radio = false;
+
+			next = dongle.next_stats;
+			if (usb.len != 0 && usb.deadline < next) {
+				next = usb.deadline;
+			}
+			for (int i = 0; i < cfg->gloves; i++) {
+				uint64_t t = sim_radio_next_event(&gloves[i].radio);
+
+				if (t < next) {
+					next = t;
+					due = &gloves[i];
+					radio = true;
+				}
+				if (gloves[i].next_sample < next) {
+					next = gloves[i].next_sample;
+					due = &gloves[i];
+					radio = false;
+				}
+			}
+			if (next > now || next >= end) {
+				break;
+			}
+
+			sim_clock = next;
+			if (due != NULL && radio) {
+				glove_radio_event(due, cfg, res);
+			} else if (due != NULL) {
+				due->next_sample += glove_sample(due, cfg, res, next);
+			} else if (next == dongle.next_stats) {
+				dongle.next_stats += STATS_PERIOD_US;
+				dongle_stats();
+			} else {
+				usb_flush();
+			}
+		}
+
+		if (virtual_time || now >= end) {
+			break;
+		}
+		usb_drain_input();
+		sleep_until(next < end ? next : end);
+	}
+
+	usb_flush();
+	res->collisions = channel.collisions;
+}
+
+static void print_sim_header(void)
+{
+	printf("name,gloves,odr_hz,batch,bitrate_kbps,delay_us,count,ack,"
+	       "p_gb,p_bg,loss_good,loss_bad,generated,delivered,delivered_pct,"
+	       "p50_us,p90_us,p99_us,max_us,duplicates,collisions,failed,dropped\n");
+}
+
+static void print_sim_result(const struct config *cfg, struct result *res)
+{
+	lat_sort(&res->radio);
+	printf("%s,%d,%u,%d,%u,%u,%u,%d,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%.2f,"
+	       "%u,%u,%u,%u,%u,%u,%u,%u\n",
+	       cfg->name, cfg->gloves, cfg->odr_hz, cfg->batch, cfg->bitrate_kbps,
+	       cfg->radio.retransmit_delay_us, cfg->radio.retransmit_count, !cfg->radio.noack,
+	       cfg->loss.p_good_bad, cfg->loss.p_bad_good, cfg->loss.loss_good, cfg->loss.loss_bad,
+	       (unsigned long long)res->generated, (unsigned long long)res->delivered,
+	       res->generated ? 100.0 * res->delivered / res->generated : 0.0,
+	       percentile(&res->radio, 0.50), percentile(&res->radio, 0.90),
+	       percentile(&res->radio, 0.99),
+	       res->radio.n ? res->radio.us[res->radio.n - 1] : 0,
+	       res->duplicates, res->collisions, res->failed, res->dropped);
+}
+
+/* Configurations for -sweep; ODR, capture and duration come from the command line */
+static const struct {
+	const char *name;
+	int gloves;
+	int batch;
+	uint16_t bitrate_kbps;
+	uint16_t delay_us;
+	uint8_t count;
+	bool noack;
+	struct sim_loss loss;
+} sweep[] = {
+	{ "clean",          2, 1, 2000,  600, 3, false, { 0, 1, 0.01f, 0.01f } },
+	{ "lossy10",        2, 1, 2000,  600, 3, false, { 0, 1, 0.10f, 0.10f } },
+	{ "lossy30",        2, 1, 2000,  600, 3, false, { 0, 1, 0.30f, 0.30f } },
+	{ "lossy30_retry8", 2, 1, 2000,  600, 8, false, { 0, 1, 0.30f, 0.30f } },
+	{ "bursty",         2, 1, 2000,  600, 3, false, { 0.02f, 0.20f, 0.01f, 0.90f } },
+	{ "bursty_slow",    2, 1, 2000, 1500, 3, false, { 0.02f, 0.20f, 0.01f, 0.90f } },
+	{ "noack10",        2, 1, 2000,  600, 0, true,  { 0, 1, 0.10f, 0.10f } },
+	{ "crowded4",       4, 1, 2000,  600, 3, false, { 0, 1, 0.01f, 0.01f } },
+	{ "crowded7",       7, 1, 2000,  600, 3, false, { 0, 1, 0.01f, 0.01f } },
+	{ "crowded7_1m",    7, 1, 1000,  600, 3, false, { 0, 1, 0.01f, 0.01f } },
+	{ "crowded7_b4",    7, 4, 2000,  600, 3, false, { 0, 1, 0.01f, 0.01f } },
+	{ "crowded7_noack", 7, 1, 2000,  600, 0, true,  { 0, 1, 0.01f, 0.01f } },
+};
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-gloves n] [-odr hz] [-batch n] [-bitrate 1000|2000]\n"
+		"          [-loss p | -ge p_gb p_bg loss_good loss_bad]\n"
+		"          [-retransmit delay_us count] [-noack] [-timestamp]\n"
+		"          [-capture file.csv] [-seconds s] [-bench | -virtual | -sweep]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	struct config cfg = {
+		.name = "cli",
+		.gloves = 2,
+		.odr_hz = 104,
+		.batch = 1,
+		.bitrate_kbps = 2000,
+		.loss = sim_loss_bernoulli(0.02f),
+		.radio = {
+			.retransmit_delay_us = 600,     /* imu_tx TX_RETRANSMIT_DELAY_US */
+			.retransmit_count = 3,
+		},
+	};
+	enum mode mode = MODE_REALTIME;
+	const char *capture_path = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-gloves") && i + 1 < argc) {
+			cfg.gloves = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-odr") && i + 1 < argc) {
+			cfg.odr_hz = (uint32_t)atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-batch") && i + 1 < argc) {
+			cfg.batch = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-bitrate") && i + 1 < argc) {
+			cfg.bitrate_kbps = (uint16_t)atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-loss") && i + 1 < argc) {
+			cfg.loss = sim_loss_bernoulli(strtof(argv[++i], NULL));
+		} else if (!strcmp(argv[i], "-ge") && i + 4 < argc) {
+			cfg.loss.p_good_bad = strtof(argv[++i], NULL);
+			cfg.loss.p_bad_good = strtof(argv[++i], NULL);
+			cfg.loss.loss_good = strtof(argv[++i], NULL);
+			cfg.loss.loss_bad = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-retransmit") && i + 2 < argc) {
+			cfg.radio.retransmit_delay_us = (uint16_t)atoi(argv[++i]);
+			cfg.radio.retransmit_count = (uint8_t)atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-noack")) {
+			cfg.radio.noack = true;
+		} else if (!strcmp(argv[i], "-timestamp")) {
+			cfg.timestamp = true;
+		} else if (!strcmp(argv[i], "-capture") && i + 1 < argc) {
+			capture_path = argv[++i];
+		} else if (!strcmp(argv[i], "-seconds") && i + 1 < argc) {
+			cfg.seconds = atof(argv[++i]);
+		} else if (!strcmp(argv[i], "-bench")) {
+			mode = MODE_BENCH;
+		} else if (!strcmp(argv[i], "-virtual")) {
+			mode = MODE_VIRTUAL;
+		} else if (!strcmp(argv[i], "-sweep")) {
+			mode = MODE_SWEEP;
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if (cfg.gloves < 1 || cfg.gloves > SIM_GLOVES_MAX || cfg.odr_hz == 0 ||
+	    cfg.batch < 1 || cfg.batch > SIM_BATCH_MAX ||
+	    (cfg.bitrate_kbps != 1000 && cfg.bitrate_kbps != 2000)) {
+		usage(argv[0]);
+		return 2;
+	}
+	if (cfg.seconds <= 0 && mode != MODE_REALTIME) {
+		cfg.seconds = mode == MODE_BENCH ? 10 : 60;
+	}
+	if (capture_path != NULL && load_capture(capture_path) != 0) {
+		return 1;
+	}
+
+	struct result res;
+
+	if (mode == MODE_VIRTUAL || mode == MODE_SWEEP) {
+		virtual_time = true;
+		print_sim_header();
+		if (mode == MODE_VIRTUAL) {
+			run(&cfg, &res, 0);
+			print_sim_result(&cfg, &res);
+			free(res.radio.us);
+			return 0;
+		}
+		for (size_t i = 0; i < sizeof(sweep) / sizeof(sweep[0]); i++) {
+			struct config c = cfg;
+
+			c.name = sweep[i].name;
+			c.gloves = sweep[i].gloves;
+			c.batch = sweep[i].batch;
+			c.bitrate_kbps = sweep[i].bitrate_kbps;
+			c.radio.retransmit_delay_us = sweep[i].delay_us;
+			c.radio.retransmit_count = sweep[i].count;
+			c.radio.noack = sweep[i].noack;
+			c.loss = sweep[i].loss;
+			run(&c, &res, 0);
+			print_sim_result(&c, &res);
+			free(res.radio.us);
+		}
+		return 0;
+	}
+
+	char slave_path[64];
+
+	usb.master = open_pty(slave_path, sizeof(slave_path));
+	if (usb.master < 0) {
+		return 1;
+	}
+	fprintf(stderr, "dongle on %s\n", slave_path);
+
+	struct bench bench = { .path = slave_path };
+	pthread_t reader;
+
+	if (mode == MODE_BENCH && pthread_create(&reader, NULL, bench_reader, &bench) != 0) {
+		perror("pthread_create");
+		return 1;
+	}
+
+	// The reader settles in first
+	run(&cfg, &res, now_us() + 100000);
+	if (mode != MODE_BENCH) {
+		return 0;
+	}
+
+	// Give the reader the last frames, then hang up so it returns
+	usleep(200000);
+	close(usb.master);
+	pthread_join(reader, NULL);
+
+	lat_sort(&bench.radio);
+	lat_sort(&bench.e2e);
+	printf("gloves,odr_hz,batch,loss,generated,radio_delivered,host_received,"
+	       "radio_p50_us,radio_p99_us,e2e_p50_us,e2e_p90_us,e2e_p99_us,e2e_max_us\n");
+	printf("%d,%u,%d,%.3f,%llu,%llu,%zu,%u,%u,%u,%u,%u,%u\n",
+	       cfg.gloves, cfg.odr_hz, cfg.batch, cfg.loss.loss_good,
+	       (unsigned long long)res.generated, (unsigned long long)res.delivered, bench.e2e.n,
+	       percentile(&bench.radio, 0.50), percentile(&bench.radio, 0.99),
+	       percentile(&bench.e2e, 0.50), percentile(&bench.e2e, 0.90),
+	       percentile(&bench.e2e, 0.99),
+	       bench.e2e.n ? bench.e2e.us[bench.e2e.n - 1] : 0);
+	if (usb.dropped != 0) {
+		fprintf(stderr, "USB: %u frames dropped\n", usb.dropped);
+	}
+
+	free(bench.radio.us);
+	free(bench.e2e.us);
+	free(res.radio.us);
+	return 0;
+}
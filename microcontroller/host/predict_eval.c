@@ -0,0 +1,305 @@
+/*
+ * Game cursor latency compensation (pi/c-game/src/cursor_predict.c) scored
+ * on a recorded capture.
+ *
+ * The capture is run through the cursor the way cursor_bench runs it,
+ * without the screen edges, which gives where the cursor would be with no
+ * latency at all. The game is then replayed at -fps: each sample reaches
+ * the game -latency ms after it was taken (radio, dongle, USB, parse), a
+ * frame is built from what has arrived and is shown -queue frames later.
+ * The error is the distance between the drawn cursor and the zero-latency
+ * cursor at the time the frame is shown, in pixels. "none" draws the
+ * newest sample, as the game does without prediction.
+ *
+ * Input (stdin) is the ahrs_replay capture format, one sample per line,
+ * gyro in rad/s and accel in m/s^2:
+ *   dt,ax,ay,az,gx,gy,gz
+ * gravity_bench -synth 60 -dump file.csv writes one if there is no glove
+ * to hand.
+ *
+ * Output, one line per predictor:
+ *   predictor,lambda,alpha,beta,frames,rms_px,p95_px,max_px,moving_rms_px
+ * moving_rms_px only counts frames where the cursor is faster than
+ * MOVING_PX_S. Without -lambda a range of tracking indices is swept.
+ *
+ * Usage: predict_eval [-mode accel|air] [-latency ms] [-fps n] [-queue frames]
+ *                     [-lambda x] < capture.csv
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bias_tracker.h"
+#include "cursor_motion.h"
+#include "cursor_predict.h"
+#include "imu_gravity.h"
+
+#define MOVING_PX_S     100.0f
+
+struct sample {
+	float dt;
+	float accel[3];
+	float gyro[3];
+};
+
+struct cursor {
+	int mode;
+	struct imu_gravity gravity;
+	struct air_motion air;
+	struct bias_tracker tracker;
+	float vel[2];
+	float pos[2];
+};
+
+static struct sample *samples;
+static size_t sample_count, sample_cap;
+
+/* Zero-latency cursor: sample time, position and speed */
+static double *track_t;
+static float (*track_pos)[2];
+static float *track_speed;
+
+static float *errors;
+static size_t error_cap;
+
+static void *grow(void *p, size_t n, size_t size)
+{
+	p = realloc(p, n * size);
+	if (!p) {
+		perror("realloc");
+		exit(1);
+	}
+	return p;
+}
+
+static void load_capture(FILE *f)
+{
+	char line[256];
+	struct sample s;
+
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &s.dt, &s.accel[0],
+			   &s.accel[1], &s.accel[2], &s.gyro[0], &s.gyro[1],
+			   &s.gyro[2]) != 7) {
+			continue; /* header or blank line */
+		}
+		if (sample_count == sample_cap) {
+			sample_cap = sample_cap ? sample_cap * 2 : 4096;
+			samples = grow(samples, sample_cap, sizeof(*samples));
+		}
+		samples[sample_count++] = s;
+	}
+}
+
+/* As cursor_bench: UpdateCursorSample() minus the sample clock, the cache
+   and the screen */
+static void cursor_init(struct cursor *c, int mode)
+{
+	memset(c, 0, sizeof(*c));
+	c->mode = mode;
+	imu_gravity_init(&c->gravity, IMU_GRAVITY_MAHONY);
+	air_motion_init(&c->air);
+	bias_tracker_init(&c->tracker);
+}
+
+static void cursor_update(struct cursor *c, const struct sample *s)
+{
+	float lin[3], a[2];
+
+	imu_gravity_update(&c->gravity, s->accel, s->gyro, s->dt, lin);
+	cursor_accel_axes(lin, a);
+	bias_tracker_update(&c->tracker, s->accel, s->gyro, a, s->dt);
+
+	if (c->mode == CURSOR_MODE_AIR) {
+		air_motion_update(&c->air, s->gyro, s->dt, c->vel);
+	} else {
+		a[0] -= c->tracker.accel_bias[0];
+		a[1] = -(a[1] - c->tracker.accel_bias[1]);
+		accel_motion_step(c->vel, a, s->dt);
+	}
+	c->pos[0] += c->vel[0] * s->dt;
+	c->pos[1] += c->vel[1] * s->dt;
+}
+
+static void build_track(int mode)
+{
+	struct cursor c;
+	double t = 0;
+
+	track_t = grow(NULL, sample_count, sizeof(*track_t));
+	track_pos = grow(NULL, sample_count, sizeof(*track_pos));
+	track_speed = grow(NULL, sample_count, sizeof(*track_speed));
+
+	cursor_init(&c, mode);
+	for (size_t k = 0; k < sample_count; k++) {
+		t += samples[k].dt;
+		cursor_update(&c, &samples[k]);
+		track_t[k] = t;
+		track_pos[k][0] = c.pos[0];
+		track_pos[k][1] = c.pos[1];
+		track_speed[k] = sqrtf(c.vel[0] * c.vel[0] + c.vel[1] * c.vel[1]);
+	}
+}
+
+/* Zero-latency position at time t; *k is a search hint, t never decreases */
+static void track_at(double t, size_t *k, float out[2])
+{
+	while (*k + 1 < sample_count && track_t[*k + 1] <= t) {
+		(*k)++;
+	}
+	if (*k + 1 >= sample_count) {
+		out[0] = track_pos[*k][0];
+		out[1] = track_pos[*k][1];
+		return;
+	}
+	float u = (float)((t - track_t[*k]) / (track_t[*k + 1] - track_t[*k]));
+
+	for (int i = 0; i < 2; i++) {
+		out[i] = track_pos[*k][i] + u * (track_pos[*k + 1][i] - track_pos[*k][i]);
+	}
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+	float x = *(const float *)a, y = *(const float *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* lambda <= 0 is no prediction */
+static void run(float lambda, float latency_s, float fps, float queue)
+{
+	struct cursor_predict p;
+	double frame_s = 1.0 / fps;
+	double shown_lead = queue * frame_s;
+	double sum2 = 0, moving2 = 0;
+	size_t frames = 0, moving = 0, next = 0, truth_k = 0;
+	float max_err = 0;
+
+	cursor_predict_init(&p, lambda > 0 ? lambda : CURSOR_PREDICT_LAMBDA);
+
+	for (long f = 1;; f++) {
+		double shown = f * frame_s;
+		double built = shown - shown_lead;
+		float drawn[2], truth[2];
+
+		if (shown > track_t[sample_count - 1]) {
+			break;
+		}
+		/* Everything that has reached the game when the frame is built */
+		while (next < sample_count && track_t[next] + latency_s <= built) {
+			cursor_predict_update(&p, track_pos[next], samples[next].dt);
+			next++;
+		}
+		if (next == 0) {
+			continue;
+		}
+
+		size_t last = next - 1;
+
+		if (lambda > 0) {
+			cursor_predict_at(&p, (float)(shown - track_t[last]), drawn);
+		} else {
+			drawn[0] = track_pos[last][0];
+			drawn[1] = track_pos[last][1];
+		}
+		track_at(shown, &truth_k, truth);
+
+		float dx = drawn[0] - truth[0], dy = drawn[1] - truth[1];
+		float err = sqrtf(dx * dx + dy * dy);
+
+		if (frames == error_cap) {
+			error_cap = error_cap ? error_cap * 2 : 4096;
+			errors = grow(errors, error_cap, sizeof(*errors));
+		}
+		errors[frames++] = err;
+		sum2 += (double)err * err;
+		if (err > max_err) {
+			max_err = err;
+		}
+		if (track_speed[truth_k] > MOVING_PX_S) {
+			moving2 += (double)err * err;
+			moving++;
+		}
+	}
+	if (frames == 0) {
+		fprintf(stderr, "capture shorter than the latency\n");
+		exit(1);
+	}
+
+	qsort(errors, frames, sizeof(*errors), cmp_float);
+	printf("%s,%.3f,%.3f,%.3f,%zu,%.2f,%.2f,%.2f,%.2f\n",
+	       lambda > 0 ? "alpha_beta" : "none", lambda > 0 ? lambda : 0.0f,
+	       lambda > 0 ? p.alpha : 0.0f, lambda > 0 ? p.beta : 0.0f, frames,
+	       sqrt(sum2 / frames), errors[(size_t)(0.95 * (frames - 1) + 0.5)],
+	       max_err, moving ? sqrt(moving2 / moving) : -1.0);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-mode accel|air] [-latency ms] [-fps n] [-queue frames]\n"
+		"          [-lambda x] < capture.csv\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	static const float sweep[] = { 0.05f, 0.1f, 0.2f, 0.5f, 1.0f, 2.0f, 5.0f, 10.0f };
+	int mode = CURSOR_MODE_ACCEL;
+	float latency_ms = 8.0f, fps = 60.0f, queue = 1.0f, lambda = 0.0f;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-mode") && i + 1 < argc) {
+			i++;
+			if (!strcmp(argv[i], "air")) {
+				mode = CURSOR_MODE_AIR;
+			} else if (strcmp(argv[i], "accel")) {
+				usage(argv[0]);
+				return 2;
+			}
+		} else if (!strcmp(argv[i], "-latency") && i + 1 < argc) {
+			latency_ms = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-fps") && i + 1 < argc) {
+			fps = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-queue") && i + 1 < argc) {
+			queue = strtof(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "-lambda") && i + 1 < argc) {
+			lambda = strtof(argv[++i], NULL);
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if (latency_ms < 0 || fps <= 0 || queue < 0 || lambda < 0) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	load_capture(stdin);
+	if (sample_count < 2) {
+		fprintf(stderr, "no samples\n");
+		return 1;
+	}
+	build_track(mode);
+
+	printf("predictor,lambda,alpha,beta,frames,rms_px,p95_px,max_px,moving_rms_px\n");
+	run(0.0f, latency_ms * 1e-3f, fps, queue);
+	if (lambda > 0) {
+		run(lambda, latency_ms * 1e-3f, fps, queue);
+	} else {
+		for (size_t i = 0; i < sizeof(sweep) / sizeof(sweep[0]); i++) {
+			run(sweep[i], latency_ms * 1e-3f, fps, queue);
+		}
+	}
+
+	free(samples);
+	free(track_t);
+	free(track_pos);
+	free(track_speed);
+	free(errors);
+	return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Simulated ESB channel shared by several gloves (PTX) and the dongle (PRX).
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include "sim_radio.h"
+
+#include <string.h>
+
+/* Preamble, 5-byte address, 2-byte CRC and the 9-bit DPL control field */
+#define ESB_BITS_OVERHEAD (8 * (1 + 5 + 2) + 9)
+
+enum {
+	PHASE_IDLE,
+	PHASE_PACKET,   /* event at the end of the packet */
+	PHASE_ACK,      /* event at the end of the ACK */
+	PHASE_FINISH,   /* event when the PTX gives the payload up */
+};
+
+double sim_radio_uniform(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return (x >> 8) * (1.0 / 16777216.0);
+}
+
+struct sim_loss sim_loss_bernoulli(float p)
+{
+	struct sim_loss l = { 0.0f, 1.0f, p, p };
+
+	return l;
+}
+
+void sim_channel_init(struct sim_channel *ch, uint16_t bitrate_kbps,
+		      const struct sim_loss *loss)
+{
+	memset(ch, 0, sizeof(*ch));
+	ch->bitrate_kbps = bitrate_kbps;
+	ch->loss = *loss;
+	for (int i = 0; i < SIM_CHANNEL_LOG; i++) {
+		ch->air[i].owner = -1;
+	}
+}
+
+void sim_radio_init(struct sim_radio *r, struct sim_channel *ch, int id,
+		    const struct sim_radio_config *cfg, uint32_t seed)
+{
+	memset(r, 0, sizeof(*r));
+	r->cfg = *cfg;
+	r->ch = ch;
+	r->id = id;
+	r->rng = seed != 0 ? seed : 1;
+}
+
+uint32_t sim_radio_airtime_us(uint16_t bitrate_kbps, uint32_t payload_len)
+{
+	/* 2 Mbps sends a 2-byte preamble */
+	uint32_t bits = ESB_BITS_OVERHEAD + 8 * payload_len + (bitrate_kbps >= 2000 ? 8 : 0);
+
+	return (bits * 1000u + bitrate_kbps - 1) / bitrate_kbps;
+}
+
+uint32_t sim_radio_slot_us(const struct sim_radio *r, uint32_t payload_len)
+{
+	uint16_t kbps = r->ch->bitrate_kbps;
+	uint32_t slot = sim_radio_airtime_us(kbps, payload_len) +
+			SIM_RADIO_TURNAROUND_US + sim_radio_airtime_us(kbps, r->cfg.ack_len);
+
+	return r->cfg.retransmit_delay_us > slot ? r->cfg.retransmit_delay_us : slot;
+}
+
+bool sim_radio_busy(const struct sim_radio *r)
+{
+	return r->phase != PHASE_IDLE;
+}
+
+uint64_t sim_radio_next_event(const struct sim_radio *r)
+{
+	return r->phase == PHASE_IDLE ? UINT64_MAX : r->event_us;
+}
+
+static void channel_log(struct sim_channel *ch, int owner, uint64_t start, uint64_t end)
+{
+	ch->air[ch->air_next].start = start;
+	ch->air[ch->air_next].end = end;
+	ch->air[ch->air_next].owner = owner;
+	ch->air_next = (ch->air_next + 1) % SIM_CHANNEL_LOG;
+}
+
+static bool channel_collided(const struct sim_channel *ch, int owner,
+			     uint64_t start, uint64_t end)
+{
+	for (int i = 0; i < SIM_CHANNEL_LOG; i++) {
+		if (ch->air[i].owner >= 0 && ch->air[i].owner != owner &&
+		    ch->air[i].start < end && start < ch->air[i].end) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Step the link's Gilbert-Elliott state and draw one transmission's fate */
+static bool link_lost(struct sim_radio *r)
+{
+	const struct sim_loss *l = &r->ch->loss;
+
+	if (sim_radio_uniform(&r->rng) < (r->bad ? l->p_bad_good : l->p_good_bad)) {
+		r->bad = !r->bad;
+	}
+	return sim_radio_uniform(&r->rng) < (r->bad ? l->loss_bad : l->loss_good);
+}
+
+static void begin_attempt(struct sim_radio *r, uint64_t t)
+{
+	uint64_t end = t + sim_radio_airtime_us(r->ch->bitrate_kbps, r->len);
+
+	r->attempt_start = t;
+	r->tx.attempts++;
+	channel_log(r->ch, r->id, t, end);
+	r->phase = PHASE_PACKET;
+	r->event_us = end;
+}
+
+/* Packet or ACK lost: retransmit when the ACK wait runs out, or give up */
+static void attempt_failed(struct sim_radio *r)
+{
+	uint64_t next = r->attempt_start + sim_radio_slot_us(r, r->len);
+
+	if (!r->cfg.noack && r->tx.attempts <= r->cfg.retransmit_count) {
+		begin_attempt(r, next);
+		return;
+	}
+	r->phase = PHASE_FINISH;
+	r->event_us = r->cfg.noack ? r->event_us : next;
+	r->tx.done_us = r->event_us;
+}
+
+void sim_radio_start(struct sim_radio *r, uint64_t now_us, uint32_t payload_len)
+{
+	memset(&r->tx, 0, sizeof(r->tx));
+	r->tx.start_us = now_us;
+	r->len = payload_len;
+	begin_attempt(r, now_us);
+}
+
+enum sim_radio_event sim_radio_step(struct sim_radio *r)
+{
+	struct sim_channel *ch = r->ch;
+	uint64_t t = r->event_us;
+
+	switch (r->phase) {
+	case PHASE_PACKET: {
+		bool collided = channel_collided(ch, r->id, r->attempt_start, t);
+		bool lost = link_lost(r) || collided;
+
+		if (collided) {
+			ch->collisions++;
+		}
+		if (lost) {
+			attempt_failed(r);
+			return SIM_RADIO_NONE;
+		}
+
+		enum sim_radio_event ev = r->tx.received ? SIM_RADIO_DUPLICATE : SIM_RADIO_RX;
+
+		if (!r->tx.received) {
+			r->tx.received = true;
+			r->tx.rx_us = t;
+		}
+		r->tx.copies++;
+
+		if (r->cfg.noack) {
+			r->phase = PHASE_FINISH;
+			r->tx.done_us = t;
+		} else {
+			uint64_t ack_start = t + SIM_RADIO_TURNAROUND_US;
+
+			r->phase = PHASE_ACK;
+			r->event_us = ack_start + sim_radio_airtime_us(ch->bitrate_kbps, r->cfg.ack_len);
+			channel_log(ch, r->id, ack_start, r->event_us);
+		}
+		return ev;
+	}
+	case PHASE_ACK: {
+		uint64_t ack_start = t - sim_radio_airtime_us(ch->bitrate_kbps, r->cfg.ack_len);
+		bool collided = channel_collided(ch, r->id, ack_start, t);
+		bool lost = link_lost(r) || collided;
+
+		if (collided) {
+			ch->collisions++;
+		}
+		if (lost) {
+			attempt_failed(r);
+			return SIM_RADIO_NONE;
+		}
+		r->tx.acked = true;
+		r->tx.done_us = t;
+		r->phase = PHASE_FINISH;
+		return SIM_RADIO_NONE;
+	}
+	case PHASE_FINISH:
+		r->phase = PHASE_IDLE;
+		return SIM_RADIO_DONE;
+	default:
+		return SIM_RADIO_NONE;
+	}
+}
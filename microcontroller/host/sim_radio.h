@@ -0,0 +1,114 @@
+/*
+ * Simulated ESB channel shared by several gloves (PTX) and the dongle (PRX).
+ *
+ * Each attempt is the packet on the air, the PRX turnaround and the ACK.
+ * Either can be lost to the link's loss model, or to a collision with any
+ * other transmission overlapping it on the channel, the dongle's ACKs to
+ * other gloves included. A lost ACK means the dongle got the packet but
+ * the glove sends it again; ESB's PID check drops the copy, which is
+ * reported as a duplicate.
+ *
+ * Loss is Gilbert-Elliott per glove link, stepped once per packet or ACK
+ * on the air; Bernoulli loss is the one-state case (sim_loss_bernoulli).
+ *
+ * The simulation is event driven: the caller must step every radio on a
+ * channel in global time order (smallest sim_radio_next_event first) so
+ * that every overlapping transmission is known when an attempt ends.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _SIM_RADIO_H_
+#define _SIM_RADIO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SIM_RADIO_TURNAROUND_US 150
+#define SIM_CHANNEL_LOG         64      /* recent transmissions kept for collisions */
+
+struct sim_loss {
+	float p_good_bad;       /* per transmission, good -> bad */
+	float p_bad_good;
+	float loss_good;
+	float loss_bad;
+};
+
+struct sim_channel {
+	uint16_t bitrate_kbps;  /* 1000 or 2000 */
+	struct sim_loss loss;
+	struct {
+		uint64_t start, end;
+		int owner;      /* glove whose packet or ACK this is */
+	} air[SIM_CHANNEL_LOG];
+	int air_next;
+	uint32_t collisions;    /* packets and ACKs lost to an overlap */
+};
+
+struct sim_radio_config {
+	uint16_t retransmit_delay_us;   /* start to start, as esb_set_retransmit_delay */
+	uint8_t retransmit_count;
+	bool noack;                     /* one attempt, no ACK expected */
+	uint8_t ack_len;                /* ACK payload bytes, 0 for a bare ACK */
+};
+
+enum sim_radio_event {
+	SIM_RADIO_NONE,
+	SIM_RADIO_RX,           /* the dongle got the payload */
+	SIM_RADIO_DUPLICATE,    /* got it again after a lost ACK, dropped by ESB */
+	SIM_RADIO_DONE,         /* acked or given up, see tx.acked; radio is free */
+};
+
+/* One payload's trip, absolute times */
+struct sim_radio_tx {
+	bool received;
+	bool acked;
+	uint8_t attempts;
+	uint8_t copies;         /* times the dongle got it, duplicates included */
+	uint64_t start_us;
+	uint64_t rx_us;         /* end of the first packet the dongle got */
+	uint64_t done_us;
+};
+
+struct sim_radio {
+	struct sim_radio_config cfg;
+	struct sim_channel *ch;
+	int id;
+	uint32_t rng;
+	bool bad;               /* Gilbert-Elliott state of this link */
+
+	int phase;
+	uint32_t len;
+	uint64_t attempt_start;
+	uint64_t event_us;
+	struct sim_radio_tx tx;
+};
+
+struct sim_loss sim_loss_bernoulli(float p);
+
+void sim_channel_init(struct sim_channel *ch, uint16_t bitrate_kbps,
+		      const struct sim_loss *loss);
+
+void sim_radio_init(struct sim_radio *r, struct sim_channel *ch, int id,
+		    const struct sim_radio_config *cfg, uint32_t seed);
+
+/* On-air time of one ESB DPL packet, 0 bytes for a bare ACK */
+uint32_t sim_radio_airtime_us(uint16_t bitrate_kbps, uint32_t payload_len);
+
+/* Time of one attempt, including the wait for the ACK */
+uint32_t sim_radio_slot_us(const struct sim_radio *r, uint32_t payload_len);
+
+bool sim_radio_busy(const struct sim_radio *r);
+
+/* Put a payload on the air now; the radio must not be busy */
+void sim_radio_start(struct sim_radio *r, uint64_t now_us, uint32_t payload_len);
+
+/* Time of the radio's next event, UINT64_MAX when idle */
+uint64_t sim_radio_next_event(const struct sim_radio *r);
+
+/* Handle the event at sim_radio_next_event() */
+enum sim_radio_event sim_radio_step(struct sim_radio *r);
+
+/* Uniform in [0, 1), xorshift32 so runs are repeatable */
+double sim_radio_uniform(uint32_t *state);
+
+#endif
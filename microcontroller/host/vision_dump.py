@@ -0,0 +1,48 @@
+# vision_dump.py
+#
+# Runs a recorded video through pi/testFinalProject/vision.py's blob tracker
+# and writes the camera fixes fusion_replay reads, one line per frame:
+#   t,valid,x,y
+# t is seconds from the first frame (plus -offset, to line it up with the
+# IMU capture), x and y are VisionData's normalised 0..1 position.
+#
+# -fast uses fast_vision.py's FastCameraTracker (pi/blobtrack) instead.
+#
+# Usage: python3 vision_dump.py video.mp4 [-color green] [-offset s] [-fast] > camera.csv
+import argparse
+import os
+import sys
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             "..", "..", "pi", "testFinalProject"))
+
+import cv2                              # noqa: E402
+from vision import CameraTracker        # noqa: E402
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("video")
+    parser.add_argument("-color", default="green")
+    parser.add_argument("-offset", type=float, default=0.0)
+    parser.add_argument("-fast", action="store_true")
+    args = parser.parse_args()
+
+    # VideoCapture takes a file name as well as a camera number
+    if args.fast:
+        from fast_vision import FastCameraTracker
+        tracker = FastCameraTracker(camera_id=args.video)
+    else:
+        tracker = CameraTracker(camera_id=args.video)
+    fps = tracker.cap.get(cv2.CAP_PROP_FPS) or 30.0
+    frames = int(tracker.cap.get(cv2.CAP_PROP_FRAME_COUNT))
+
+    print("t,valid,x,y")
+    for i in range(frames):
+        v = tracker.get_position(args.color)
+        print("%.4f,%d,%.5f,%.5f" % (args.offset + i / fps, v.valid, v.x, v.y))
+    tracker.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,155 @@
+/*
+ * Attitude filters (Mahony, Madgwick) for the glove IMU.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include "ahrs.h"
+
+#include <math.h>
+
+static float inv_sqrt(float x)
+{
+	return 1.0f / sqrtf(x);
+}
+
+static void normalize_quat(float q[4])
+{
+	float n = inv_sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+	q[0] *= n;
+	q[1] *= n;
+	q[2] *= n;
+	q[3] *= n;
+}
+
+void ahrs_init(struct ahrs *f, float kp, float ki, float beta)
+{
+	f->q[0] = 1.0f;
+	f->q[1] = 0.0f;
+	f->q[2] = 0.0f;
+	f->q[3] = 0.0f;
+	f->e_int[0] = f->e_int[1] = f->e_int[2] = 0.0f;
+	f->kp = kp;
+	f->ki = ki;
+	f->beta = beta;
+}
+
+void ahrs_gravity(const struct ahrs *f, float g[3])
+{
+	const float *q = f->q;
+
+	g[0] = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+	g[1] = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+	g[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+void ahrs_linear_accel(const struct ahrs *f, const float accel[3], float out[3])
+{
+	float g[3];
+
+	ahrs_gravity(f, g);
+	out[0] = accel[0] - AHRS_GRAVITY * g[0];
+	out[1] = accel[1] - AHRS_GRAVITY * g[1];
+	out[2] = accel[2] - AHRS_GRAVITY * g[2];
+}
+
+void ahrs_mahony_update(struct ahrs *f, const float gyro[3],
+			const float accel[3], float dt)
+{
+	float *q = f->q;
+	float ax = accel[0], ay = accel[1], az = accel[2];
+	float gx = gyro[0], gy = gyro[1], gz = gyro[2];
+	float norm = ax * ax + ay * ay + az * az;
+	float v[3];
+
+	/* ahrs.py skips the whole update when there is no accel reading */
+	if (norm == 0.0f) {
+		return;
+	}
+	norm = inv_sqrt(norm);
+	ax *= norm;
+	ay *= norm;
+	az *= norm;
+
+	/* Estimated direction of gravity */
+	ahrs_gravity(f, v);
+
+	/* Error is the cross product of measured and estimated gravity */
+	float ex = ay * v[2] - az * v[1];
+	float ey = az * v[0] - ax * v[2];
+	float ez = ax * v[1] - ay * v[0];
+
+	f->e_int[0] += f->ki * ex * dt;
+	f->e_int[1] += f->ki * ey * dt;
+	f->e_int[2] += f->ki * ez * dt;
+
+	gx += f->kp * ex + f->e_int[0];
+	gy += f->kp * ey + f->e_int[1];
+	gz += f->kp * ez + f->e_int[2];
+
+	/* dq/dt = 0.5 * q * omega */
+	float half_dt = 0.5f * dt;
+	float qa = q[0], qb = q[1], qc = q[2], qd = q[3];
+
+	q[0] += (-qb * gx - qc * gy - qd * gz) * half_dt;
+	q[1] += (qa * gx + qc * gz - qd * gy) * half_dt;
+	q[2] += (qa * gy - qb * gz + qd * gx) * half_dt;
+	q[3] += (qa * gz + qb * gy - qc * gx) * half_dt;
+
+	normalize_quat(q);
+}
+
+void ahrs_madgwick_update(struct ahrs *f, const float gyro[3],
+			  const float accel[3], float dt)
+{
+	float *q = f->q;
+	float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+	float gx = gyro[0], gy = gyro[1], gz = gyro[2];
+	float ax = accel[0], ay = accel[1], az = accel[2];
+
+	/* Rate of change of quaternion from gyroscope */
+	float qdot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+	float qdot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+	float qdot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+	float qdot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+	float norm = ax * ax + ay * ay + az * az;
+
+	if (norm != 0.0f) {
+		norm = inv_sqrt(norm);
+		ax *= norm;
+		ay *= norm;
+		az *= norm;
+
+		float q0q0 = q0 * q0, q1q1 = q1 * q1;
+		float q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+		/* Gradient descent corrective step */
+		float s0 = 4.0f * q0 * q2q2 + 2.0f * q2 * ax +
+			   4.0f * q0 * q1q1 - 2.0f * q1 * ay;
+		float s1 = 4.0f * q1 * q3q3 - 2.0f * q3 * ax +
+			   4.0f * q0q0 * q1 - 2.0f * q0 * ay - 4.0f * q1 +
+			   8.0f * q1 * q1q1 + 8.0f * q1 * q2q2 + 4.0f * q1 * az;
+		float s2 = 4.0f * q0q0 * q2 + 2.0f * q0 * ax +
+			   4.0f * q2 * q3q3 - 2.0f * q3 * ay - 4.0f * q2 +
+			   8.0f * q2 * q1q1 + 8.0f * q2 * q2q2 + 4.0f * q2 * az;
+		float s3 = 4.0f * q1q1 * q3 - 2.0f * q1 * ax +
+			   4.0f * q2q2 * q3 - 2.0f * q2 * ay;
+
+		norm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+		if (norm != 0.0f) {
+			norm = inv_sqrt(norm);
+			qdot0 -= f->beta * s0 * norm;
+			qdot1 -= f->beta * s1 * norm;
+			qdot2 -= f->beta * s2 * norm;
+			qdot3 -= f->beta * s3 * norm;
+		}
+	}
+
+	q[0] = q0 + qdot0 * dt;
+	q[1] = q1 + qdot1 * dt;
+	q[2] = q2 + qdot2 * dt;
+	q[3] = q3 + qdot3 * dt;
+
+	normalize_quat(q);
+}
@@ -0,0 +1,41 @@
+/*
+ * Attitude filters (Mahony, Madgwick) for the glove IMU.
+ *
+ * Plain C with no Zephyr dependencies so the same code runs on the glove and
+ * in the Linux host build (see microcontroller/host).
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _AHRS_H_
+#define _AHRS_H_
+
+/* Standard gravity, m/s^2 */
+#define AHRS_GRAVITY 9.80665f
+
+struct ahrs {
+	float q[4];     /* w, x, y, z */
+	float e_int[3]; /* Mahony integral error */
+	float kp;       /* Mahony proportional gain */
+	float ki;       /* Mahony integral gain */
+	float beta;     /* Madgwick gain */
+};
+
+void ahrs_init(struct ahrs *f, float kp, float ki, float beta);
+
+/* gyro in rad/s, accel in any unit (only its direction is used), dt in s.
+ * Matches MahonyFilter.update() in pi/testFinalProject/ahrs.py.
+ */
+void ahrs_mahony_update(struct ahrs *f, const float gyro[3],
+			const float accel[3], float dt);
+
+void ahrs_madgwick_update(struct ahrs *f, const float gyro[3],
+			  const float accel[3], float dt);
+
+/* Unit gravity direction in the body frame for the current attitude. */
+void ahrs_gravity(const struct ahrs *f, float g[3]);
+
+/* Body-frame accel (m/s^2) minus gravity for the current attitude. */
+void ahrs_linear_accel(const struct ahrs *f, const float accel[3],
+		       float out[3]);
+
+#endif
@@ -12,10 +12,62 @@
 #error "Unsupported board: sw0 devicetree alias is not defined"
 #endif
 
+/* Contacts are read this long after the last bounce */
+#define BUTTON_DEBOUNCE_MS 5
+
 static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET_OR(SW0_NODE, gpios, {0});
 static struct gpio_callback button_cb_data;
 
-volatile bool button_pressed_flag;
+/*
+ * Edges waiting for the dongle. The interrupt only notes when a bounce
+ * burst started; debounce_work reads the settled level and records an
+ * edge stamped with that first bounce, so the time is the press, not the
+ * end of the bouncing.
+ */
+static struct k_spinlock edge_lock;
+static Button_EdgePacked edges[BUTTON_EDGE_WINDOW];
+static uint8_t edge_head;      /* oldest pending */
+static uint8_t edge_count;
+static uint8_t edge_seq;       /* seq of the next edge */
+static bool level;             /* last recorded state */
+
+static bool bouncing;
+static uint32_t bounce_start_us;
+
+static void debounce_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(debounce_work, debounce_fn);
+
+uint32_t button_clock_us(void)
+{
+    return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static void debounce_fn(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    bool pressed = gpio_pin_get_dt(&button) > 0;
+
+    K_SPINLOCK(&edge_lock) {
+        bouncing = false;
+        if (pressed == level) {
+            K_SPINLOCK_BREAK;
+        }
+        level = pressed;
+
+        if (edge_count == BUTTON_EDGE_WINDOW) {
+            // Nobody has acked for a while; the host sees the gap in seq
+            edge_head = (edge_head + 1) % BUTTON_EDGE_WINDOW;
+            edge_count--;
+        }
+        Button_EdgePacked *e = &edges[(edge_head + edge_count) % BUTTON_EDGE_WINDOW];
+
+        e->seq = edge_seq++;
+        e->pressed = pressed;
+        e->t_us = bounce_start_us;
+        edge_count++;
+    }
+}
 
 static void button_pressed_cb(const struct device *dev, struct gpio_callback *cb,
                               uint32_t pins)
@@ -24,7 +76,47 @@ static void button_pressed_cb(const struct device *dev, struct gpio_callback *cb
     ARG_UNUSED(cb);
     ARG_UNUSED(pins);
 
-    button_pressed_flag = true;
+    K_SPINLOCK(&edge_lock) {
+        if (!bouncing) {
+            bouncing = true;
+            bounce_start_us = button_clock_us();
+        }
+    }
+    k_work_reschedule(&debounce_work, K_MSEC(BUTTON_DEBOUNCE_MS));
+}
+
+bool button_is_pressed(void)
+{
+    bool pressed;
+
+    K_SPINLOCK(&edge_lock) {
+        pressed = level;
+    }
+    return pressed;
+}
+
+uint8_t button_pending_edges(Button_EdgePacked *out, uint8_t max)
+{
+    uint8_t n;
+
+    K_SPINLOCK(&edge_lock) {
+        n = MIN(max, edge_count);
+        for (uint8_t i = 0; i < n; i++) {
+            out[i] = edges[(edge_head + i) % BUTTON_EDGE_WINDOW];
+        }
+    }
+    return n;
+}
+
+void button_edges_acked(uint8_t seq)
+{
+    K_SPINLOCK(&edge_lock) {
+        // Drop everything up to seq; an ack for edges already dropped changes nothing
+        while (edge_count > 0 && (int8_t)(seq - edges[edge_head].seq) >= 0) {
+            edge_head = (edge_head + 1) % BUTTON_EDGE_WINDOW;
+            edge_count--;
+        }
+    }
 }
 
 int button_init(void)
@@ -43,10 +135,13 @@ int button_init(void)
         return ret;
     }
 
+    level = gpio_pin_get_dt(&button) > 0;
+
     gpio_init_callback(&button_cb_data, button_pressed_cb, BIT(button.pin));
     gpio_add_callback(button.port, &button_cb_data);
 
-    ret = gpio_pin_interrupt_configure_dt(&button, GPIO_INT_EDGE_TO_ACTIVE);
+    // Both edges: releases are events too
+    ret = gpio_pin_interrupt_configure_dt(&button, GPIO_INT_EDGE_BOTH);
     if (ret != 0) {
         printk("Error %d: failed to configure interrupt on %s pin %d\n",
                ret, button.port->name, button.pin);
@@ -55,4 +150,4 @@ int button_init(void)
 
     printk("Set up button at %s pin %d\n", button.port->name, button.pin);
     return 0;
-}
\ No newline at end of file
+}
@@ -4,11 +4,21 @@
 #include <zephyr/kernel.h>
 
 #include <stdbool.h>
+#include <stdint.h>
 
-extern volatile bool button_pressed_flag;
+#include "glove_proto.h"
 
 int button_init(void);
 
 bool button_is_pressed(void);
 
-#endif
\ No newline at end of file
+/* Edges the dongle has not acked yet, oldest first. Returns how many. */
+uint8_t button_pending_edges(Button_EdgePacked *out, uint8_t max);
+
+/* A payload carrying edges up to and including seq was acked */
+void button_edges_acked(uint8_t seq);
+
+/* Glove uptime in microseconds, the clock edges are stamped with */
+uint32_t button_clock_us(void);
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Slash detection on the glove sample stream.
+ *
+ * A slash is a burst of linear acceleration above cfg.trigger. It ends when
+ * the magnitude drops under cfg.release; the event carries the time and
+ * vector of the peak. The hand then brakes just as hard in the opposite
+ * direction, so nothing is reported for cfg.refractory_ms afterwards.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include "gesture.h"
+
+#include <math.h>
+#include <string.h>
+
+void gesture_default_config(struct gesture_config *cfg)
+{
+	cfg->trigger = 15.0f;
+	cfg->release = 6.0f;
+	cfg->min_ms = 20;
+	cfg->refractory_ms = 150;
+	cfg->gravity_alpha = 0.995f;
+}
+
+void gesture_init(struct gesture *g, const struct gesture_config *cfg)
+{
+	memset(g, 0, sizeof(*g));
+	g->cfg = *cfg;
+}
+
+static int8_t to_unit_i8(float v, float inv_norm)
+{
+	float s = v * inv_norm * 127.0f;
+
+	if (s > 127.0f) {
+		s = 127.0f;
+	} else if (s < -127.0f) {
+		s = -127.0f;
+	}
+	return (int8_t)lrintf(s);
+}
+
+static void fill_event(const struct gesture *g, Gesture_EventPacked *ev)
+{
+	float inv = g->peak > 0.0f ? 1.0f / g->peak : 0.0f;
+	float mag = g->peak * 100.0f;
+
+	ev->type = GESTURE_SLASH;
+	ev->t_ms = g->peak_ms;
+	ev->dir[0] = to_unit_i8(g->peak_vec[0], inv);
+	ev->dir[1] = to_unit_i8(g->peak_vec[1], inv);
+	ev->dir[2] = to_unit_i8(g->peak_vec[2], inv);
+	ev->magnitude = mag > UINT16_MAX ? UINT16_MAX : (uint16_t)mag;
+}
+
+bool gesture_update(struct gesture *g, const float lin_accel[3], uint32_t t_ms,
+		    Gesture_EventPacked *ev)
+{
+	float mag = sqrtf(lin_accel[0] * lin_accel[0] +
+			  lin_accel[1] * lin_accel[1] +
+			  lin_accel[2] * lin_accel[2]);
+
+	if (!g->active) {
+		/* Signed compare so uptime wrap-around does not stall detection */
+		if ((int32_t)(t_ms - g->quiet_until_ms) < 0 || mag < g->cfg.trigger) {
+			return false;
+		}
+		g->active = true;
+		g->start_ms = t_ms;
+		g->peak = 0.0f;
+	}
+
+	if (mag > g->peak) {
+		g->peak = mag;
+		g->peak_ms = t_ms;
+		memcpy(g->peak_vec, lin_accel, sizeof(g->peak_vec));
+	}
+
+	if (mag >= g->cfg.release) {
+		return false;
+	}
+
+	g->active = false;
+	if (t_ms - g->start_ms < g->cfg.min_ms) {
+		return false;
+	}
+
+	g->quiet_until_ms = t_ms + g->cfg.refractory_ms;
+	fill_event(g, ev);
+	return true;
+}
+
+bool gesture_update_raw(struct gesture *g, const float accel[3], uint32_t t_ms,
+			Gesture_EventPacked *ev)
+{
+	float a = g->cfg.gravity_alpha;
+	float lin[3];
+
+	if (!g->gravity_valid) {
+		memcpy(g->gravity, accel, sizeof(g->gravity));
+		g->gravity_valid = true;
+	}
+
+	/* Only track gravity while nothing is happening, a slash would drag it */
+	for (int i = 0; i < 3; i++) {
+		if (!g->active) {
+			g->gravity[i] = a * g->gravity[i] + (1.0f - a) * accel[i];
+		}
+		lin[i] = accel[i] - g->gravity[i];
+	}
+
+	return gesture_update(g, lin, t_ms, ev);
+}
@@ -0,0 +1,51 @@
+/*
+ * Slash detection on the glove sample stream.
+ *
+ * Plain C with no Zephyr dependencies so the same detector can be run over
+ * recorded captures in the Linux host build (see microcontroller/host).
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _GESTURE_H_
+#define _GESTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "glove_proto.h"
+
+struct gesture_config {
+	float trigger;        /* |linear accel| that starts a slash, m/s^2 */
+	float release;        /* |linear accel| that ends it, m/s^2 */
+	uint32_t min_ms;      /* shorter bursts are knocks, not slashes */
+	uint32_t refractory_ms; /* ignore the deceleration half of the slash */
+	float gravity_alpha;  /* low-pass factor when the input still has gravity */
+};
+
+struct gesture {
+	struct gesture_config cfg;
+	bool active;
+	uint32_t start_ms;
+	uint32_t peak_ms;
+	uint32_t quiet_until_ms;
+	float peak;
+	float peak_vec[3];
+	float gravity[3];
+	bool gravity_valid;
+};
+
+void gesture_default_config(struct gesture_config *cfg);
+
+void gesture_init(struct gesture *g, const struct gesture_config *cfg);
+
+/* Feed one gravity-free accel sample (m/s^2) taken at t_ms. Returns true and
+ * fills ev when a slash has just finished.
+ */
+bool gesture_update(struct gesture *g, const float lin_accel[3], uint32_t t_ms,
+		    Gesture_EventPacked *ev);
+
+/* Same, for raw accel: gravity is tracked with a slow low-pass and removed. */
+bool gesture_update_raw(struct gesture *g, const float accel[3], uint32_t t_ms,
+			Gesture_EventPacked *ev);
+
+#endif
@@ -9,8 +9,29 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/gpio.h>
 #include <stdio.h>
+#include <string.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/sys/atomic.h>
+
+#ifdef CONFIG_IMU_TX_AHRS
+#include "ahrs.h"
+#endif
+#ifdef CONFIG_IMU_TX_GESTURE
+#include "gesture.h"
+#endif
+
+/* Accel/gyro output data rate at boot */
+#define IMU_ODR_HZ 104
+
+/* Full scale at boot, the driver's defaults with runtime full scale */
+#define IMU_ACCEL_FS_G   2
+#define IMU_GYRO_FS_DPS  245
+
+static uint16_t odr_hz = IMU_ODR_HZ;
+static uint8_t accel_fs_g = IMU_ACCEL_FS_G;
+static uint16_t gyro_fs_dps = IMU_GYRO_FS_DPS;
 
 static int print_samples;
 static int lsm6dsl_trig_cnt;
@@ -25,7 +46,151 @@ static struct sensor_value magn_x_out, magn_y_out, magn_z_out;
 static struct sensor_value press_out, temp_out;
 #endif
 
+#ifdef CONFIG_IMU_TX_AHRS
+static struct ahrs filter;
+static AHRS_DataPacked ahrs_out;
+static struct k_spinlock ahrs_lock;
+static uint32_t ahrs_last_cyc;
+
+/* Runs once per sensor sample, right after the new values are latched */
+static void ahrs_step(void)
+{
+	uint32_t now = k_cycle_get_32();
+	float dt = 1.0f / odr_hz;
+	float gyro[3], accel[3], lin[3];
+
+	if (ahrs_last_cyc != 0) {
+		dt = k_cyc_to_us_floor32(now - ahrs_last_cyc) * 1e-6f;
+		/* First sample after a stall: fall back to the nominal period */
+		if (dt <= 0.0f || dt > 0.1f) {
+			dt = 1.0f / odr_hz;
+		}
+	}
+	ahrs_last_cyc = now;
+
+	gyro[0] = sensor_value_to_float(&gyro_x_out);
+	gyro[1] = sensor_value_to_float(&gyro_y_out);
+	gyro[2] = sensor_value_to_float(&gyro_z_out);
+	accel[0] = sensor_value_to_float(&accel_x_out);
+	accel[1] = sensor_value_to_float(&accel_y_out);
+	accel[2] = sensor_value_to_float(&accel_z_out);
+
+#if defined(CONFIG_IMU_TX_AHRS_MADGWICK)
+	ahrs_madgwick_update(&filter, gyro, accel, dt);
+#else
+	ahrs_mahony_update(&filter, gyro, accel, dt);
+#endif
+	ahrs_linear_accel(&filter, accel, lin);
+
+	K_SPINLOCK(&ahrs_lock) {
+		memcpy(ahrs_out.q, filter.q, sizeof(ahrs_out.q));
+		memcpy(ahrs_out.lin_accel, lin, sizeof(ahrs_out.lin_accel));
+	}
+}
+#endif
+
+#ifdef CONFIG_IMU_TX_GESTURE
+static struct gesture detector;
+K_MSGQ_DEFINE(gesture_msgq, sizeof(Gesture_EventPacked), 8, 1);
+
+static void gesture_step(void)
+{
+	Gesture_EventPacked ev;
+	uint32_t now = k_uptime_get_32();
+	bool found;
+
+#ifdef CONFIG_IMU_TX_AHRS
+	/* ahrs_step() has just run on this thread, no need for the lock */
+	found = gesture_update(&detector, ahrs_out.lin_accel, now, &ev);
+#else
+	float accel[3] = {
+		sensor_value_to_float(&accel_x_out),
+		sensor_value_to_float(&accel_y_out),
+		sensor_value_to_float(&accel_z_out),
+	};
+
+	found = gesture_update_raw(&detector, accel, now, &ev);
+#endif
+	if (found) {
+		(void)k_msgq_put(&gesture_msgq, &ev, K_NO_WAIT);
+	}
+}
+#endif
+
+/*
+ * Samples are read on the LSM6DSL driver's own trigger thread (prj.conf,
+ * priority and stack from CONFIG_IMU_TX_SENSOR_THREAD_*), timestamped and
+ * pushed into this ring for the radio loop. When the ring is full the oldest
+ * sample is dropped, the radio only ever wants the freshest data.
+ */
+#define RING_SIZE CONFIG_IMU_TX_SAMPLE_RING_SIZE
+BUILD_ASSERT((RING_SIZE & (RING_SIZE - 1)) == 0, "Sample ring size must be a power of two");
+
+#ifdef CONFIG_LSM6DSL_TRIGGER_OWN_THREAD
+/* Lower numbers run first; main must not hold up the read and filters */
+BUILD_ASSERT(CONFIG_LSM6DSL_THREAD_PRIORITY < CONFIG_MAIN_THREAD_PRIORITY,
+	     "Sensor thread priority must be above main's");
+#endif
+
+static struct imu_sample ring[RING_SIZE];
+static uint32_t ring_head;
+static uint32_t ring_tail;
+static uint32_t ring_overruns;
+static struct k_spinlock ring_lock;
+static K_SEM_DEFINE(sample_sem, 0, 1);
+
+static struct imu_timing timing;
+static struct k_spinlock timing_lock;
+
+static void ring_put(const struct imu_sample *sample)
+{
+	K_SPINLOCK(&ring_lock) {
+		if (ring_head - ring_tail == RING_SIZE) {
+			ring_tail++;
+			ring_overruns++;
+		}
+		ring[ring_head & (RING_SIZE - 1)] = *sample;
+		ring_head++;
+	}
+	k_sem_give(&sample_sem);
+}
+
+static void stage_record(struct imu_stage_stats *st, uint32_t cycles)
+{
+	uint32_t us = k_cyc_to_us_floor32(cycles);
+
+	if (st->count == 0 || us < st->min_us) {
+		st->min_us = us;
+	}
+	if (us > st->max_us) {
+		st->max_us = us;
+	}
+	st->sum_us += us;
+	st->count++;
+}
+
 #ifdef CONFIG_LSM6DSL_TRIGGER
+/* Extra callback on the driver's data-ready pin, only to timestamp the IRQ */
+static const struct gpio_dt_spec imu_irq =
+	GPIO_DT_SPEC_GET(DT_COMPAT_GET_ANY_STATUS_OKAY(st_lsm6dsl), irq_gpios);
+static struct gpio_callback imu_irq_cb;
+/* Cycle count of the latest unhandled IRQ with bit 0 set, 0 when consumed */
+static atomic_t irq_stamp;
+static atomic_t irq_overwrites;
+
+static void imu_irq_timestamp(const struct device *dev, struct gpio_callback *cb,
+			      uint32_t pins)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(pins);
+
+	/* Still set: the handler never ran for the previous IRQ */
+	if (atomic_set(&irq_stamp, (atomic_val_t)(k_cycle_get_32() | 1)) != 0) {
+		atomic_inc(&irq_overwrites);
+	}
+}
+
 static void lsm6dsl_trigger_handler(const struct device *dev,
 				    const struct sensor_trigger *trig)
 {
@@ -37,6 +202,11 @@ static void lsm6dsl_trigger_handler(const struct device *dev,
 #if defined(CONFIG_LSM6DSL_EXT0_LPS22HB)
 	static struct sensor_value press, temp;
 #endif
+	uint32_t start = k_cycle_get_32();
+	atomic_val_t stamp = atomic_clear(&irq_stamp);
+	uint32_t irq = stamp != 0 ? (uint32_t)stamp : start;
+	struct imu_sample sample;
+
 	lsm6dsl_trig_cnt++;
 
 	sensor_sample_fetch_chan(dev, SENSOR_CHAN_ACCEL_XYZ);
@@ -75,6 +245,26 @@ static void lsm6dsl_trigger_handler(const struct device *dev,
 	gyro_y_out = gyro_y;
 	gyro_z_out = gyro_z;
 
+#ifdef CONFIG_IMU_TX_AHRS
+	ahrs_step();
+#endif
+#ifdef CONFIG_IMU_TX_GESTURE
+	gesture_step();
+#endif
+
+	/* Stamp with the data-ready IRQ, that is when the sample was taken */
+	sample.t_us = k_cyc_to_us_floor32(irq);
+	sample.imu = get_packed_imu_data();
+#ifdef CONFIG_IMU_TX_AHRS
+	sample.ahrs = ahrs_out;
+#endif
+	ring_put(&sample);
+
+	K_SPINLOCK(&timing_lock) {
+		stage_record(&timing.irq_to_thread, start - irq);
+		stage_record(&timing.thread_to_ready, k_cycle_get_32() - start);
+	}
+
 // 	if (print_samples) {
 // 		print_samples = 0;
 
@@ -98,7 +288,6 @@ static void lsm6dsl_trigger_handler(const struct device *dev,
 int imu_init(){
     // int cnt = 0;
 	// char out_str[64];
-	struct sensor_value odr_attr;
 	lsm6dsl_dev = DEVICE_DT_GET_ONE(st_lsm6dsl);
 
 	if (!device_is_ready(lsm6dsl_dev)) {
@@ -106,19 +295,25 @@ int imu_init(){
 		return -1;
 	}
 
-	/* set accel/gyro sampling frequency to 104 Hz */
-	odr_attr.val1 = 104;
-	odr_attr.val2 = 0;
+#ifdef CONFIG_IMU_TX_AHRS
+	ahrs_init(&filter, CONFIG_IMU_TX_AHRS_KP_MILLI / 1000.0f,
+		  CONFIG_IMU_TX_AHRS_KI_MILLI / 1000.0f,
+		  CONFIG_IMU_TX_AHRS_BETA_MILLI / 1000.0f);
+#endif
 
-	if (sensor_attr_set(lsm6dsl_dev, SENSOR_CHAN_ACCEL_XYZ,
-			    SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr) < 0) {
-		printk("Cannot set sampling frequency for accelerometer.\n");
-		return -1;
-	}
+#ifdef CONFIG_IMU_TX_GESTURE
+	struct gesture_config gesture_cfg;
 
-	if (sensor_attr_set(lsm6dsl_dev, SENSOR_CHAN_GYRO_XYZ,
-			    SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr) < 0) {
-		printk("Cannot set sampling frequency for gyro.\n");
+	gesture_default_config(&gesture_cfg);
+	gesture_cfg.trigger = CONFIG_IMU_TX_GESTURE_TRIGGER_MILLI / 1000.0f;
+	gesture_cfg.release = CONFIG_IMU_TX_GESTURE_RELEASE_MILLI / 1000.0f;
+	gesture_cfg.min_ms = CONFIG_IMU_TX_GESTURE_MIN_MS;
+	gesture_cfg.refractory_ms = CONFIG_IMU_TX_GESTURE_REFRACTORY_MS;
+	gesture_init(&detector, &gesture_cfg);
+#endif
+
+	/* set accel/gyro sampling frequency to 104 Hz */
+	if (imu_set_odr(IMU_ODR_HZ) < 0) {
 		return -1;
 	}
 
@@ -132,6 +327,12 @@ int imu_init(){
 		printk("Could not set sensor type and channel\n");
 		return 0;
 	}
+
+	/* The driver has configured the pin, just listen in on it */
+	gpio_init_callback(&imu_irq_cb, imu_irq_timestamp, BIT(imu_irq.pin));
+	if (gpio_add_callback(imu_irq.port, &imu_irq_cb) != 0) {
+		printk("Could not add IRQ timestamp callback\n");
+	}
 #endif
 
 	if (sensor_sample_fetch(lsm6dsl_dev) < 0) {
@@ -171,6 +372,132 @@ IMU_DataPacked get_packed_imu_data(){
     return sensor_data;
 }
 
+#ifdef CONFIG_IMU_TX_AHRS
+AHRS_DataPacked get_packed_ahrs_data(){
+    AHRS_DataPacked ahrs_data;
+
+    K_SPINLOCK(&ahrs_lock) {
+        ahrs_data = ahrs_out;
+    }
+
+    return ahrs_data;
+}
+#endif
+
+int imu_set_odr(uint16_t hz)
+{
+	struct sensor_value odr_attr = { .val1 = hz, .val2 = 0 };
+
+	if (sensor_attr_set(lsm6dsl_dev, SENSOR_CHAN_ACCEL_XYZ,
+			    SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr) < 0) {
+		printk("Cannot set sampling frequency for accelerometer.\n");
+		return -EIO;
+	}
+
+	if (sensor_attr_set(lsm6dsl_dev, SENSOR_CHAN_GYRO_XYZ,
+			    SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr) < 0) {
+		printk("Cannot set sampling frequency for gyro.\n");
+		return -EIO;
+	}
+
+	odr_hz = hz;
+	return 0;
+}
+
+uint16_t imu_get_odr(void)
+{
+	return odr_hz;
+}
+
+int imu_set_accel_fs(uint8_t g)
+{
+	struct sensor_value fs;
+
+	sensor_g_to_ms2(g, &fs);
+	if (sensor_attr_set(lsm6dsl_dev, SENSOR_CHAN_ACCEL_XYZ,
+			    SENSOR_ATTR_FULL_SCALE, &fs) < 0) {
+		printk("Cannot set accelerometer full scale %u g.\n", g);
+		return -EIO;
+	}
+
+	accel_fs_g = g;
+	return 0;
+}
+
+uint8_t imu_get_accel_fs(void)
+{
+	return accel_fs_g;
+}
+
+int imu_set_gyro_fs(uint16_t dps)
+{
+	struct sensor_value fs;
+
+	sensor_degrees_to_rad(dps, &fs);
+	if (sensor_attr_set(lsm6dsl_dev, SENSOR_CHAN_GYRO_XYZ,
+			    SENSOR_ATTR_FULL_SCALE, &fs) < 0) {
+		printk("Cannot set gyro full scale %u dps.\n", dps);
+		return -EIO;
+	}
+
+	gyro_fs_dps = dps;
+	return 0;
+}
+
+uint16_t imu_get_gyro_fs(void)
+{
+	return gyro_fs_dps;
+}
+
+int imu_pop_sample(struct imu_sample *sample)
+{
+	int ret = -EAGAIN;
+
+	K_SPINLOCK(&ring_lock) {
+		if (ring_tail != ring_head) {
+			*sample = ring[ring_tail & (RING_SIZE - 1)];
+			ring_tail++;
+			ret = 0;
+		}
+	}
+	return ret;
+}
+
+int imu_wait_sample(k_timeout_t timeout)
+{
+	return k_sem_take(&sample_sem, timeout);
+}
+
+void imu_get_timing(struct imu_timing *out, bool reset)
+{
+	K_SPINLOCK(&timing_lock) {
+		*out = timing;
+		if (reset) {
+			memset(&timing, 0, sizeof(timing));
+		}
+	}
+	K_SPINLOCK(&ring_lock) {
+		out->ring_overruns = ring_overruns;
+		if (reset) {
+			ring_overruns = 0;
+		}
+	}
+#ifdef CONFIG_LSM6DSL_TRIGGER
+	out->irq_overwrites = reset ? atomic_clear(&irq_overwrites)
+				    : atomic_get(&irq_overwrites);
+#endif
+}
+
+int imu_get_gesture(Gesture_EventPacked *ev)
+{
+#ifdef CONFIG_IMU_TX_GESTURE
+	return k_msgq_get(&gesture_msgq, ev, K_NO_WAIT);
+#else
+	ARG_UNUSED(ev);
+	return -ENOMSG;
+#endif
+}
+
 int old_main(void)
 {
 	int cnt = 0;
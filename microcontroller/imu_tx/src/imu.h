@@ -1,6 +1,12 @@
 #ifndef _IMU_H_
 #define _IMU_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#include "glove_proto.h"
+
 struct accel_data{
     double x;
     double y;
@@ -35,4 +41,58 @@ IMU_Data get_imu_data();
 
 IMU_DataPacked get_packed_imu_data();
 
+/* Latest attitude estimate, updated at the full sensor rate */
+AHRS_DataPacked get_packed_ahrs_data();
+
+/* One sensor reading as queued by the acquisition thread */
+struct imu_sample {
+    uint32_t t_us;          /* uptime at the data-ready IRQ */
+    IMU_DataPacked imu;
+#ifdef CONFIG_IMU_TX_AHRS
+    AHRS_DataPacked ahrs;   /* attitude after this sample */
+#endif
+};
+
+/* Per-stage latency of the acquisition thread, in us */
+struct imu_stage_stats {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+};
+
+struct imu_timing {
+    struct imu_stage_stats irq_to_thread;   /* data-ready IRQ -> handler runs */
+    struct imu_stage_stats thread_to_ready; /* handler runs -> sample in ring */
+    uint32_t ring_overruns;                 /* oldest samples dropped */
+    uint32_t irq_overwrites;                /* IRQs stamped over before handled */
+};
+
+/* Change the accel/gyro output data rate, Hz. Returns 0 or -EIO. */
+int imu_set_odr(uint16_t hz);
+
+uint16_t imu_get_odr(void);
+
+/* Change the full scale, g or dps. Returns 0, or -EIO for a range the
+ * sensor does not have (accel 2/4/8/16 g, gyro 125/245/500/1000/2000 dps). */
+int imu_set_accel_fs(uint8_t g);
+
+uint8_t imu_get_accel_fs(void);
+
+int imu_set_gyro_fs(uint16_t dps);
+
+uint16_t imu_get_gyro_fs(void);
+
+/* Pop the oldest queued sample. Returns 0 on success, -EAGAIN if empty. */
+int imu_pop_sample(struct imu_sample *sample);
+
+/* Block until a sample has been queued since the last call, or timeout. */
+int imu_wait_sample(k_timeout_t timeout);
+
+/* Snapshot the stage counters, optionally starting a new window. */
+void imu_get_timing(struct imu_timing *out, bool reset);
+
+/* Pop the oldest detected slash. Returns 0 on success, -ENOMSG if none. */
+int imu_get_gesture(Gesture_EventPacked *ev);
+
 #endif
\ No newline at end of file
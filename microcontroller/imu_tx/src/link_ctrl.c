@@ -0,0 +1,248 @@
+/*
+ * Adaptive radio link settings for the glove.
+ *
+ * Each control period is classified from the ESB counters:
+ *
+ *   lossy     payloads run out of retransmits: allow more retransmits, or
+ *             if the latency target does not leave room, back off further
+ *   contended most payloads need retries but get through, usually another
+ *             glove on the same channel: back off the retransmit delay so
+ *             the two stop colliding on every retry
+ *   backlog   the TX queue is dropping payloads: pack more samples into
+ *             each payload, and if that is not enough lower the sensor rate
+ *   calm      after cfg.calm_windows quiet periods undo one step, sensor
+ *             rate first since that is what the game actually wants
+ *
+ * Nothing is changed if the result would break cfg.latency_target_us.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include "link_ctrl.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* ESB at 2 Mbps: 1 byte preamble, 5 byte address, 9 bit PCF, 2 byte CRC */
+#define ESB_BITS_OVERHEAD (8 * (1 + 5 + 2) + 9)
+/* Radio ramp-up plus the PTX switching to receive the ACK */
+#define ESB_TURNAROUND_US 150
+
+void link_ctrl_default_config(struct link_ctrl_config *cfg)
+{
+	cfg->latency_target_us = 20000;
+	cfg->sample_bytes = 24;
+	cfg->batch_max = 4;
+	cfg->odr_min_hz = 26;
+	cfg->delay_max_us = 2400;
+	cfg->delay_step_us = 150;
+	cfg->count_max = 8;
+	cfg->min_packets = 10;
+	cfg->fail_hi_permille = 20;
+	cfg->retry_hi_permille = 400;
+	cfg->retry_lo_permille = 100;
+	cfg->calm_windows = 4;
+}
+
+void link_ctrl_init(struct link_ctrl *c, const struct link_ctrl_config *cfg,
+		    const struct link_params *start)
+{
+	memset(c, 0, sizeof(*c));
+	c->cfg = *cfg;
+	c->home = *start;
+	c->params = *start;
+}
+
+uint32_t link_airtime_us(uint32_t payload_len)
+{
+	uint32_t bits = ESB_BITS_OVERHEAD + 8 * payload_len;
+
+	/* Two bits per microsecond, rounded up */
+	return (bits + 1) / 2;
+}
+
+uint32_t link_ack_airtime_us(void)
+{
+	return link_airtime_us(0);
+}
+
+uint32_t link_worst_latency_us(const struct link_ctrl_config *cfg,
+			       const struct link_params *p)
+{
+	uint32_t len = 1 + (uint32_t)p->batch * cfg->sample_bytes;
+	uint32_t slot = link_airtime_us(len) + ESB_TURNAROUND_US + link_ack_airtime_us();
+
+	if (p->retransmit_delay_us > slot) {
+		slot = p->retransmit_delay_us;
+	}
+
+	/* The first sample of a batch waits for the rest to be taken */
+	uint32_t fill = (uint32_t)(p->batch - 1) * (1000000u / p->odr_hz);
+
+	return fill + (uint32_t)(p->retransmit_count + 1) * slot;
+}
+
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+/* The LSM6DSL driver only takes these exact rates */
+static const uint16_t odr_steps[] = { 12, 26, 52, 104, 208, 416, 833, 1666 };
+
+bool link_odr_valid(uint16_t hz)
+{
+	for (size_t i = 0; i < ARRAY_LEN(odr_steps); i++) {
+		if (odr_steps[i] == hz) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Next rate down from hz, 0 if none */
+static uint16_t odr_below(uint16_t hz)
+{
+	for (size_t i = ARRAY_LEN(odr_steps); i-- > 0;) {
+		if (odr_steps[i] < hz) {
+			return odr_steps[i];
+		}
+	}
+	return 0;
+}
+
+/* Next rate up from hz, but not past cap */
+static uint16_t odr_above(uint16_t hz, uint16_t cap)
+{
+	for (size_t i = 0; i < ARRAY_LEN(odr_steps); i++) {
+		if (odr_steps[i] > hz) {
+			return odr_steps[i] < cap ? odr_steps[i] : cap;
+		}
+	}
+	return cap;
+}
+
+static bool fits(const struct link_ctrl *c, const struct link_params *p)
+{
+	return link_worst_latency_us(&c->cfg, p) <= c->cfg.latency_target_us;
+}
+
+static bool more_retransmits(struct link_ctrl *c)
+{
+	struct link_params p = c->params;
+
+	if (p.retransmit_count >= c->cfg.count_max) {
+		return false;
+	}
+	p.retransmit_count++;
+	if (!fits(c, &p)) {
+		return false;
+	}
+	c->params = p;
+	return true;
+}
+
+static bool back_off(struct link_ctrl *c)
+{
+	struct link_params p = c->params;
+
+	if (p.retransmit_delay_us >= c->cfg.delay_max_us) {
+		return false;
+	}
+	p.retransmit_delay_us += c->cfg.delay_step_us;
+	if (p.retransmit_delay_us > c->cfg.delay_max_us) {
+		p.retransmit_delay_us = c->cfg.delay_max_us;
+	}
+	if (!fits(c, &p)) {
+		return false;
+	}
+	c->params = p;
+	return true;
+}
+
+static bool shed_load(struct link_ctrl *c)
+{
+	struct link_params p = c->params;
+
+	if (p.batch < c->cfg.batch_max) {
+		p.batch++;
+		if (fits(c, &p)) {
+			c->params = p;
+			return true;
+		}
+		p.batch--;
+	}
+	uint16_t lower = odr_below(p.odr_hz);
+
+	if (lower != 0 && lower >= c->cfg.odr_min_hz) {
+		p.odr_hz = lower;
+		if (fits(c, &p)) {
+			c->params = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Undo one step towards c->home, most useful first */
+static bool relax(struct link_ctrl *c)
+{
+	struct link_params *p = &c->params;
+	const struct link_params *h = &c->home;
+
+	if (p->odr_hz < h->odr_hz) {
+		p->odr_hz = odr_above(p->odr_hz, h->odr_hz);
+		return true;
+	}
+	if (p->batch > h->batch) {
+		p->batch--;
+		return true;
+	}
+	if (p->retransmit_count > h->retransmit_count) {
+		p->retransmit_count--;
+		return true;
+	}
+	if (p->retransmit_delay_us > h->retransmit_delay_us) {
+		uint16_t step = c->cfg.delay_step_us;
+
+		p->retransmit_delay_us = p->retransmit_delay_us - h->retransmit_delay_us > step ?
+			p->retransmit_delay_us - step : h->retransmit_delay_us;
+		return true;
+	}
+	return false;
+}
+
+bool link_ctrl_update(struct link_ctrl *c, const struct link_window *w)
+{
+	uint32_t packets = w->success + w->failed;
+	bool changed = false;
+
+	if (packets < c->cfg.min_packets && w->dropped == 0) {
+		return false;
+	}
+
+	uint32_t fail = packets ? w->failed * 1000u / packets : 0;
+	uint32_t retry = packets ? w->retransmits * 1000u / packets : 0;
+	bool lossy = fail > c->cfg.fail_hi_permille;
+	bool contended = retry > c->cfg.retry_hi_permille;
+	bool backlog = w->dropped > 0;
+
+	if (lossy || contended || backlog) {
+		c->calm = 0;
+		if (lossy) {
+			changed |= more_retransmits(c) || back_off(c);
+		} else if (contended) {
+			changed |= back_off(c);
+		}
+		if (backlog) {
+			changed |= shed_load(c);
+		}
+		return changed;
+	}
+
+	if (w->failed == 0 && retry < c->cfg.retry_lo_permille) {
+		if (++c->calm >= c->cfg.calm_windows) {
+			c->calm = 0;
+			changed = relax(c);
+		}
+	} else {
+		c->calm = 0;
+	}
+	return changed;
+}
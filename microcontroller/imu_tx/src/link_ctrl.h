@@ -0,0 +1,77 @@
+/*
+ * Adaptive radio link settings for the glove.
+ *
+ * Looks at the ESB counters over one control period and moves the
+ * retransmit delay/count, the number of samples per payload and the sensor
+ * rate to keep delivered samples up without breaking a latency target.
+ *
+ * Plain C with no Zephyr dependencies; the policy is exercised against a
+ * simulated channel in the Linux host build (see microcontroller/host).
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _LINK_CTRL_H_
+#define _LINK_CTRL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct link_params {
+	uint16_t retransmit_delay_us;
+	uint8_t retransmit_count;
+	uint8_t batch;          /* samples per payload */
+	uint16_t odr_hz;        /* sensor output data rate */
+};
+
+/* Radio counters over one control period */
+struct link_window {
+	uint32_t success;       /* payloads acked */
+	uint32_t failed;        /* payloads that ran out of retransmits */
+	uint32_t retransmits;   /* attempts beyond the first */
+	uint32_t dropped;       /* queued payloads aged out or superseded */
+};
+
+struct link_ctrl_config {
+	uint32_t latency_target_us;  /* sample taken -> acked, worst case */
+	uint8_t sample_bytes;        /* one sample in a payload */
+	uint8_t batch_max;
+	uint16_t odr_min_hz;
+	uint16_t delay_max_us;
+	uint16_t delay_step_us;
+	uint8_t count_max;
+	uint32_t min_packets;        /* smaller windows are ignored */
+	uint16_t fail_hi_permille;   /* above this the link is lossy */
+	uint16_t retry_hi_permille;  /* retransmits per payload, contention */
+	uint16_t retry_lo_permille;  /* below this (and no loss) it is calm */
+	uint8_t calm_windows;        /* calm periods before relaxing a step */
+};
+
+struct link_ctrl {
+	struct link_ctrl_config cfg;
+	struct link_params home;     /* where relaxing heads back to */
+	struct link_params params;
+	uint8_t calm;
+};
+
+void link_ctrl_default_config(struct link_ctrl_config *cfg);
+
+/* start is both the initial setting and what a calm link returns to */
+void link_ctrl_init(struct link_ctrl *c, const struct link_ctrl_config *cfg,
+		    const struct link_params *start);
+
+/* Feed one control period. Returns true if c->params changed. */
+bool link_ctrl_update(struct link_ctrl *c, const struct link_window *w);
+
+/* On-air time of one ESB DPL packet at 2 Mbps, and of its ACK */
+uint32_t link_airtime_us(uint32_t payload_len);
+uint32_t link_ack_airtime_us(void);
+
+/* A rate the sensor driver accepts: 12, 26, 52, 104, 208, 416, 833 or 1666 Hz.
+ * Steps down and back up go through these. */
+bool link_odr_valid(uint16_t hz);
+
+/* Worst-case time from a sample being taken to its payload being acked */
+uint32_t link_worst_latency_us(const struct link_ctrl_config *cfg,
+			       const struct link_params *p);
+
+#endif
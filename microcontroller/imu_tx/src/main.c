@@ -21,6 +21,13 @@
 
 #include "imu.h"
 #include "button.h"
+#include "glove_wire.h"
+#ifdef CONFIG_IMU_TX_LINK_ADAPT
+#include "link_ctrl.h"
+#endif
+#ifdef CONFIG_IMU_TX_TDMA
+#include "tdma.h"
+#endif
 
 // fallback default if not provided by CMake 
 #ifndef TRANSMITTER_PIPE
@@ -31,6 +38,35 @@
 _Static_assert(TRANSMITTER_PIPE >= 0 && TRANSMITTER_PIPE <= 7,
                "TRANSMITTER_PIPE must be between 0 and 7");
 
+/* What each sample payload carries at boot, see glove_proto.h */
+#if defined(CONFIG_IMU_TX_STREAM_AHRS)
+#define STREAM_KIND PAYLOAD_KIND_AHRS
+#elif defined(CONFIG_IMU_TX_STREAM_RAW_AHRS)
+#define STREAM_KIND PAYLOAD_KIND_RAW_AHRS
+#else
+#define STREAM_KIND PAYLOAD_KIND_RAW
+#endif
+
+/* How often the acquisition stage counters are logged */
+#define IMU_TIMING_REPORT_MS 5000
+
+/* Radio settings at boot, and what the link controller relaxes back to */
+#define TX_RETRANSMIT_DELAY_US 600
+#define TX_RETRANSMIT_COUNT    3
+
+/* Several raw samples per payload, not while slash detection decimates */
+#if !defined(CONFIG_IMU_TX_GESTURE)
+#define TX_BATCH_MAX CONFIG_IMU_TX_BATCH_MAX
+#else
+#define TX_BATCH_MAX 1
+#endif
+
+BUILD_ASSERT(1 + TX_BATCH_MAX * sizeof(IMU_DataPacked) <= CONFIG_ESB_MAX_PAYLOAD_LENGTH,
+	     "Batched payload does not fit in an ESB payload");
+
+BUILD_ASSERT(1 + sizeof(IMU_DataPacked) + sizeof(AHRS_DataPacked) <= CONFIG_ESB_MAX_PAYLOAD_LENGTH,
+	     "Sample payload does not fit in an ESB payload");
+
 #if defined(CONFIG_CLOCK_CONTROL_NRF2)
 #include <hal/nrf_lrcconf.h>
 #endif
@@ -46,9 +82,245 @@ LOG_MODULE_REGISTER(esb_ptx, CONFIG_ESB_PTX_APP_LOG_LEVEL);
 
 static bool ready = true;
 static struct esb_payload rx_payload;
+
+/* Stream content and raw samples per payload, main thread only. Start from
+ * Kconfig, changed by the host through Config_Packed.
+ */
+static uint8_t stream_kind = STREAM_KIND;
+static uint8_t batch_setting = 1;
+
+/*
+ * Settings change from the host. The event handler keeps the latest
+ * Config_Packed from the ACK payloads, main applies it once per id and
+ * answers every copy with a status payload, since the dongle repeats it
+ * until one of those gets through.
+ */
+static Config_Packed config_rx;
+static bool config_rx_new;
+static struct k_spinlock config_lock;
+static Glove_StatusPacked config_status;
+static bool config_applied;     /* config_status.id is meaningful */
+
+/* Radio counters, logged and reset with the IMU timing */
+struct tx_stats {
+	uint32_t written;     /* payloads handed to ESB */
+	uint32_t success;     /* TX_SUCCESS events */
+	uint32_t failed;      /* TX_FAILED events, payload dropped */
+	uint32_t retransmits; /* attempts beyond the first, both outcomes */
+	uint32_t aged_out;    /* queued payloads dropped for being too old */
+	uint32_t superseded;  /* queued payloads dropped for a newer one */
+	uint32_t write_errors;
+	uint32_t skipped;     /* fresh samples left out of a payload */
+};
+
+static struct tx_stats tx_stats;
+static struct k_spinlock tx_lock;
+
+#ifdef CONFIG_IMU_TX_LINK_ADAPT
+static struct link_ctrl link;
+#endif
+
 static struct esb_payload tx_payload = ESB_CREATE_PAYLOAD(0,
 	0x01, 0x00, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08);
 
+/* TX_SUCCESS for this payload: the dongle has its button edges */
+static void ack_button_edges(const struct esb_payload *payload)
+{
+	uint8_t seq;
+
+	if (wire_payload_last_edge(payload->data, payload->length, &seq)) {
+		button_edges_acked(seq);
+	}
+}
+
+#ifdef CONFIG_IMU_TX_PIPELINED
+/*
+ * Payloads waiting for the radio, oldest first. The head is the one ESB is
+ * sending; ESB runs in manual start mode and only ever holds that one, so
+ * the event handler can drop stale entries before starting the next packet
+ * without a round trip through main.
+ */
+struct tx_entry {
+	struct esb_payload payload;
+	uint32_t t_ms;  /* when main queued it */
+};
+
+static struct tx_entry tx_queue[CONFIG_IMU_TX_QUEUE_DEPTH];
+static uint8_t tx_head;
+static uint8_t tx_count;
+static bool tx_busy;   /* head has been handed to ESB */
+
+/* Retransmit settings for tx_kick() to apply while the radio is idle */
+static uint16_t tx_retransmit_delay = TX_RETRANSMIT_DELAY_US;
+static uint8_t tx_retransmit_count = TX_RETRANSMIT_COUNT;
+static uint16_t tx_applied_delay = TX_RETRANSMIT_DELAY_US;
+static uint8_t tx_applied_count = TX_RETRANSMIT_COUNT;
+
+#ifdef CONFIG_IMU_TX_TDMA
+/*
+ * Once the dongle's beacons have placed our slot, payloads wait in the
+ * queue for slot_timer instead of going out as soon as they are queued.
+ * Without beacons (dongle not heard yet, or lost) the glove sends
+ * unslotted so it can get the ACK that carries the next beacon.
+ */
+static struct tdma tdma;
+static struct k_timer slot_timer;
+static int64_t slot_end_us;
+static int64_t tx_done_us[2];   /* last two packets finished, newest first */
+static uint32_t tdma_slots;
+static uint32_t tdma_slots_idle;
+
+static int64_t uptime_us(void)
+{
+	return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static bool tx_slotted(void)
+{
+	return tdma.synced;
+}
+#else
+static bool tx_slotted(void)
+{
+	return false;
+}
+#endif
+
+static struct tx_entry *tx_at(uint8_t i)
+{
+	return &tx_queue[(tx_head + i) % CONFIG_IMU_TX_QUEUE_DEPTH];
+}
+
+static void tx_drop_head(void)
+{
+	tx_head = (tx_head + 1) % CONFIG_IMU_TX_QUEUE_DEPTH;
+	tx_count--;
+}
+
+/* Start the next fresh payload. Called with tx_lock held, radio idle. */
+static void tx_kick(void)
+{
+	uint32_t now = k_uptime_get_32();
+
+	while (tx_count > 0 && now - tx_at(0)->t_ms > CONFIG_IMU_TX_MAX_AGE_MS) {
+		tx_drop_head();
+		tx_stats.aged_out++;
+	}
+	if (tx_count == 0) {
+		return;
+	}
+
+	uint8_t count = tx_retransmit_count;
+
+#ifdef CONFIG_IMU_TX_TDMA
+	if (tdma.synced) {
+		count = MIN(count, tdma_max_retransmits(&tdma, tx_retransmit_delay));
+	}
+#endif
+	if (tx_retransmit_delay != tx_applied_delay) {
+		(void)esb_set_retransmit_delay(tx_retransmit_delay);
+		tx_applied_delay = tx_retransmit_delay;
+	}
+	if (count != tx_applied_count) {
+		(void)esb_set_retransmit_count(count);
+		tx_applied_count = count;
+	}
+
+	if (esb_write_payload(&tx_at(0)->payload) != 0) {
+		tx_stats.write_errors++;
+		tx_drop_head();
+		return;
+	}
+	tx_stats.written++;
+	tx_busy = true;
+	(void)esb_start_tx();
+}
+
+/* Radio finished with the head, one way or the other */
+static void tx_done(bool success, uint32_t attempts)
+{
+	K_SPINLOCK(&tx_lock) {
+		if (success) {
+			tx_stats.success++;
+			ack_button_edges(&tx_at(0)->payload);
+		} else {
+			tx_stats.failed++;
+			// A failed payload is left in the ESB FIFO
+			esb_flush_tx();
+		}
+		tx_stats.retransmits += attempts - 1;
+		tx_busy = false;
+		tx_drop_head();
+
+#ifdef CONFIG_IMU_TX_TDMA
+		int64_t now = uptime_us();
+
+		tx_done_us[1] = tx_done_us[0];
+		tx_done_us[0] = now;
+		if (tdma.synced) {
+			// Another packet only if it cannot run past the end of the slot
+			uint32_t worst = (tx_applied_count + 1) * tx_applied_delay;
+
+			if (now + worst < slot_end_us) {
+				tx_kick();
+			}
+			K_SPINLOCK_BREAK;
+		}
+#endif
+		tx_kick();
+	}
+}
+
+#ifdef CONFIG_IMU_TX_TDMA
+static void slot_timer_fn(struct k_timer *timer)
+{
+	K_SPINLOCK(&tx_lock) {
+		int64_t now = uptime_us();
+
+		if (!tdma_on_slot(&tdma, now)) {
+			// Dongle gone quiet, back to sending as soon as queued
+			if (!tx_busy) {
+				tx_kick();
+			}
+			K_SPINLOCK_BREAK;
+		}
+		k_timer_start(timer, K_USEC(tdma.next_slot_us - now), K_NO_WAIT);
+
+		slot_end_us = now + tdma.slot_us;
+		tdma_slots++;
+		if (tx_count == 0) {
+			tdma_slots_idle++;
+		} else if (!tx_busy) {
+			tx_kick();
+		}
+	}
+}
+
+static void tdma_beacon(const Beacon_Packed *b)
+{
+	K_SPINLOCK(&tx_lock) {
+		int64_t now = uptime_us();
+
+		// The beacon measured the packet before the one just acked
+		if (tx_done_us[1] == 0) {
+			K_SPINLOCK_BREAK;
+		}
+		if (tdma_on_beacon(&tdma, b, tx_done_us[1], now)) {
+			k_timer_start(&slot_timer, K_USEC(tdma.next_slot_us - now), K_NO_WAIT);
+		}
+	}
+}
+#endif
+#endif
+
+static void config_received(const uint8_t *data)
+{
+	K_SPINLOCK(&config_lock) {
+		memcpy(&config_rx, data, sizeof(config_rx));
+		config_rx_new = true;
+	}
+}
+
 #define _RADIO_SHORTS_COMMON                                                   \
 	(RADIO_SHORTS_READY_START_Msk | RADIO_SHORTS_END_DISABLE_Msk |         \
 	 RADIO_SHORTS_ADDRESS_RSSISTART_Msk |                                  \
@@ -72,14 +344,46 @@ void event_handler(struct esb_evt const *event)
 	switch (event->evt_id) {
 	case ESB_EVENT_TX_SUCCESS:
 		//LOG_DBG("TX SUCCESS EVENT");
+#ifdef CONFIG_IMU_TX_PIPELINED
+		tx_done(true, event->tx_attempts);
+#else
+		K_SPINLOCK(&tx_lock) {
+			tx_stats.success++;
+			tx_stats.retransmits += event->tx_attempts - 1;
+		}
+		ack_button_edges(&tx_payload);
+#endif
 		leds_update(tx_payload.data[1]);
 		break;
 	case ESB_EVENT_TX_FAILED:
 		LOG_DBG("TX FAILED EVENT");
+#ifdef CONFIG_IMU_TX_PIPELINED
+		tx_done(false, event->tx_attempts);
+#else
+		K_SPINLOCK(&tx_lock) {
+			tx_stats.failed++;
+			tx_stats.retransmits += event->tx_attempts - 1;
+		}
+#endif
 		dk_set_leds(0);
 		break;
 	case ESB_EVENT_RX_RECEIVED:
 		while (esb_read_rx_payload(&rx_payload) == 0) {
+#ifdef CONFIG_IMU_TX_TDMA
+			if (rx_payload.length >= (int)sizeof(Beacon_Packed) &&
+			    rx_payload.data[0] == ACK_KIND_BEACON) {
+				Beacon_Packed beacon;
+
+				memcpy(&beacon, rx_payload.data, sizeof(beacon));
+				tdma_beacon(&beacon);
+				continue;
+			}
+#endif
+			if (rx_payload.length >= (int)sizeof(Config_Packed) &&
+			    rx_payload.data[0] == ACK_KIND_CONFIG) {
+				config_received(rx_payload.data);
+				continue;
+			}
 			LOG_DBG("Packet received, len %d : "
 				"0x%02x, 0x%02x, 0x%02x, 0x%02x, "
 				"0x%02x, 0x%02x, 0x%02x, 0x%02x",
@@ -93,6 +397,368 @@ void event_handler(struct esb_evt const *event)
 	}
 }
 
+static void build_sample_payload(const struct imu_sample *sample, bool button)
+{
+#ifdef CONFIG_IMU_TX_AHRS
+	const AHRS_DataPacked *ahrs = &sample->ahrs;
+#else
+	const AHRS_DataPacked *ahrs = NULL;     /* stream_kind is RAW */
+#endif
+
+	tx_payload.length = wire_sample_payload(tx_payload.data, stream_kind, button,
+						&sample->imu, ahrs);
+}
+
+#if TX_BATCH_MAX > 1
+/* The last n samples from recent[], oldest first */
+static void build_batch_payload(const struct imu_sample *recent, uint8_t n, bool button)
+{
+	const void *imu[TX_BATCH_MAX];
+
+	for (uint8_t i = 0; i < n; i++) {
+		imu[i] = &recent[TX_BATCH_MAX - n + i].imu;
+	}
+	tx_payload.length = wire_batch_payload(tx_payload.data, button, imu, n);
+}
+#endif
+
+static void build_status_payload(const Glove_StatusPacked *st)
+{
+	tx_payload.length = wire_status_payload(tx_payload.data, st);
+}
+
+/* Unacked button edges go on every payload until one carrying them is acked */
+static void append_button_edges(void)
+{
+	Button_EdgePacked edges[BUTTON_EDGES_MAX];
+	uint8_t n = button_pending_edges(edges, BUTTON_EDGES_MAX);
+	uint8_t added;
+
+	if (n > 0) {
+		tx_payload.length = wire_append_edges(tx_payload.data, tx_payload.length,
+						      CONFIG_ESB_MAX_PAYLOAD_LENGTH, edges, n,
+						      button_clock_us(), &added);
+	}
+}
+
+#ifdef CONFIG_IMU_TX_GESTURE
+static void build_event_payload(const Gesture_EventPacked *ev, bool button)
+{
+	tx_payload.length = wire_event_payload(tx_payload.data, button, ev);
+}
+#endif
+
+#ifdef CONFIG_IMU_TX_PIPELINED
+/* The queue never refuses a payload, it makes room instead */
+static bool tx_slot_free(void)
+{
+	return true;
+}
+
+/*
+ * Queue tx_payload behind whatever is in flight. When the queue is full the
+ * oldest entry that has not reached the radio yet makes way, so a burst of
+ * retries delays the stream but never stops fresh samples getting queued.
+ */
+static int tx_send(void)
+{
+	K_SPINLOCK(&tx_lock) {
+		if (tx_count == CONFIG_IMU_TX_QUEUE_DEPTH) {
+			uint8_t first = tx_busy ? 1 : 0;
+
+			for (uint8_t i = first; i + 1 < tx_count; i++) {
+				*tx_at(i) = *tx_at(i + 1);
+			}
+			tx_count--;
+			tx_stats.superseded++;
+		}
+
+		struct tx_entry *e = tx_at(tx_count);
+
+		e->payload = tx_payload;
+		e->t_ms = k_uptime_get_32();
+		tx_count++;
+
+		if (!tx_busy && !tx_slotted()) {
+			tx_kick();
+		}
+	}
+	return 0;
+}
+#else
+static bool tx_slot_free(void)
+{
+	return ready;
+}
+
+/* One payload at a time, anything still retrying is thrown away */
+static int tx_send(void)
+{
+	int err;
+
+	ready = false;
+	esb_flush_tx();
+
+	err = esb_write_payload(&tx_payload);
+	K_SPINLOCK(&tx_lock) {
+		if (err) {
+			tx_stats.write_errors++;
+		} else {
+			tx_stats.written++;
+		}
+	}
+	return err;
+}
+#endif
+
+static void tx_count_skipped(uint32_t n)
+{
+	K_SPINLOCK(&tx_lock) {
+		tx_stats.skipped += n;
+	}
+}
+
+static void tx_stats_get(struct tx_stats *out)
+{
+	K_SPINLOCK(&tx_lock) {
+		*out = tx_stats;
+	}
+}
+
+/* Log the radio counters since the last call */
+static void log_tx_stats(void)
+{
+	static struct tx_stats last;
+	struct tx_stats s;
+
+	tx_stats_get(&s);
+	LOG_INF("TX written %u ok %u failed %u retransmits %u aged out %u "
+		"superseded %u write errors %u, samples skipped %u",
+		s.written - last.written, s.success - last.success,
+		s.failed - last.failed, s.retransmits - last.retransmits,
+		s.aged_out - last.aged_out, s.superseded - last.superseded,
+		s.write_errors - last.write_errors, s.skipped - last.skipped);
+	last = s;
+
+#ifdef CONFIG_IMU_TX_TDMA
+	struct tdma t;
+	uint32_t slots, idle;
+
+	K_SPINLOCK(&tx_lock) {
+		t = tdma;
+		slots = tdma_slots;
+		idle = tdma_slots_idle;
+		tdma_slots = 0;
+		tdma_slots_idle = 0;
+	}
+	LOG_INF("TDMA %s slot %u/%u, %u slots (%u idle), beacons %u, syncs %u, losses %u",
+		t.synced ? "synced" : "unsynced", t.slot, t.n_slots, slots, idle,
+		t.beacons, t.syncs, t.losses);
+#endif
+}
+
+#ifdef CONFIG_IMU_TX_LINK_ADAPT
+/* Bytes one sample takes in a payload of this kind */
+static uint8_t stream_sample_bytes(uint8_t kind)
+{
+	switch (kind) {
+	case PAYLOAD_KIND_AHRS:
+		return sizeof(AHRS_DataPacked);
+	case PAYLOAD_KIND_RAW_AHRS:
+		return sizeof(IMU_DataPacked) + sizeof(AHRS_DataPacked);
+	default:
+		return sizeof(IMU_DataPacked);
+	}
+}
+
+/* The current settings become where the controller starts and relaxes to */
+static void link_rehome(void)
+{
+	bool raw = stream_kind == PAYLOAD_KIND_RAW;
+
+	link.cfg.sample_bytes = stream_sample_bytes(stream_kind);
+	link.cfg.batch_max = raw ? TX_BATCH_MAX : 1;
+	link.home.odr_hz = imu_get_odr();
+	link.home.batch = raw ? batch_setting : 1;
+	link.params.odr_hz = link.home.odr_hz;
+	link.params.batch = link.home.batch;
+	link.calm = 0;
+}
+
+static void link_init(void)
+{
+	struct link_ctrl_config cfg;
+	struct link_params start = {
+		.retransmit_delay_us = TX_RETRANSMIT_DELAY_US,
+		.retransmit_count = TX_RETRANSMIT_COUNT,
+		.batch = 1,
+		.odr_hz = imu_get_odr(),
+	};
+
+	link_ctrl_default_config(&cfg);
+	cfg.latency_target_us = CONFIG_IMU_TX_LATENCY_TARGET_MS * 1000u;
+	cfg.sample_bytes = sizeof(IMU_DataPacked);
+	cfg.batch_max = TX_BATCH_MAX;
+	link_ctrl_init(&link, &cfg, &start);
+	link_rehome();
+}
+
+/* Feed the last period's radio counters to the controller and apply */
+static void link_step(void)
+{
+	static struct tx_stats last;
+	struct tx_stats s;
+	struct link_window w;
+
+	tx_stats_get(&s);
+	w.success = s.success - last.success;
+	w.failed = s.failed - last.failed;
+	w.retransmits = s.retransmits - last.retransmits;
+	w.dropped = (s.aged_out - last.aged_out) + (s.superseded - last.superseded);
+	last = s;
+
+	struct link_params prev = link.params;
+
+	if (!link_ctrl_update(&link, &w)) {
+		return;
+	}
+
+	const struct link_params *p = &link.params;
+
+	// The latency bound was worked out for this rate: keep nothing else if
+	// the sensor will not take it
+	if (p->odr_hz != imu_get_odr() && imu_set_odr(p->odr_hz) != 0) {
+		LOG_WRN("Link: sensor refused %u Hz, keeping %u Hz", p->odr_hz, prev.odr_hz);
+		link.params = prev;
+		return;
+	}
+	K_SPINLOCK(&tx_lock) {
+		tx_retransmit_delay = p->retransmit_delay_us;
+		tx_retransmit_count = p->retransmit_count;
+	}
+	LOG_INF("Link: retransmit delay %u us count %u, batch %u, ODR %u Hz",
+		p->retransmit_delay_us, p->retransmit_count, p->batch, p->odr_hz);
+}
+
+static inline uint8_t tx_batch(void)
+{
+	return stream_kind == PAYLOAD_KIND_RAW ? link.params.batch : 1;
+}
+#else
+static inline uint8_t tx_batch(void)
+{
+	return stream_kind == PAYLOAD_KIND_RAW ? batch_setting : 1;
+}
+#endif
+
+static bool stream_supported(uint8_t kind)
+{
+	switch (kind) {
+	case PAYLOAD_KIND_RAW:
+		return true;
+	case PAYLOAD_KIND_AHRS:
+	case PAYLOAD_KIND_RAW_AHRS:
+		return IS_ENABLED(CONFIG_IMU_TX_AHRS);
+	default:
+		return false;
+	}
+}
+
+static void config_apply(const Config_Packed *c)
+{
+	Glove_SettingsPacked s = c->settings;
+	uint8_t rejected = 0;
+
+	if ((c->fields & CONFIG_FIELD_ODR) && imu_set_odr(s.odr_hz) != 0) {
+		rejected |= CONFIG_FIELD_ODR;
+	}
+	if ((c->fields & CONFIG_FIELD_ACCEL_FS) && imu_set_accel_fs(s.accel_fs_g) != 0) {
+		rejected |= CONFIG_FIELD_ACCEL_FS;
+	}
+	if ((c->fields & CONFIG_FIELD_GYRO_FS) && imu_set_gyro_fs(s.gyro_fs_dps) != 0) {
+		rejected |= CONFIG_FIELD_GYRO_FS;
+	}
+	if (c->fields & CONFIG_FIELD_BATCH) {
+		// Slash detection sends one sample or event per payload
+		if (!IS_ENABLED(CONFIG_IMU_TX_GESTURE) && s.batch >= 1 && s.batch <= TX_BATCH_MAX) {
+			batch_setting = s.batch;
+		} else {
+			rejected |= CONFIG_FIELD_BATCH;
+		}
+	}
+	if (c->fields & CONFIG_FIELD_STREAM) {
+		if (stream_supported(s.stream)) {
+			stream_kind = s.stream;
+		} else {
+			rejected |= CONFIG_FIELD_STREAM;
+		}
+	}
+#ifdef CONFIG_IMU_TX_LINK_ADAPT
+	link_rehome();
+#endif
+
+	config_status.id = c->id;
+	config_status.rejected = rejected;
+	config_status.settings.odr_hz = imu_get_odr();
+	config_status.settings.accel_fs_g = imu_get_accel_fs();
+	config_status.settings.gyro_fs_dps = imu_get_gyro_fs();
+	config_status.settings.batch = batch_setting;
+	config_status.settings.stream = stream_kind;
+	config_applied = true;
+
+	LOG_INF("Config %u: ODR %u Hz, %u g, %u dps, batch %u, stream %u, rejected 0x%02x",
+		c->id, imu_get_odr(), imu_get_accel_fs(), imu_get_gyro_fs(),
+		batch_setting, stream_kind, rejected);
+}
+
+/* Apply a newly received config. Returns true if a status payload is owed. */
+static bool config_poll(void)
+{
+	Config_Packed c;
+	bool got = false;
+
+	K_SPINLOCK(&config_lock) {
+		if (config_rx_new) {
+			c = config_rx;
+			config_rx_new = false;
+			got = true;
+		}
+	}
+	if (!got) {
+		return false;
+	}
+
+	// A repeat of one already applied only needs answering again
+	if (!config_applied || c.id != config_status.id) {
+		config_apply(&c);
+	}
+	return true;
+}
+
+/* Log and reset the acquisition thread stage counters */
+static void log_imu_timing(void)
+{
+	struct imu_timing t;
+
+	imu_get_timing(&t, true);
+	if (t.irq_to_thread.count == 0) {
+		LOG_WRN("No IMU samples in the last period");
+		return;
+	}
+
+	LOG_INF("IMU %u samples, irq->thread us min %u avg %u max %u, "
+		"thread->ready us min %u avg %u max %u, overruns %u, irqs missed %u",
+		t.irq_to_thread.count,
+		t.irq_to_thread.min_us,
+		(uint32_t)(t.irq_to_thread.sum_us / t.irq_to_thread.count),
+		t.irq_to_thread.max_us,
+		t.thread_to_ready.min_us,
+		(uint32_t)(t.thread_to_ready.sum_us / t.thread_to_ready.count),
+		t.thread_to_ready.max_us,
+		t.ring_overruns,
+		t.irq_overwrites);
+}
+
 #if defined(CONFIG_CLOCK_CONTROL_NRF)
 int clocks_start(void)
 {
@@ -187,12 +853,16 @@ int esb_initialize(void)
 	struct esb_config config = ESB_DEFAULT_CONFIG;
 
 	config.protocol = ESB_PROTOCOL_ESB_DPL;
-	config.retransmit_delay = 600;
+	config.retransmit_delay = TX_RETRANSMIT_DELAY_US;
+	config.retransmit_count = TX_RETRANSMIT_COUNT;
 	config.bitrate = ESB_BITRATE_2MBPS;
 	config.payload_length = 48;
 	config.event_handler = event_handler;
 	config.mode = ESB_MODE_PTX;
 	config.selective_auto_ack = true;
+#ifdef CONFIG_IMU_TX_PIPELINED
+	config.tx_mode = ESB_TXMODE_MANUAL_START;
+#endif
 	if (IS_ENABLED(CONFIG_ESB_FAST_SWITCHING)) {
 		config.use_fast_ramp_up = true;
 	}
@@ -259,15 +929,74 @@ int main(void)
 		return 0;
 	}
 
+#ifdef CONFIG_IMU_TX_TDMA
+	tdma_init(&tdma, CONFIG_IMU_TX_TDMA_TIMEOUT_FRAMES);
+	k_timer_init(&slot_timer, slot_timer_fn, NULL);
+#endif
+
+#ifdef CONFIG_IMU_TX_LINK_ADAPT
+	link_init();
+	uint32_t last_link = k_uptime_get_32();
+#endif
+
 	LOG_INF("Initialization complete");
 	LOG_INF("Sending test packet");
 
+	struct imu_sample sample;
+	struct imu_sample recent[TX_BATCH_MAX];	// newest last
+	uint32_t fresh = 0;	// samples read since the last raw payload
+	uint32_t last_report = k_uptime_get_32();
+	bool status_due = false;
+
 	tx_payload.noack = false;
 	while (1) {
-		if (ready) {
-			IMU_DataPacked sensor_data = get_packed_imu_data();
+		// Wake on a new sample, or after 1 ms to pick up a finished TX
+		(void)imu_wait_sample(K_MSEC(1));
+		while (imu_pop_sample(&sample) == 0) {
+			memmove(&recent[0], &recent[1], sizeof(recent) - sizeof(recent[0]));
+			recent[TX_BATCH_MAX - 1] = sample;
+			fresh++;
+		}
 
-			
+#ifdef CONFIG_IMU_TX_LINK_ADAPT
+		if (k_uptime_get_32() - last_link >= CONFIG_IMU_TX_LINK_PERIOD_MS) {
+			last_link = k_uptime_get_32();
+			link_step();
+		}
+#endif
+
+		if (k_uptime_get_32() - last_report >= IMU_TIMING_REPORT_MS) {
+			last_report = k_uptime_get_32();
+			log_imu_timing();
+			log_tx_stats();
+		}
+
+		status_due |= config_poll();
+
+		if (tx_slot_free()) {
+			if (status_due) {
+				tx_payload.pipe = TRANSMITTER_PIPE;
+				build_status_payload(&config_status);
+				status_due = false;
+				err = tx_send();
+				if (err) {
+					LOG_ERR("Status payload write failed, err %d", err);
+				}
+				continue;
+			}
+#ifdef CONFIG_IMU_TX_GESTURE
+			Gesture_EventPacked ev;
+			bool have_event = imu_get_gesture(&ev) == 0;
+
+			// Between slashes only every Nth sensor sample goes out
+			if (!have_event && fresh < CONFIG_IMU_TX_RAW_DECIMATION) {
+				continue;
+			}
+#else
+			if (fresh < tx_batch()) {
+				continue;
+			}
+#endif
 			tx_payload.pipe = TRANSMITTER_PIPE;
 			// tx_payload.length = 192;
 			// tx_payload.noack = 0;
@@ -293,27 +1022,37 @@ int main(void)
 
 			_Static_assert(sizeof(IMU_DataPacked) == 6 * sizeof(float), "IMU_DataPacked size unexpected");
 
-			tx_payload.data[0] = button_pressed_flag ? 1 : 0;
-			if(button_pressed_flag){
-				printf("\nButton pressed");
+			// Edges go in the trailer; the header bit is the state now
+			bool button = button_is_pressed();
+
+#ifdef CONFIG_IMU_TX_GESTURE
+			if (have_event) {
+				build_event_payload(&ev, button);
+			} else {
+				build_sample_payload(&sample, button);
+				fresh = 0;
+			}
+#elif TX_BATCH_MAX > 1
+			// Also what built up while the slot was held, up to a full payload
+			uint8_t n = stream_kind == PAYLOAD_KIND_RAW ? MIN(fresh, TX_BATCH_MAX) : 1;
+
+			if (n > 1) {
+				build_batch_payload(recent, n, button);
+			} else {
+				build_sample_payload(&sample, button);
 			}
-            // Optionally clear the flag after sampling:
-            button_pressed_flag = false;
-
-			size_t imu_bytes = sizeof(sensor_data);
-            if (imu_bytes + 1 > sizeof(tx_payload.data)) {
-                imu_bytes = sizeof(tx_payload.data) - 1;
-            }
-            memcpy(&tx_payload.data[1], &sensor_data, imu_bytes);
-            tx_payload.length = 1 + imu_bytes;
+			tx_count_skipped(fresh - n);
+			fresh = 0;
+#else
+			build_sample_payload(&sample, button);
+			tx_count_skipped(fresh - 1);
+			fresh = 0;
+#endif
+			append_button_edges();
 			
 			//LOG_HEXDUMP_DBG(tx_payload.data, tx_payload.length, "tx payload");
 
-			ready = false;
-			esb_flush_tx();
-			
-
-			err = esb_write_payload(&tx_payload);
+			err = tx_send();
 			if (err) {
 				LOG_ERR("Payload write failed, err %d", err);
 			} else {
@@ -325,6 +1064,5 @@ int main(void)
 			}
 			//tx_payload.data[1]++;
 		}
-		k_sleep(K_MSEC(1));
 	}
 }
@@ -0,0 +1,104 @@
+/*
+ * Glove side of the dongle's TDMA superframe.
+ *
+ * The first beacon places the slot directly. After that each beacon only
+ * moves it half way: the beacon describes the packet before last, which was
+ * sent before the previous correction took effect, and a full step would
+ * overshoot and oscillate.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include "tdma.h"
+
+#include <string.h>
+
+void tdma_init(struct tdma *t, uint32_t timeout_frames)
+{
+	memset(t, 0, sizeof(*t));
+	t->timeout_frames = timeout_frames;
+}
+
+/* Wrap into [-period/2, period/2) */
+static int64_t wrap(int64_t v, int64_t period)
+{
+	v %= period;
+	if (v >= period / 2) {
+		v -= period;
+	} else if (v < -period / 2) {
+		v += period;
+	}
+	return v;
+}
+
+bool tdma_on_beacon(struct tdma *t, const Beacon_Packed *b,
+		    int64_t prev_done_us, int64_t now_us)
+{
+	if (b->n_slots == 0 || b->slot_us == 0) {
+		return false;
+	}
+
+	t->beacons++;
+	t->last_beacon_us = now_us;
+
+	if (b->slot != t->slot || b->n_slots != t->n_slots || b->slot_us != t->slot_us) {
+		/* New or changed layout, start over */
+		t->synced = false;
+	}
+	t->slot = b->slot;
+	t->n_slots = b->n_slots;
+	t->slot_us = b->slot_us;
+	t->guard_us = b->guard_us;
+	t->superframe_us = (uint32_t)b->n_slots * b->slot_us;
+
+	int64_t period = t->superframe_us;
+	/* Where our slot started, in glove time, for the measured packet */
+	int64_t ideal = prev_done_us - b->offset_us - b->guard_us;
+
+	ideal += ((now_us - ideal) / period + 1) * period;
+
+	if (!t->synced) {
+		t->next_slot_us = ideal;
+		t->synced = true;
+		t->syncs++;
+		return true;
+	}
+
+	int64_t err = wrap(t->next_slot_us - ideal, period);
+
+	if (err / 2 == 0) {
+		return false;
+	}
+	t->next_slot_us -= err / 2;
+	while (t->next_slot_us <= now_us) {
+		t->next_slot_us += period;
+	}
+	return true;
+}
+
+bool tdma_on_slot(struct tdma *t, int64_t now_us)
+{
+	if (!t->synced) {
+		return false;
+	}
+	if (now_us - t->last_beacon_us > (int64_t)t->timeout_frames * t->superframe_us) {
+		t->synced = false;
+		t->losses++;
+		return false;
+	}
+	/* The timer may fire a tick early; that is still this slot */
+	while (t->next_slot_us <= now_us + t->slot_us / 2) {
+		t->next_slot_us += t->superframe_us;
+	}
+	return true;
+}
+
+uint8_t tdma_max_retransmits(const struct tdma *t, uint16_t retransmit_delay_us)
+{
+	uint32_t attempts;
+
+	if (retransmit_delay_us == 0 || t->slot_us <= t->guard_us) {
+		return 0;
+	}
+	attempts = (t->slot_us - t->guard_us) / retransmit_delay_us;
+	return attempts > 1 ? (uint8_t)(attempts - 1) : 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * Glove side of the dongle's TDMA superframe.
+ *
+ * The dongle reports in every ACK payload how far the glove's previous
+ * packet landed from its slot; tdma_on_beacon() turns that into the time
+ * the glove should next start transmitting. Times are glove uptime in us.
+ *
+ * Plain C with no Zephyr dependencies so the same code runs in the Linux
+ * host build (see microcontroller/host).
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef _TDMA_H_
+#define _TDMA_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "glove_proto.h"
+
+struct tdma {
+	bool synced;
+	uint8_t slot;
+	uint8_t n_slots;
+	uint16_t slot_us;
+	uint16_t guard_us;
+	uint32_t superframe_us;
+	int64_t next_slot_us;     /* start of our next slot */
+	int64_t last_beacon_us;
+	uint32_t timeout_frames;  /* superframes without a beacon before giving up */
+
+	uint32_t beacons;
+	uint32_t syncs;           /* unsynced -> synced */
+	uint32_t losses;          /* synced -> unsynced */
+};
+
+void tdma_init(struct tdma *t, uint32_t timeout_frames);
+
+/* A beacon arrived with the ACK of a packet. prev_done_us is when the packet
+ * before that one finished, which is the one the beacon measured. Returns
+ * true if next_slot_us moved.
+ */
+bool tdma_on_beacon(struct tdma *t, const Beacon_Packed *b,
+		    int64_t prev_done_us, int64_t now_us);
+
+/* Our slot has started. Advances next_slot_us; returns false (and drops
+ * sync) if the dongle has not been heard from for too long.
+ */
+bool tdma_on_slot(struct tdma *t, int64_t now_us);
+
+/* Retransmit count that still finishes inside the slot */
+uint8_t tdma_max_retransmits(const struct tdma *t, uint16_t retransmit_delay_us);
+
+#endif
@@ -0,0 +1,75 @@
+# bench_video.py
+#
+# Times vision.py's CameraTracker against fast_vision.py's FastCameraTracker
+# on a recorded clip. The clip is decoded into memory first so only the
+# tracking is timed. One line per tracker, then how well they agree:
+#   method,isa,frames,fps,p50_us,p99_us,found
+#   agree,both_found,only_one,mean_px,max_px
+# px are in the clip's pixels, over the frames both trackers found the blob.
+#
+# Usage: python3 bench_video.py video.mp4 [-color green] [-frames n]
+import argparse
+import os
+import sys
+import time
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             "..", "testFinalProject"))
+
+import numpy as np                          # noqa: E402
+from vision import CameraTracker            # noqa: E402
+from fast_vision import FastCameraTracker   # noqa: E402
+
+
+def run(name, isa, tracker, frames, color):
+    us = []
+    results = []
+    for frame in frames:
+        t0 = time.perf_counter()
+        results.append(tracker.find(frame, color))
+        us.append((time.perf_counter() - t0) * 1e6)
+
+    us = np.array(us)
+    found = sum(r.valid for r in results)
+    print("%s,%s,%d,%.0f,%.1f,%.1f,%d" % (name, isa, len(frames), len(frames) / (us.sum() * 1e-6),
+                                         np.percentile(us, 50), np.percentile(us, 99), found))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("video")
+    parser.add_argument("-color", default="green")
+    parser.add_argument("-frames", type=int, default=0, help="0 for the whole clip")
+    args = parser.parse_args()
+
+    # VideoCapture takes a file name as well as a camera number
+    slow = CameraTracker(camera_id=args.video)
+    fast = FastCameraTracker(camera_id=args.video)
+
+    frames = []
+    while args.frames <= 0 or len(frames) < args.frames:
+        success, frame = slow.cap.read()
+        if not success:
+            break
+        frames.append(frame)
+    if not frames:
+        sys.exit(f"no frames in {args.video}")
+    h, w, _ = frames[0].shape
+
+    print("method,isa,frames,fps,p50_us,p99_us,found")
+    a = run("opencv", "-", slow, frames, args.color)
+    b = run("blobtrack", fast.isa(), fast, frames, args.color)
+
+    d = [np.hypot((p.x - q.x) * w, (p.y - q.y) * h) for p, q in zip(a, b) if p.valid and q.valid]
+    only_one = sum(p.valid != q.valid for p, q in zip(a, b))
+    print("agree,both_found,only_one,mean_px,max_px")
+    print("agree,%d,%d,%.2f,%.2f" % (len(d), only_one, np.mean(d) if d else 0, max(d, default=0)))
+
+    # Not close(): it tears down HighGUI windows, missing in headless OpenCV
+    slow.cap.release()
+    fast.close()
+
+
+if __name__ == "__main__":
+    main()
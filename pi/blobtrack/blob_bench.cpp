@@ -0,0 +1,262 @@
+/*
+ * Blob tracker benchmark on synthetic frames, so it runs without a camera or
+ * OpenCV. bench_video.py does the same on recorded clips against
+ * CameraTracker.
+ *
+ * The clip is a green disc moving over a noisy background with a red
+ * distractor, leaving the frame for a while so the coarse search runs.
+ * Output, one line per method:
+ *   method,isa,frames,fps,p50_us,p99_us,found,false_pos,err_px
+ * "full_scalar" and "full_simd" threshold the whole frame, "tracker" is
+ * BlobTracker with its window and coarse search. err_px is the mean
+ * distance from the true centre while the disc is in frame, false_pos the
+ * frames without it where something was found anyway.
+ *
+ * -check also compares the SIMD kernel with the scalar one on random
+ * pixels for several ranges (counts and column sums must match exactly)
+ * and fails if the tracker misses the disc, finds it when it is not there or
+ * is off by over CHECK_ERR_PX.
+ *
+ * Usage: blob_bench [-size w h] [-frames n] [-check]
+ *
+ * Created by Robbie Leslie 2025
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "blob_tracker.hpp"
+
+using namespace blobtrack;
+
+static const float CHECK_ERR_PX = 1.0f;
+static const int DISC_RADIUS = 14;
+
+static const HsvRange GREEN = { { 40, 40, 40 }, { 80, 255, 255 } };
+
+static uint32_t rng_state = 1;
+
+static uint32_t Rand()
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+struct Clip {
+    int width, height;
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<float> true_x, true_y;     // px, -1 when out of frame
+};
+
+static void Disc(std::vector<uint8_t> &f, int w, int h, float cx, float cy, int radius,
+                 const uint8_t bgr[3])
+{
+    for (int y = (int)cy - radius; y <= (int)cy + radius; y++) {
+        for (int x = (int)cx - radius; x <= (int)cx + radius; x++) {
+            float dx = x - cx, dy = y - cy;
+
+            if (x < 0 || y < 0 || x >= w || y >= h || dx * dx + dy * dy > radius * radius) {
+                continue;
+            }
+            std::memcpy(&f[(size_t)(y * w + x) * 3], bgr, 3);
+        }
+    }
+}
+
+static Clip MakeClip(int w, int h, int count)
+{
+    static const uint8_t green[3] = { 40, 200, 60 };
+    static const uint8_t red[3] = { 30, 30, 210 };
+    Clip clip;
+
+    clip.width = w;
+    clip.height = h;
+    for (int k = 0; k < count; k++) {
+        std::vector<uint8_t> f((size_t)w * h * 3);
+        float t = k / 30.0f;
+
+        // Sensor-like noise, a few percent of it green enough to match,
+        // with the odd saturated pixel
+        for (size_t i = 0; i < f.size(); i += 3) {
+            int v = 60 + Rand() % 80;
+
+            f[i] = (uint8_t)(v + Rand() % 32);
+            f[i + 1] = (uint8_t)(v + Rand() % 32);
+            f[i + 2] = (uint8_t)(v + Rand() % 32);
+            if (Rand() % 64 == 0) {
+                f[i] = (uint8_t)Rand();
+                f[i + 1] = (uint8_t)Rand();
+                f[i + 2] = (uint8_t)Rand();
+            }
+        }
+        Disc(f, w, h, w * 0.8f, h * 0.2f, 20, red);
+
+        // Out of frame for a second out of every five
+        float cx = w * (0.5f + 0.35f * std::sin(1.3f * t));
+        float cy = h * (0.5f + 0.3f * std::sin(0.9f * t + 1.0f));
+        bool shown = std::fmod(t, 5.0f) < 4.0f;
+
+        if (shown) Disc(f, w, h, cx, cy, DISC_RADIUS, green);
+        clip.frames.push_back(std::move(f));
+        clip.true_x.push_back(shown ? cx : -1.0f);
+        clip.true_y.push_back(shown ? cy : -1.0f);
+    }
+    return clip;
+}
+
+static int CheckKernel()
+{
+    static const HsvRange ranges[] = {
+        GREEN,
+        { { 170, 100, 100 }, { 179, 255, 255 } },   // CameraTracker's red
+        { { 0, 0, 0 }, { 179, 255, 255 } },         // everything, greys too
+        { { 0, 50, 20 }, { 10, 255, 255 } },        // red below the wrap
+        { { 100, 10, 200 }, { 130, 60, 250 } },
+    };
+    std::vector<uint8_t> px(3 * 1000);
+    int bad = 0;
+
+    for (const HsvRange &range : ranges) {
+        Bounds b = MakeBounds(range);
+
+        for (int trial = 0; trial < 2000; trial++) {
+            int n = 1 + Rand() % 1000, x0 = Rand() % 2000;
+
+            for (int i = 0; i < 3 * n; i++) {
+                // Bias towards ties and greys, where the branches are
+                px[i] = (uint8_t)(Rand() % 4 == 0 ? px[i - (i % 3)] : Rand());
+            }
+            SpanSums s = ThresholdSpan(b, px.data(), x0, n);
+            SpanSums r = ThresholdSpanScalar(b, px.data(), x0, n);
+
+            if (s.count != r.count || s.sum_x != r.sum_x) bad++;
+        }
+    }
+    printf("# kernel %s vs scalar: %d mismatching spans\n", Isa(), bad);
+    return bad == 0;
+}
+
+static double Percentile(std::vector<double> v, double p)
+{
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(p * (v.size() - 1) + 0.5)];
+}
+
+enum Method { FULL_SCALAR, FULL_SIMD, TRACKER };
+
+static float Run(const Clip &clip, Method method, bool *exact)
+{
+    static const char *names[] = { "full_scalar", "full_simd", "tracker" };
+    const int w = clip.width, h = clip.height;
+    Bounds b = MakeBounds(GREEN);
+    TrackerOptions opts;
+    opts.mirror = false;
+    BlobTracker tracker(w, h, GREEN, opts);
+    std::vector<double> us;
+    double err = 0, total_us = 0;
+    int found = 0, shown = 0, missed = 0, false_pos = 0;
+
+    for (size_t k = 0; k < clip.frames.size(); k++) {
+        const uint8_t *f = clip.frames[k].data();
+        float x = 0, y = 0;
+        bool valid;
+
+        auto t0 = std::chrono::steady_clock::now();
+        if (method == TRACKER) {
+            Blob blob = tracker.Track(f, (size_t)w * 3);
+
+            valid = blob.valid;
+            x = blob.x * w;
+            y = blob.y * h;
+        } else {
+            uint64_t count = 0, sum_x = 0, sum_y = 0;
+
+            for (int row = 0; row < h; row++) {
+                const uint8_t *p = f + (size_t)row * w * 3;
+                SpanSums s = method == FULL_SIMD ? ThresholdSpan(b, p, 0, w)
+                                                 : ThresholdSpanScalar(b, p, 0, w);
+                count += s.count;
+                sum_x += s.sum_x;
+                sum_y += (uint64_t)s.count * row;
+            }
+            valid = count > 0;
+            x = valid ? (float)sum_x / count : 0;
+            y = valid ? (float)sum_y / count : 0;
+        }
+        double dt = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - t0).count();
+        us.push_back(dt);
+        total_us += dt;
+
+        if (clip.true_x[k] >= 0) {
+            shown++;
+            if (valid) {
+                found++;
+                err += std::hypot(x - clip.true_x[k], y - clip.true_y[k]);
+            } else {
+                missed++;
+            }
+        } else if (valid) {
+            false_pos++;
+        }
+    }
+
+    float mean_err = found ? (float)(err / found) : -1.0f;
+    printf("%s,%s,%zu,%.0f,%.1f,%.1f,%d/%d,%d,%.2f\n", names[method],
+           method == FULL_SCALAR ? "scalar" : Isa(), clip.frames.size(),
+           clip.frames.size() / (total_us * 1e-6), Percentile(us, 0.5),
+           Percentile(us, 0.99), found, shown, false_pos, mean_err);
+    if (exact) *exact = missed == 0 && false_pos == 0;
+    return mean_err;
+}
+
+static void Usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-size w h] [-frames n] [-check]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    int w = 320, h = 240, frames = 600;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-size") && i + 2 < argc) {
+            w = atoi(argv[++i]);
+            h = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-check")) {
+            check = true;
+        } else {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+    if (w < 64 || h < 64 || w > 32767 || frames < 1) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    bool ok = true;
+    if (check) ok = CheckKernel();
+
+    Clip clip = MakeClip(w, h, frames);
+    bool exact;
+
+    printf("method,isa,frames,fps,p50_us,p99_us,found,false_pos,err_px\n");
+    Run(clip, FULL_SCALAR, nullptr);
+    Run(clip, FULL_SIMD, nullptr);
+    float err = Run(clip, TRACKER, &exact);
+
+    if (check && (!exact || err < 0 || err > CHECK_ERR_PX)) {
+        fprintf(stderr, "check failed: tracker %s, %.2f px off\n",
+                exact ? "found the disc exactly when shown" : "missed or made up frames", err);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
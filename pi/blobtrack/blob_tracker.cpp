@@ -0,0 +1,593 @@
+// Created by Robbie Leslie 2025
+
+#include "blob_tracker.hpp"
+#include "blobtrack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <stdexcept>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define BLOB_SSSE3 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BLOB_NEON 1
+#endif
+
+namespace blobtrack {
+
+static int16_t ClampRel(int v)
+{
+    // 30 * num / delta is within +-30, so anything further out is the same
+    return (int16_t)(v < -31 ? -31 : v > 31 ? 31 : v);
+}
+
+Bounds MakeBounds(const HsvRange &range)
+{
+    static const int base[3] = { 0, 60, 120 };
+    Bounds b;
+
+    b.v_lo = range.lo[2];
+    b.v_hi = range.hi[2];
+    b.s_lo = range.lo[1];
+    b.s_hi = range.hi[1];
+    for (int k = 0; k < 3; k++) {
+        b.h_lo[k] = ClampRel(range.lo[0] - base[k]);
+        b.h_hi[k] = ClampRel(range.hi[0] - base[k]);
+    }
+    b.h_lo_wrap = ClampRel(range.lo[0] - 180);
+    b.h_hi_wrap = ClampRel(range.hi[0] - 180);
+    b.grey_ok = range.lo[0] == 0 && range.lo[1] == 0;
+    return b;
+}
+
+// The per-pixel test every path must agree with
+static bool InRange(const Bounds &b, int blue, int green, int red)
+{
+    int mx = blue > green ? blue : green;
+    int mn = blue < green ? blue : green;
+    mx = red > mx ? red : mx;
+    mn = red < mn ? red : mn;
+    int d = mx - mn;
+
+    if (mx < b.v_lo || mx > b.v_hi) return false;
+    if (d == 0) return b.grey_ok;
+
+    // S = 255 * d / mx, compared without dividing
+    if (b.s_lo * mx > 255 * d || 255 * d > b.s_hi * mx) return false;
+
+    // H = base + 30 * num / d, likewise
+    int sector, num;
+    if (red == mx) {
+        sector = 0;
+        num = green - blue;
+    } else if (green == mx) {
+        sector = 1;
+        num = blue - red;
+    } else {
+        sector = 2;
+        num = red - green;
+    }
+    int n30 = 30 * num;
+    bool in = b.h_lo[sector] * d <= n30 && n30 <= b.h_hi[sector] * d;
+    if (sector == 0) in = in || (b.h_lo_wrap * d <= n30 && n30 <= b.h_hi_wrap * d);
+    return in;
+}
+
+SpanSums ThresholdSpanScalar(const Bounds &b, const uint8_t *bgr, int x0, int n)
+{
+    SpanSums s = { 0, 0 };
+
+    for (int i = 0; i < n; i++) {
+        if (InRange(b, bgr[3 * i], bgr[3 * i + 1], bgr[3 * i + 2])) {
+            s.count++;
+            s.sum_x += (uint64_t)(x0 + i);
+        }
+    }
+    return s;
+}
+
+#if BLOB_SSSE3
+
+// pshufb masks pulling one channel of 16 BGR pixels out of each 16-byte load
+struct Shuffles {
+    __m128i m[3][3];    // [channel][load]
+
+    Shuffles()
+    {
+        for (int k = 0; k < 3; k++) {
+            for (int j = 0; j < 3; j++) {
+                alignas(16) int8_t idx[16];
+
+                for (int i = 0; i < 16; i++) {
+                    int byte = 3 * i + k - 16 * j;
+                    idx[i] = (int8_t)(byte >= 0 && byte < 16 ? byte : -128);
+                }
+                m[k][j] = _mm_load_si128((const __m128i *)idx);
+            }
+        }
+    }
+};
+
+static inline __m128i Channel(const Shuffles &sh, int k, __m128i c0, __m128i c1, __m128i c2)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, sh.m[k][0]),
+                                     _mm_shuffle_epi8(c1, sh.m[k][1])),
+                        _mm_shuffle_epi8(c2, sh.m[k][2]));
+}
+
+static inline __m128i Select(__m128i m, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+static inline __m128i LeS16(__m128i a, __m128i b)
+{
+    return _mm_xor_si128(_mm_cmpgt_epi16(a, b), _mm_set1_epi16(-1));
+}
+
+static inline __m128i LeU16(__m128i a, __m128i b)
+{
+    return _mm_cmpeq_epi16(_mm_subs_epu16(a, b), _mm_setzero_si128());
+}
+
+// Saturation and hue for 8 pixels widened to 16 bits
+static inline __m128i SatHue8(const Bounds &bd, __m128i b, __m128i g, __m128i r,
+                              __m128i mx, __m128i d, __m128i is_r, __m128i is_g)
+{
+    __m128i s255 = _mm_mullo_epi16(d, _mm_set1_epi16(255));
+    __m128i sok = _mm_and_si128(LeU16(_mm_mullo_epi16(mx, _mm_set1_epi16(bd.s_lo)), s255),
+                                LeU16(s255, _mm_mullo_epi16(mx, _mm_set1_epi16(bd.s_hi))));
+
+    __m128i num = Select(is_r, _mm_sub_epi16(g, b),
+                         Select(is_g, _mm_sub_epi16(b, r), _mm_sub_epi16(r, g)));
+    __m128i n30 = _mm_mullo_epi16(num, _mm_set1_epi16(30));
+    __m128i lo = Select(is_r, _mm_set1_epi16(bd.h_lo[0]),
+                        Select(is_g, _mm_set1_epi16(bd.h_lo[1]), _mm_set1_epi16(bd.h_lo[2])));
+    __m128i hi = Select(is_r, _mm_set1_epi16(bd.h_hi[0]),
+                        Select(is_g, _mm_set1_epi16(bd.h_hi[1]), _mm_set1_epi16(bd.h_hi[2])));
+    __m128i in = _mm_and_si128(LeS16(_mm_mullo_epi16(lo, d), n30),
+                               LeS16(n30, _mm_mullo_epi16(hi, d)));
+    __m128i wrap = _mm_and_si128(LeS16(_mm_mullo_epi16(_mm_set1_epi16(bd.h_lo_wrap), d), n30),
+                                 LeS16(n30, _mm_mullo_epi16(_mm_set1_epi16(bd.h_hi_wrap), d)));
+
+    return _mm_and_si128(sok, _mm_or_si128(in, _mm_and_si128(is_r, wrap)));
+}
+
+SpanSums ThresholdSpan(const Bounds &bd, const uint8_t *bgr, int x0, int n)
+{
+    static const Shuffles sh;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones16 = _mm_set1_epi16(1);
+    const __m128i idx_lo = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i idx_hi = _mm_setr_epi16(8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i v_lo = _mm_set1_epi8((char)bd.v_lo), v_hi = _mm_set1_epi8((char)bd.v_hi);
+    const __m128i grey = bd.grey_ok ? _mm_set1_epi8(-1) : zero;
+    __m128i count = zero, sum_x = zero;
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        const uint8_t *p = bgr + 3 * i;
+        __m128i c0 = _mm_loadu_si128((const __m128i *)p);
+        __m128i c1 = _mm_loadu_si128((const __m128i *)(p + 16));
+        __m128i c2 = _mm_loadu_si128((const __m128i *)(p + 32));
+        __m128i b = Channel(sh, 0, c0, c1, c2);
+        __m128i g = Channel(sh, 1, c0, c1, c2);
+        __m128i r = Channel(sh, 2, c0, c1, c2);
+
+        __m128i mx = _mm_max_epu8(_mm_max_epu8(b, g), r);
+        __m128i mn = _mm_min_epu8(_mm_min_epu8(b, g), r);
+        __m128i d = _mm_sub_epi8(mx, mn);
+        __m128i vok = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(mx, v_lo), mx),
+                                    _mm_cmpeq_epi8(_mm_min_epu8(mx, v_hi), mx));
+        __m128i is_r = _mm_cmpeq_epi8(r, mx);
+        __m128i is_g = _mm_andnot_si128(is_r, _mm_cmpeq_epi8(g, mx));
+        __m128i flat = _mm_cmpeq_epi8(d, zero);
+
+        __m128i lo = SatHue8(bd, _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(g, zero),
+                             _mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(mx, zero),
+                             _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(is_r, is_r),
+                             _mm_unpacklo_epi8(is_g, is_g));
+        __m128i hi = SatHue8(bd, _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(g, zero),
+                             _mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(mx, zero),
+                             _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(is_r, is_r),
+                             _mm_unpackhi_epi8(is_g, is_g));
+        __m128i m = _mm_and_si128(vok, Select(flat, grey, _mm_packs_epi16(lo, hi)));
+
+        count = _mm_add_epi64(count, _mm_sad_epu8(_mm_and_si128(m, _mm_set1_epi8(1)), zero));
+        __m128i x = _mm_set1_epi16((short)(x0 + i));
+        sum_x = _mm_add_epi32(sum_x, _mm_madd_epi16(
+            _mm_and_si128(_mm_add_epi16(x, idx_lo), _mm_unpacklo_epi8(m, m)), ones16));
+        sum_x = _mm_add_epi32(sum_x, _mm_madd_epi16(
+            _mm_and_si128(_mm_add_epi16(x, idx_hi), _mm_unpackhi_epi8(m, m)), ones16));
+    }
+
+    alignas(16) uint64_t c[2];
+    alignas(16) uint32_t sx[4];
+    _mm_store_si128((__m128i *)c, count);
+    _mm_store_si128((__m128i *)sx, sum_x);
+
+    SpanSums s = ThresholdSpanScalar(bd, bgr + 3 * i, x0 + i, n - i);
+    s.count += (uint32_t)(c[0] + c[1]);
+    s.sum_x += (uint64_t)sx[0] + sx[1] + sx[2] + sx[3];
+    return s;
+}
+
+const char *Isa()
+{
+    return "sse";
+}
+
+#elif BLOB_NEON
+
+static inline int16x8_t Widen(uint8x8_t v)
+{
+    return vreinterpretq_s16_u16(vmovl_u8(v));
+}
+
+// 0xff lanes to 0xffff
+static inline uint16x8_t WidenMask(uint8x8_t m)
+{
+    return vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(m)));
+}
+
+// Saturation and hue for 8 pixels widened to 16 bits
+static inline uint16x8_t SatHue8(const Bounds &bd, int16x8_t b, int16x8_t g, int16x8_t r,
+                                 uint16x8_t mx, int16x8_t d, uint16x8_t is_r, uint16x8_t is_g)
+{
+    uint16x8_t s255 = vmulq_n_u16(vreinterpretq_u16_s16(d), 255);
+    uint16x8_t sok = vandq_u16(vcleq_u16(vmulq_n_u16(mx, bd.s_lo), s255),
+                               vcleq_u16(s255, vmulq_n_u16(mx, bd.s_hi)));
+
+    int16x8_t num = vbslq_s16(is_r, vsubq_s16(g, b),
+                              vbslq_s16(is_g, vsubq_s16(b, r), vsubq_s16(r, g)));
+    int16x8_t n30 = vmulq_n_s16(num, 30);
+    int16x8_t lo = vbslq_s16(is_r, vdupq_n_s16(bd.h_lo[0]),
+                             vbslq_s16(is_g, vdupq_n_s16(bd.h_lo[1]), vdupq_n_s16(bd.h_lo[2])));
+    int16x8_t hi = vbslq_s16(is_r, vdupq_n_s16(bd.h_hi[0]),
+                             vbslq_s16(is_g, vdupq_n_s16(bd.h_hi[1]), vdupq_n_s16(bd.h_hi[2])));
+    uint16x8_t in = vandq_u16(vcleq_s16(vmulq_s16(lo, d), n30),
+                              vcleq_s16(n30, vmulq_s16(hi, d)));
+    uint16x8_t wrap = vandq_u16(vcleq_s16(vmulq_n_s16(d, bd.h_lo_wrap), n30),
+                                vcleq_s16(n30, vmulq_n_s16(d, bd.h_hi_wrap)));
+
+    return vandq_u16(sok, vorrq_u16(in, vandq_u16(is_r, wrap)));
+}
+
+SpanSums ThresholdSpan(const Bounds &bd, const uint8_t *bgr, int x0, int n)
+{
+    static const uint16_t idx[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    const uint16x8_t idx_lo = vld1q_u16(idx), idx_hi = vld1q_u16(idx + 8);
+    const uint8x16_t v_lo = vdupq_n_u8(bd.v_lo), v_hi = vdupq_n_u8(bd.v_hi);
+    const uint8x16_t grey = vdupq_n_u8(bd.grey_ok ? 0xff : 0);
+    uint32x4_t count = vdupq_n_u32(0), sum_x = vdupq_n_u32(0);
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x3_t px = vld3q_u8(bgr + 3 * i);
+        uint8x16_t b = px.val[0], g = px.val[1], r = px.val[2];
+
+        uint8x16_t mx = vmaxq_u8(vmaxq_u8(b, g), r);
+        uint8x16_t mn = vminq_u8(vminq_u8(b, g), r);
+        uint8x16_t d = vsubq_u8(mx, mn);
+        uint8x16_t vok = vandq_u8(vcgeq_u8(mx, v_lo), vcleq_u8(mx, v_hi));
+        uint8x16_t is_r = vceqq_u8(r, mx);
+        uint8x16_t is_g = vbicq_u8(vceqq_u8(g, mx), is_r);
+        uint8x16_t flat = vceqq_u8(d, vdupq_n_u8(0));
+
+        uint16x8_t lo = SatHue8(bd, Widen(vget_low_u8(b)), Widen(vget_low_u8(g)),
+                                Widen(vget_low_u8(r)), vmovl_u8(vget_low_u8(mx)),
+                                Widen(vget_low_u8(d)), WidenMask(vget_low_u8(is_r)),
+                                WidenMask(vget_low_u8(is_g)));
+        uint16x8_t hi = SatHue8(bd, Widen(vget_high_u8(b)), Widen(vget_high_u8(g)),
+                                Widen(vget_high_u8(r)), vmovl_u8(vget_high_u8(mx)),
+                                Widen(vget_high_u8(d)), WidenMask(vget_high_u8(is_r)),
+                                WidenMask(vget_high_u8(is_g)));
+        uint8x16_t sh = vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+        uint8x16_t m = vandq_u8(vok, vbslq_u8(flat, grey, sh));
+
+        count = vpadalq_u16(count, vpaddlq_u8(vandq_u8(m, vdupq_n_u8(1))));
+        uint16x8_t x = vdupq_n_u16((uint16_t)(x0 + i));
+        sum_x = vpadalq_u16(sum_x, vandq_u16(vaddq_u16(x, idx_lo), WidenMask(vget_low_u8(m))));
+        sum_x = vpadalq_u16(sum_x, vandq_u16(vaddq_u16(x, idx_hi), WidenMask(vget_high_u8(m))));
+    }
+
+    SpanSums s = ThresholdSpanScalar(bd, bgr + 3 * i, x0 + i, n - i);
+    s.count += vgetq_lane_u32(count, 0) + vgetq_lane_u32(count, 1) +
+               vgetq_lane_u32(count, 2) + vgetq_lane_u32(count, 3);
+    s.sum_x += (uint64_t)vgetq_lane_u32(sum_x, 0) + vgetq_lane_u32(sum_x, 1) +
+               vgetq_lane_u32(sum_x, 2) + vgetq_lane_u32(sum_x, 3);
+    return s;
+}
+
+const char *Isa()
+{
+    return "neon";
+}
+
+#else
+
+SpanSums ThresholdSpan(const Bounds &bd, const uint8_t *bgr, int x0, int n)
+{
+    return ThresholdSpanScalar(bd, bgr, x0, n);
+}
+
+const char *Isa()
+{
+    return "scalar";
+}
+
+#endif
+
+BlobTracker::BlobTracker(int width, int height, const HsvRange &range,
+                         const TrackerOptions &opts)
+    : width_(width), height_(height), bounds_(MakeBounds(range)), opts_(opts),
+      have_(false), last_x_(0), last_y_(0), last_radius_(0), last_coarse_(false)
+{
+    // Columns are summed in 16-bit lanes
+    if (width <= 0 || height <= 0 || width > 32767) {
+        throw std::invalid_argument("blobtrack: bad frame size");
+    }
+    cells_.resize((size_t)((width + CELL - 1) / CELL) * ((height + CELL - 1) / CELL));
+
+    size_t patches = (size_t)((width + PATCH_W - 1) / PATCH_W) * ((height + PATCH_H - 1) / PATCH_H);
+    patch_count_.resize(patches);
+    patch_sum_x_.resize(patches);
+    patch_sum_y_.resize(patches);
+    patch_blob_.resize(patches);
+    stack_.reserve(patches);
+}
+
+void BlobTracker::Reset()
+{
+    have_ = false;
+}
+
+BlobTracker::Window BlobTracker::WindowAround(int cx, int cy, int side) const
+{
+    Window w;
+
+    w.x0 = cx - side / 2 < 0 ? 0 : cx - side / 2;
+    w.y0 = cy - side / 2 < 0 ? 0 : cy - side / 2;
+    w.x1 = cx + side / 2 > width_ ? width_ : cx + side / 2;
+    w.y1 = cy + side / 2 > height_ ? height_ : cy + side / 2;
+    return w;
+}
+
+Blob BlobTracker::Measure(const uint8_t *bgr, size_t stride, const Window &w)
+{
+    const int pw = (w.x1 - w.x0 + PATCH_W - 1) / PATCH_W;
+    const int ph = (w.y1 - w.y0 + PATCH_H - 1) / PATCH_H;
+    Blob blob = { false, 0, 0, 0, 0 };
+
+    std::fill(patch_count_.begin(), patch_count_.begin() + pw * ph, 0);
+    std::fill(patch_sum_x_.begin(), patch_sum_x_.begin() + pw * ph, 0);
+    std::fill(patch_sum_y_.begin(), patch_sum_y_.begin() + pw * ph, 0);
+    for (int y = w.y0; y < w.y1; y++) {
+        const uint8_t *row = bgr + y * stride;
+        size_t p = (size_t)((y - w.y0) / PATCH_H) * pw;
+
+        for (int x0 = w.x0; x0 < w.x1; x0 += PATCH_W, p++) {
+            int n = x0 + PATCH_W > w.x1 ? w.x1 - x0 : PATCH_W;
+            SpanSums s = ThresholdSpan(bounds_, row + 3 * x0, x0, n);
+
+            patch_count_[p] += s.count;
+            patch_sum_x_[p] += (uint32_t)s.sum_x;
+            patch_sum_y_[p] += s.count * (uint32_t)y;
+        }
+    }
+
+    // Half-full patches, grouped by touching (8-connected); keep the biggest
+    for (int py = 0; py < ph; py++) {
+        int rows = std::min(PATCH_H, w.y1 - w.y0 - py * PATCH_H);
+
+        for (int px = 0; px < pw; px++) {
+            int cols = std::min(PATCH_W, w.x1 - w.x0 - px * PATCH_W);
+            size_t p = (size_t)py * pw + px;
+
+            // -2 dense and not yet grouped, -3 edge of the biggest blob
+            patch_blob_[p] = 2 * patch_count_[p] >= (uint32_t)(rows * cols) ? -2 : -1;
+        }
+    }
+
+    uint64_t count = 0, sum_x = 0, sum_y = 0;
+    int blobs = 0, best = -1;
+
+    for (int start = 0; start < pw * ph; start++) {
+        if (patch_blob_[start] != -2) continue;
+
+        uint64_t c = 0, sx = 0, sy = 0;
+
+        stack_.clear();
+        stack_.push_back(start);
+        patch_blob_[start] = blobs;
+        while (!stack_.empty()) {
+            int p = stack_.back();
+            int px = p % pw, py = p / pw;
+
+            stack_.pop_back();
+            c += patch_count_[p];
+            sx += patch_sum_x_[p];
+            sy += patch_sum_y_[p];
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int qx = px + dx, qy = py + dy, q = qy * pw + qx;
+
+                    if (qx >= 0 && qx < pw && qy >= 0 && qy < ph && patch_blob_[q] == -2) {
+                        patch_blob_[q] = blobs;
+                        stack_.push_back(q);
+                    }
+                }
+            }
+        }
+        if (c > count) {
+            count = c;
+            sum_x = sx;
+            sum_y = sy;
+            best = blobs;
+        }
+        blobs++;
+    }
+
+    // Plus the sparse patches around it, which hold the blob's edge
+    for (int p = 0; best >= 0 && p < pw * ph; p++) {
+        if (patch_blob_[p] != best) continue;
+
+        int px = p % pw, py = p / pw;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int qx = px + dx, qy = py + dy, q = qy * pw + qx;
+
+                if (qx >= 0 && qx < pw && qy >= 0 && qy < ph && patch_blob_[q] == -1) {
+                    patch_blob_[q] = -3;
+                    count += patch_count_[q];
+                    sum_x += patch_sum_x_[q];
+                    sum_y += patch_sum_y_[q];
+                }
+            }
+        }
+    }
+
+    blob.pixels = (int)count;
+    blob.radius = std::sqrt((float)count / (float)M_PI);
+    if (count == 0 || blob.radius < opts_.min_radius) {
+        have_ = false;
+        return blob;
+    }
+
+    float cx = (float)sum_x / count, cy = (float)sum_y / count;
+
+    have_ = true;
+    last_x_ = (int)(cx + 0.5f);
+    last_y_ = (int)(cy + 0.5f);
+    last_radius_ = blob.radius;
+
+    blob.valid = true;
+    blob.x = (opts_.mirror ? width_ - 1 - cx : cx) / width_;
+    blob.y = cy / height_;
+    return blob;
+}
+
+bool BlobTracker::CoarseSearch(const uint8_t *bgr, size_t stride, int *cx, int *cy)
+{
+    const int cw = (width_ + CELL - 1) / CELL, ch = (height_ + CELL - 1) / CELL;
+
+    std::fill(cells_.begin(), cells_.end(), 0);
+    for (int y = 0; y < height_; y += COARSE_STEP) {
+        const uint8_t *row = bgr + y * stride;
+        uint32_t *cell = &cells_[(size_t)(y / CELL) * cw];
+
+        for (int c = 0; c < cw; c++) {
+            int x0 = c * CELL, n = x0 + CELL > width_ ? width_ - x0 : CELL;
+
+            cell[c] += ThresholdSpan(bounds_, row + 3 * x0, x0, n).count;
+        }
+    }
+
+    // Densest 3x3 cells; a blob of min_radius leaves about this many hits
+    const float need = 0.5f * (float)M_PI * opts_.min_radius * opts_.min_radius / COARSE_STEP;
+    uint32_t best = 0;
+    int best_x = 0, best_y = 0;
+
+    for (int y = 0; y < ch; y++) {
+        for (int x = 0; x < cw; x++) {
+            uint32_t sum = 0;
+
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int yy = y + dy, xx = x + dx;
+
+                    if (yy >= 0 && yy < ch && xx >= 0 && xx < cw) {
+                        sum += cells_[(size_t)yy * cw + xx];
+                    }
+                }
+            }
+            if (sum > best) {
+                best = sum;
+                best_x = x;
+                best_y = y;
+            }
+        }
+    }
+    if ((float)best < need) return false;
+
+    *cx = best_x * CELL + CELL / 2;
+    *cy = best_y * CELL + CELL / 2;
+    return true;
+}
+
+Blob BlobTracker::Track(const uint8_t *bgr, size_t stride)
+{
+    last_coarse_ = false;
+    if (have_) {
+        float side = opts_.window_radii * last_radius_;
+        Blob blob = Measure(bgr, stride, WindowAround(last_x_, last_y_,
+                            side > opts_.min_window ? (int)side : opts_.min_window));
+
+        if (blob.valid) return blob;
+    }
+
+    int cx, cy;
+
+    last_coarse_ = true;
+    if (!CoarseSearch(bgr, stride, &cx, &cy)) {
+        have_ = false;
+        return Blob{ false, 0, 0, 0, 0 };
+    }
+
+    // The 3x3 cells first, then once more around what they held
+    int side = 3 * CELL > opts_.min_window ? 3 * CELL : opts_.min_window;
+    Blob blob = Measure(bgr, stride, WindowAround(cx, cy, side));
+    if (!blob.valid) return blob;
+
+    float fit = opts_.window_radii * last_radius_;
+    return Measure(bgr, stride, WindowAround(last_x_, last_y_,
+                   fit > opts_.min_window ? (int)fit : opts_.min_window));
+}
+
+} // namespace blobtrack
+
+// C interface, see blobtrack.h
+
+struct blobtrack_state {
+    blobtrack::BlobTracker tracker;
+};
+
+extern "C" blobtrack_state *blobtrack_new(int width, int height, const uint8_t lo[3],
+                                    const uint8_t hi[3])
+{
+    blobtrack::HsvRange range = { { lo[0], lo[1], lo[2] }, { hi[0], hi[1], hi[2] } };
+
+    try {
+        return new blobtrack_state{ blobtrack::BlobTracker(width, height, range) };
+    } catch (const std::exception &) {
+        return nullptr;
+    }
+}
+
+extern "C" void blobtrack_free(blobtrack_state *t)
+{
+    delete t;
+}
+
+extern "C" int blobtrack_track(blobtrack_state *t, const uint8_t *bgr, size_t stride, float out[3])
+{
+    blobtrack::Blob blob = t->tracker.Track(bgr, stride);
+
+    out[0] = blob.x;
+    out[1] = blob.y;
+    out[2] = blob.radius;
+    return blob.valid;
+}
+
+extern "C" void blobtrack_reset(blobtrack_state *t)
+{
+    t->tracker.Reset();
+}
+
+extern "C" const char *blobtrack_isa(void)
+{
+    return blobtrack::Isa();
+}
@@ -0,0 +1,118 @@
+// Created by Robbie Leslie 2025
+//
+// Coloured blob tracker for the glove marker, the fast path for
+// testFinalProject/vision.py's CameraTracker. Frames are OpenCV's 8-bit BGR.
+//
+// CameraTracker blurs, converts and morphs the whole frame and then looks for
+// contours, every frame. Here one kernel converts to HSV and range-tests 16
+// pixels at a time without storing either the HSV image or the mask, and only
+// sums the matching pixels' count and coordinates. While the blob is found
+// only a window around its last position is tested; when it is lost a coarse
+// pass over every COARSE_STEP-th row finds the densest patch and the window
+// is tested there. In the window, matches are counted per 16x4 patch and only
+// patches at least half full are kept, joined into blobs of touching patches,
+// and the biggest one taken: the stand-in for blur/erode/dilate and the
+// biggest contour, so sparse noise never adds up to a blob.
+//
+// HSV is OpenCV's 8-bit scale (H 0..179, S and V 0..255), worked out without
+// dividing, so a pixel right on a range edge can land differently from
+// cv2.cvtColor's rounding.
+
+#ifndef BLOB_TRACKER_HPP
+#define BLOB_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace blobtrack {
+
+struct HsvRange {
+    uint8_t lo[3];      // H, S, V
+    uint8_t hi[3];
+};
+
+// The range as the kernel uses it, see MakeBounds()
+struct Bounds {
+    uint8_t v_lo, v_hi;
+    uint16_t s_lo, s_hi;
+    // Hue relative to each sector's base, clamped to [-31, 31]. Sector 0
+    // (red is the max) also wraps: its second interval is 180 lower.
+    int16_t h_lo[3], h_hi[3];
+    int16_t h_lo_wrap, h_hi_wrap;
+    bool grey_ok;       // pixels with max == min: hue 0, saturation 0
+};
+
+Bounds MakeBounds(const HsvRange &range);
+
+// Pixels in range among n BGR pixels starting at column x0, and the sum of
+// their columns
+struct SpanSums {
+    uint32_t count;
+    uint64_t sum_x;
+};
+
+SpanSums ThresholdSpan(const Bounds &b, const uint8_t *bgr, int x0, int n);
+SpanSums ThresholdSpanScalar(const Bounds &b, const uint8_t *bgr, int x0, int n);
+
+// "sse" (SSSE3), "neon" or "scalar"
+const char *Isa();
+
+struct Blob {
+    bool valid;
+    float x, y;         // centre, normalised 0..1 like VisionData
+    float radius;       // px, of a disc with the same area
+    int pixels;
+};
+
+struct TrackerOptions {
+    float min_radius = 10.0f;   // smaller is noise, as in CameraTracker
+    int min_window = 64;        // px, window side never below this
+    float window_radii = 4.0f;  // window side in blob radii
+    bool mirror = true;         // x as in CameraTracker's flipped frame
+};
+
+class BlobTracker {
+public:
+    BlobTracker(int width, int height, const HsvRange &range,
+                const TrackerOptions &opts = TrackerOptions());
+
+    // One frame, rows stride bytes apart
+    Blob Track(const uint8_t *bgr, size_t stride);
+
+    // Forget the last position; the next frame is searched whole
+    void Reset();
+
+    // How the last Track() found it, for benchmarks
+    bool last_coarse() const { return last_coarse_; }
+
+private:
+    static const int COARSE_STEP = 4;   // rows, and 4x4 cells of 16 px
+    static const int CELL = 16;
+    static const int PATCH_W = 16;      // px, one vector of pixels
+    static const int PATCH_H = 4;
+
+    struct Window {
+        int x0, y0, x1, y1;
+    };
+
+    Blob Measure(const uint8_t *bgr, size_t stride, const Window &w);
+    bool CoarseSearch(const uint8_t *bgr, size_t stride, int *cx, int *cy);
+    Window WindowAround(int cx, int cy, int side) const;
+
+    int width_, height_;
+    Bounds bounds_;
+    TrackerOptions opts_;
+    bool have_;
+    int last_x_, last_y_;
+    float last_radius_;
+    bool last_coarse_;
+    std::vector<uint32_t> cells_;
+    std::vector<uint32_t> patch_count_, patch_sum_x_, patch_sum_y_;
+    std::vector<int> patch_blob_;       // component, -1 for sparse patches
+    std::vector<int> stack_;
+};
+
+} // namespace blobtrack
+
+#endif
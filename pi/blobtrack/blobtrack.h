@@ -0,0 +1,39 @@
+/*
+ * C interface to the blob tracker (blob_tracker.hpp), for ctypes
+ * (testFinalProject/fast_vision.py) and C callers such as the game.
+ *
+ * Created by Robbie Leslie 2025
+ */
+#ifndef BLOBTRACK_H
+#define BLOBTRACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct blobtrack_state blobtrack_state;
+
+/* lo and hi are OpenCV HSV (H 0..179). NULL if the size is not usable. */
+blobtrack_state *blobtrack_new(int width, int height, const uint8_t lo[3],
+                               const uint8_t hi[3]);
+
+void blobtrack_free(blobtrack_state *t);
+
+/* One BGR frame, rows stride bytes apart. out is x, y (0..1, x mirrored as
+   in CameraTracker) and radius in pixels. Returns 1 if the blob was found. */
+int blobtrack_track(blobtrack_state *t, const uint8_t *bgr, size_t stride, float out[3]);
+
+/* Search the next frame whole */
+void blobtrack_reset(blobtrack_state *t);
+
+/* "sse", "neon" or "scalar" */
+const char *blobtrack_isa(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+// Created by Robbie Leslie 2025
+
+#include <math.h>
+#include <string.h>
+
+#include "bias_tracker.h"
+
+// Rest: accel variance summed over axes below ACCEL_VAR, rotation below
+// GYRO_RATE (well above any real bias), |accel| within NORM_TOL of 1 g,
+// all for REST_S. Variance is over the last BIAS_WINDOW samples, so it
+// drops as soon as a swipe is over.
+#define ACCEL_VAR   0.02f     // (m/s^2)^2
+#define GYRO_RATE   0.1f      // rad/s
+#define NORM_TOL    0.5f      // m/s^2
+#define REST_S      0.25f
+// Samples of the first rest averaged before the estimate counts
+#define FIRST_SAMPLES 16
+#define BIAS_TAU_S  5.0f
+#define GRAVITY     9.80665f
+
+void bias_tracker_init(struct bias_tracker *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->gravity_norm = GRAVITY;
+}
+
+void bias_tracker_seed(struct bias_tracker *t, const float accel_bias[2],
+                       const float gyro_bias[3], float gravity_norm)
+{
+    memcpy(t->accel_bias, accel_bias, sizeof(t->accel_bias));
+    memcpy(t->gyro_bias, gyro_bias, sizeof(t->gyro_bias));
+    if (gravity_norm > 0) t->gravity_norm = gravity_norm;
+    t->valid = 1;
+}
+
+static float vec3_norm(const float v[3])
+{
+    return sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+int bias_tracker_update(struct bias_tracker *t, const float accel[3],
+                        const float gyro[3], const float offset[2], float dt)
+{
+    float var = 0.0f;
+    float norm = vec3_norm(accel);
+
+    memcpy(t->window[t->head], accel, sizeof(t->window[0]));
+    t->head = (t->head + 1) % BIAS_WINDOW;
+    if (t->filled < BIAS_WINDOW) t->filled++;
+
+    // Two passes over the window: one-pass sums of squares lose the
+    // variance next to 1 g in float
+    for (int i = 0; i < 3; i++) {
+        float mean = 0.0f, sq = 0.0f;
+
+        for (int j = 0; j < t->filled; j++) mean += t->window[j][i];
+        mean /= t->filled;
+        for (int j = 0; j < t->filled; j++) {
+            float d = t->window[j][i] - mean;
+            sq += d * d;
+        }
+        var += sq / t->filled;
+    }
+
+    if (t->filled < BIAS_WINDOW || var > ACCEL_VAR || vec3_norm(gyro) > GYRO_RATE ||
+        fabsf(norm - GRAVITY) > NORM_TOL) {
+        t->rest_s = 0.0f;
+        t->resting = 0;
+        if (!t->valid) t->first_count = 0;
+        return 0;
+    }
+    t->rest_s += dt;
+    if (t->rest_s < REST_S) return 0;
+    t->resting = 1;
+
+    if (!t->valid) {
+        // Running mean over the first rest period
+        float n = (float)++t->first_count;
+
+        for (int i = 0; i < 2; i++) t->accel_bias[i] += (offset[i] - t->accel_bias[i]) / n;
+        for (int i = 0; i < 3; i++) t->gyro_bias[i] += (gyro[i] - t->gyro_bias[i]) / n;
+        t->gravity_norm += (norm - t->gravity_norm) / n;
+        if (t->first_count >= FIRST_SAMPLES) t->valid = 1;
+        return t->valid;
+    }
+
+    float b = dt / BIAS_TAU_S;
+    if (b > 1.0f) b = 1.0f;
+    for (int i = 0; i < 2; i++) t->accel_bias[i] += b * (offset[i] - t->accel_bias[i]);
+    for (int i = 0; i < 3; i++) t->gyro_bias[i] += b * (gyro[i] - t->gyro_bias[i]);
+    t->gravity_norm += b * (norm - t->gravity_norm);
+    return 1;
+}
+
+void bias_metrics_init(struct bias_metrics *m)
+{
+    memset(m, 0, sizeof(*m));
+}
+
+void bias_metrics_update(struct bias_metrics *m, const struct bias_tracker *t,
+                         int changed, float dt)
+{
+    m->session_s += dt;
+    if (t->resting) {
+        if (!m->was_resting) m->rest_periods++;
+        m->rest_s += dt;
+    }
+    m->was_resting = t->resting;
+    if (!changed) return;
+    m->updates++;
+
+    if (!m->have_first) {
+        if (!t->valid) return;
+        memcpy(m->first_accel, t->accel_bias, sizeof(m->first_accel));
+        memcpy(m->first_gyro, t->gyro_bias, sizeof(m->first_gyro));
+        m->have_first = 1;
+    }
+    float da[2] = { t->accel_bias[0] - m->first_accel[0], t->accel_bias[1] - m->first_accel[1] };
+    float dg[3] = { t->gyro_bias[0] - m->first_gyro[0], t->gyro_bias[1] - m->first_gyro[1],
+                    t->gyro_bias[2] - m->first_gyro[2] };
+
+    m->accel_drift = sqrtf(da[0] * da[0] + da[1] * da[1]);
+    m->gyro_drift = vec3_norm(dg);
+    if (m->accel_drift > m->max_accel_drift) m->max_accel_drift = m->accel_drift;
+    if (m->gyro_drift > m->max_gyro_drift) m->max_gyro_drift = m->gyro_drift;
+}
@@ -0,0 +1,73 @@
+// Created by Robbie Leslie 2025
+
+#ifndef BIAS_TRACKER_H
+#define BIAS_TRACKER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Background bias estimation for one glove. Whenever the glove is at rest
+   (little accel variance, little rotation, |accel| near 1 g, held for a
+   moment) the cursor's accel offset and the gyro bias are refined, so no
+   up-front "Keep Still!" is needed and slow drift over a session is
+   followed. The first rest period gives the first estimate outright; after
+   that the estimate moves with time constant BIAS_TAU_S. */
+
+#define BIAS_WINDOW 16      /* samples the accel variance is taken over */
+
+struct bias_tracker {
+    float window[BIAS_WINDOW][3];   /* last raw accel samples */
+    int head, filled;
+    float rest_s;           /* how long the glove has looked still */
+    int resting;
+
+    int valid;              /* an estimate exists */
+    int first_count;        /* samples averaged into the first estimate */
+    float accel_bias[2];    /* cursor accel offset, screen axes, m/s^2 */
+    float gyro_bias[3];     /* rad/s */
+    float gravity_norm;     /* |accel| at rest, m/s^2 */
+};
+
+void bias_tracker_init(struct bias_tracker *t);
+
+/* Start from a known estimate, e.g. a cached calibration */
+void bias_tracker_seed(struct bias_tracker *t, const float accel_bias[2],
+                       const float gyro_bias[3], float gravity_norm);
+
+/* accel (m/s^2) and gyro (rad/s) are the raw sample, offset is what the
+   cursor would read as acceleration at rest. Returns 1 if the estimate
+   changed. */
+int bias_tracker_update(struct bias_tracker *t, const float accel[3],
+                        const float gyro[3], const float offset[2], float dt);
+
+/* Drift over a session for one glove: how far the estimate has moved
+   from the first one, and how much of the time it could be refined. */
+struct bias_metrics {
+    float session_s;
+    float rest_s;
+    uint32_t rest_periods;
+    int was_resting;
+    uint32_t updates;
+    int have_first;
+    float first_accel[2];
+    float first_gyro[3];
+    float accel_drift;      /* |accel bias - first|, m/s^2 */
+    float gyro_drift;       /* |gyro bias - first|, rad/s */
+    float max_accel_drift;
+    float max_gyro_drift;
+};
+
+void bias_metrics_init(struct bias_metrics *m);
+
+/* Once per sample, after bias_tracker_update; changed is what it returned */
+void bias_metrics_update(struct bias_metrics *m, const struct bias_tracker *t,
+                         int changed, float dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+// Created by Robbie Leslie 2025
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "calib_cache.h"
+#include "dongleparse.h"
+
+// Still means turning slower than STILL_GYRO (well above any real bias)
+// with |accel| within STILL_ACCEL of 1 g, for CHECK_S. A match is the mean over that time being within
+// GYRO_TOL and NORM_TOL of the entry.
+#define STILL_GYRO  0.15f     // rad/s
+#define STILL_ACCEL 1.0f      // m/s^2
+#define CHECK_S     0.3f
+#define GYRO_TOL    0.03f     // rad/s
+#define NORM_TOL    0.2f      // m/s^2
+#define GRAVITY     9.80665f
+
+static struct calib_entry entries[DP_PIPES];
+static int present[DP_PIPES];
+
+int calib_cache_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int n = 0;
+
+    if (!f) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        struct calib_entry e;
+        unsigned pipe;
+        long long saved;
+
+        memset(&e, 0, sizeof(e));
+        // pipe saved have_accel bias_x bias_y gyro_x gyro_y gyro_z gravity_norm
+        if (sscanf(line, "%u %lld %d %f %f %f %f %f %f", &pipe, &saved,
+                   &e.have_accel, &e.accel_bias[0], &e.accel_bias[1],
+                   &e.gyro_bias[0], &e.gyro_bias[1], &e.gyro_bias[2],
+                   &e.gravity_norm) != 9 || pipe >= DP_PIPES) {
+            continue;  // comment or damaged line
+        }
+        e.pipe = (uint8_t)pipe;
+        e.saved = saved;
+        entries[pipe] = e;
+        present[pipe] = 1;
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+int calib_cache_save(const char *path)
+{
+    char tmp[256];
+    FILE *f;
+
+    // Write beside and rename, so a crash never leaves half a file
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    f = fopen(tmp, "w");
+    if (!f) return -1;
+    fprintf(f, "# pipe saved have_accel bias_x bias_y gyro_x gyro_y gyro_z gravity_norm\n");
+    for (int i = 0; i < DP_PIPES; i++) {
+        const struct calib_entry *e = &entries[i];
+
+        if (!present[i]) continue;
+        fprintf(f, "%u %lld %d %.6f %.6f %.6f %.6f %.6f %.5f\n", e->pipe,
+                (long long)e->saved, e->have_accel, e->accel_bias[0],
+                e->accel_bias[1], e->gyro_bias[0], e->gyro_bias[1],
+                e->gyro_bias[2], e->gravity_norm);
+    }
+    if (fclose(f) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return rename(tmp, path) == 0 ? 0 : -1;
+}
+
+const struct calib_entry *calib_cache_get(int pipe, time_t now)
+{
+    if (pipe < 0 || pipe >= DP_PIPES || !present[pipe]) return NULL;
+    // A clock that went backwards makes the age unknown: treat as stale
+    if (now < entries[pipe].saved || now - entries[pipe].saved > CALIB_MAX_AGE_S) return NULL;
+    return &entries[pipe];
+}
+
+void calib_cache_put(const struct calib_entry *e)
+{
+    if (e->pipe >= DP_PIPES) return;
+    entries[e->pipe] = *e;
+    present[e->pipe] = 1;
+    if (calib_cache_save(CALIB_CACHE_FILE) != 0) {
+        printf("Unable to save %s\n", CALIB_CACHE_FILE);
+    }
+}
+
+void calib_cache_forget(int pipe)
+{
+    if (pipe < 0 || pipe >= DP_PIPES || !present[pipe]) return;
+    present[pipe] = 0;
+    calib_cache_save(CALIB_CACHE_FILE);
+}
+
+void calib_check_init(struct calib_check *c)
+{
+    memset(c, 0, sizeof(*c));
+}
+
+int calib_check_update(struct calib_check *c, const struct calib_entry *e,
+                       const float accel[3], const float gyro[3], float dt)
+{
+    float rate, norm;
+
+    rate = sqrtf(gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2]);
+    norm = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+
+    if (rate > STILL_GYRO || fabsf(norm - GRAVITY) > STILL_ACCEL) {
+        calib_check_init(c);
+        return 1;
+    }
+    c->still_s += dt;
+    c->count++;
+    for (int i = 0; i < 3; i++) c->gyro_sum[i] += gyro[i];
+    c->norm_sum += norm;
+    if (c->still_s < CHECK_S) return 1;
+
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(c->gyro_sum[i] / c->count - e->gyro_bias[i]) > GYRO_TOL) return -1;
+    }
+    if (e->gravity_norm > 0 && fabsf(c->norm_sum / c->count - e->gravity_norm) > NORM_TOL) {
+        return -1;
+    }
+    return 0;
+}
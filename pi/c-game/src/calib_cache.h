@@ -0,0 +1,65 @@
+// Created by Robbie Leslie 2025
+
+#ifndef CALIB_CACHE_H
+#define CALIB_CACHE_H
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Glove calibrations kept between screens and between runs, one per
+   dongle pipe, so a known glove is usable from its first sample. An entry
+   is only trusted while it is younger than CALIB_MAX_AGE_S, and only until
+   the glove is first held still: then calib_check compares the live
+   readings against it and a mismatch (another glove on that pipe, a
+   different range setting, a warm sensor) throws it away. */
+
+#define CALIB_CACHE_FILE "imu_calib.txt"
+#define CALIB_MAX_AGE_S  (24 * 60 * 60)
+
+struct calib_entry {
+    uint8_t pipe;
+    int64_t saved;          /* time() when calibrated or last confirmed */
+    int have_accel;
+    float accel_bias[2];    /* at-rest offset, screen axes, m/s^2 */
+    float gyro_bias[3];     /* rad/s */
+    float gravity_norm;     /* |accel| at rest, m/s^2; 0 if not measured */
+};
+
+/* Read the file into memory; returns entries read, -1 if there is none */
+int calib_cache_load(const char *path);
+
+/* Write every entry; returns 0 or -1 */
+int calib_cache_save(const char *path);
+
+/* Entry for this pipe if there is one and it is not stale, else NULL */
+const struct calib_entry *calib_cache_get(int pipe, time_t now);
+
+/* Store (replacing this pipe's entry) and save */
+void calib_cache_put(const struct calib_entry *e);
+
+/* Drop this pipe's entry and save */
+void calib_cache_forget(int pipe);
+
+struct calib_check {
+    float still_s;
+    int count;
+    float gyro_sum[3];
+    float norm_sum;
+};
+
+void calib_check_init(struct calib_check *c);
+
+/* Feed raw samples after applying e. Returns 1 while waiting for the
+   glove to be still, 0 once the entry matched, -1 if it did not. */
+int calib_check_update(struct calib_check *c, const struct calib_entry *e,
+                       const float accel[3], const float gyro[3], float dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,219 @@
+// Created by Robbie Leslie 2025
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cursor_bank.h"
+#include "cursor_motion.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BANK_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BANK_NEON 1
+#endif
+
+// Fields carved out of one allocation, in this order
+#define BANK_FIELDS 9
+
+int cursor_bank_init(struct cursor_bank *b, int count, float width, float height)
+{
+    int lanes = (count + CURSOR_BANK_LANES - 1) / CURSOR_BANK_LANES * CURSOR_BANK_LANES;
+    size_t field = (size_t)lanes * sizeof(float);
+    void *mem;
+
+    memset(b, 0, sizeof(*b));
+    if (count <= 0) return -1;
+
+    // field is a multiple of 16 bytes, so every array stays aligned
+    if (posix_memalign(&mem, 16, field * BANK_FIELDS) != 0) return -1;
+    memset(mem, 0, field * BANK_FIELDS);
+
+    b->count = count;
+    b->lanes = lanes;
+    b->width = width;
+    b->height = height;
+    b->pos_x = (float *)mem;
+    b->pos_y = b->pos_x + lanes;
+    b->vel_x = b->pos_x + 2 * lanes;
+    b->vel_y = b->pos_x + 3 * lanes;
+    b->in_x = b->pos_x + 4 * lanes;
+    b->in_y = b->pos_x + 5 * lanes;
+    b->dt = b->pos_x + 6 * lanes;
+    b->damp_dt = b->pos_x + 7 * lanes;
+    b->damp = b->pos_x + 8 * lanes;
+    for (int i = 0; i < lanes; i++) b->damp[i] = 1.0f;  // right for dt 0
+    return 0;
+}
+
+void cursor_bank_free(struct cursor_bank *b)
+{
+    free(b->pos_x);
+    memset(b, 0, sizeof(*b));
+}
+
+// Same expression as accel_motion_step(), cached per lane
+static void update_damping(struct cursor_bank *b)
+{
+    for (int i = 0; i < b->lanes; i++) {
+        if (b->dt[i] != b->damp_dt[i]) {
+            b->damp_dt[i] = b->dt[i];
+            b->damp[i] = powf(CURSOR_DAMPING, b->dt[i] * CURSOR_TUNED_RATE_HZ);
+        }
+    }
+}
+
+void cursor_bank_step_scalar(struct cursor_bank *b)
+{
+    update_damping(b);
+    for (int i = 0; i < b->count; i++) {
+        float pos[2] = { b->pos_x[i], b->pos_y[i] };
+        float vel[2] = { b->vel_x[i], b->vel_y[i] };
+        float lin[2] = { b->in_x[i], b->in_y[i] };
+
+        accel_motion_step(vel, lin, b->dt[i]);
+        cursor_position_step(pos, vel, b->dt[i], b->width, b->height);
+        b->pos_x[i] = pos[0];
+        b->pos_y[i] = pos[1];
+        b->vel_x[i] = vel[0];
+        b->vel_y[i] = vel[1];
+    }
+}
+
+#if defined(BANK_SSE2)
+
+const char *cursor_bank_isa(void) { return "sse2"; }
+
+// One axis of four cursors: accel_motion_step() then cursor_position_step()
+static inline void step_axis(float *pos, float *vel, const float *in,
+                             __m128 dt, __m128 damp, __m128 limit)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 a = _mm_load_ps(in);
+    __m128 v = _mm_load_ps(vel);
+    __m128 p = _mm_load_ps(pos);
+    __m128 m;
+
+    // Apply deadzone
+    m = _mm_cmplt_ps(_mm_andnot_ps(sign, a), _mm_set1_ps(CURSOR_ACCEL_DEADZONE));
+    a = _mm_andnot_ps(m, a);
+
+    // Integrate to velocity, damp
+    v = _mm_add_ps(v, _mm_mul_ps(_mm_mul_ps(a, _mm_set1_ps(CURSOR_ACCEL_SCALE)), dt));
+    v = _mm_mul_ps(v, damp);
+
+    // Velocity deadzone
+    m = _mm_cmplt_ps(_mm_andnot_ps(sign, v), _mm_set1_ps(CURSOR_VEL_DEADZONE));
+    v = _mm_andnot_ps(m, v);
+
+    // Clamp velocity, keeping its sign
+    m = _mm_cmpgt_ps(_mm_andnot_ps(sign, v), _mm_set1_ps(CURSOR_MAX_VEL));
+    __m128 vmax = _mm_or_ps(_mm_and_ps(v, sign), _mm_set1_ps(CURSOR_MAX_VEL));
+    v = _mm_or_ps(_mm_and_ps(m, vmax), _mm_andnot_ps(m, v));
+
+    // Integrate to position, stop at the screen edges
+    p = _mm_add_ps(p, _mm_mul_ps(v, dt));
+    m = _mm_cmplt_ps(p, zero);
+    p = _mm_andnot_ps(m, p);
+    v = _mm_andnot_ps(m, v);
+    m = _mm_cmpgt_ps(p, limit);
+    p = _mm_or_ps(_mm_and_ps(m, limit), _mm_andnot_ps(m, p));
+    v = _mm_andnot_ps(m, v);
+
+    _mm_store_ps(pos, p);
+    _mm_store_ps(vel, v);
+}
+
+void cursor_bank_step(struct cursor_bank *b)
+{
+    const __m128 width = _mm_set1_ps(b->width);
+    const __m128 height = _mm_set1_ps(b->height);
+
+    update_damping(b);
+    for (int i = 0; i < b->lanes; i += CURSOR_BANK_LANES) {
+        __m128 dt = _mm_load_ps(b->dt + i);
+        __m128 damp = _mm_load_ps(b->damp + i);
+
+        step_axis(b->pos_x + i, b->vel_x + i, b->in_x + i, dt, damp, width);
+        step_axis(b->pos_y + i, b->vel_y + i, b->in_y + i, dt, damp, height);
+    }
+}
+
+#elif defined(BANK_NEON)
+
+const char *cursor_bank_isa(void) { return "neon"; }
+
+static inline float32x4_t zero_where(uint32x4_t m, float32x4_t x)
+{
+    return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(x), m));
+}
+
+// One axis of four cursors: accel_motion_step() then cursor_position_step()
+static inline void step_axis(float *pos, float *vel, const float *in,
+                             float32x4_t dt, float32x4_t damp, float32x4_t limit)
+{
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t a = vld1q_f32(in);
+    float32x4_t v = vld1q_f32(vel);
+    float32x4_t p = vld1q_f32(pos);
+    uint32x4_t m;
+
+    // Apply deadzone
+    m = vcltq_f32(vabsq_f32(a), vdupq_n_f32(CURSOR_ACCEL_DEADZONE));
+    a = zero_where(m, a);
+
+    // Integrate to velocity, damp. Separate multiply and add, as in C.
+    v = vaddq_f32(v, vmulq_f32(vmulq_f32(a, vdupq_n_f32(CURSOR_ACCEL_SCALE)), dt));
+    v = vmulq_f32(v, damp);
+
+    // Velocity deadzone
+    m = vcltq_f32(vabsq_f32(v), vdupq_n_f32(CURSOR_VEL_DEADZONE));
+    v = zero_where(m, v);
+
+    // Clamp velocity, keeping its sign
+    m = vcgtq_f32(vabsq_f32(v), vdupq_n_f32(CURSOR_MAX_VEL));
+    float32x4_t vmax = vbslq_f32(sign, v, vdupq_n_f32(CURSOR_MAX_VEL));
+    v = vbslq_f32(m, vmax, v);
+
+    // Integrate to position, stop at the screen edges
+    p = vaddq_f32(p, vmulq_f32(v, dt));
+    m = vcltq_f32(p, zero);
+    p = zero_where(m, p);
+    v = zero_where(m, v);
+    m = vcgtq_f32(p, limit);
+    p = vbslq_f32(m, limit, p);
+    v = zero_where(m, v);
+
+    vst1q_f32(pos, p);
+    vst1q_f32(vel, v);
+}
+
+void cursor_bank_step(struct cursor_bank *b)
+{
+    const float32x4_t width = vdupq_n_f32(b->width);
+    const float32x4_t height = vdupq_n_f32(b->height);
+
+    update_damping(b);
+    for (int i = 0; i < b->lanes; i += CURSOR_BANK_LANES) {
+        float32x4_t dt = vld1q_f32(b->dt + i);
+        float32x4_t damp = vld1q_f32(b->damp + i);
+
+        step_axis(b->pos_x + i, b->vel_x + i, b->in_x + i, dt, damp, width);
+        step_axis(b->pos_y + i, b->vel_y + i, b->in_y + i, dt, damp, height);
+    }
+}
+
+#else
+
+const char *cursor_bank_isa(void) { return "scalar"; }
+
+void cursor_bank_step(struct cursor_bank *b)
+{
+    cursor_bank_step_scalar(b);
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Created by Robbie Leslie 2025
+
+#ifndef CURSOR_BANK_H
+#define CURSOR_BANK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Acceleration-mode cursors for many gloves at once, one array per field
+   so a step runs four cursors per instruction (SSE2 on x86, NEON on the
+   Pi, plain C elsewhere). A step gives the same bits as running
+   accel_motion_step() and cursor_position_step() on each cursor as long
+   as the compiler does not fuse multiply-adds (-ffp-contract=off; GCC on
+   arm64 fuses by default). microcontroller/host/cursor_bank_bench checks
+   this and times it. */
+
+#define CURSOR_BANK_LANES 4
+
+struct cursor_bank {
+    int count;          /* cursors in use */
+    int lanes;          /* allocated, count rounded up to CURSOR_BANK_LANES */
+    float width, height;
+
+    /* State */
+    float *pos_x, *pos_y;
+    float *vel_x, *vel_y;
+
+    /* Input for the next step, filled by the caller: accel along the
+       screen axes (x right, y down) with gravity and the at-rest offset
+       removed, m/s^2, and the sample's dt in s. Unused lanes stay 0. */
+    float *in_x, *in_y;
+    float *dt;
+
+    /* Damping for the last dt seen on each lane, so powf only runs when
+       a glove's sample period changes */
+    float *damp_dt, *damp;
+};
+
+/* Returns 0, or -1 if out of memory. All cursors start at rest at pos 0. */
+int cursor_bank_init(struct cursor_bank *b, int count, float width, float height);
+
+void cursor_bank_free(struct cursor_bank *b);
+
+/* One sample for every cursor */
+void cursor_bank_step(struct cursor_bank *b);
+
+/* The same step one cursor at a time, for comparison */
+void cursor_bank_step_scalar(struct cursor_bank *b);
+
+/* "sse2", "neon" or "scalar" */
+const char *cursor_bank_isa(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
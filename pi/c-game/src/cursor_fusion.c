@@ -0,0 +1,157 @@
+// Created by Robbie Leslie 2025
+
+#include "cursor_fusion.h"
+#include <string.h>
+
+// Uncertainty with nothing to go on: a whole screen, px and px/s
+static const float FUSION_UNKNOWN_POS   = 1000.0f;
+static const float FUSION_UNKNOWN_DRIFT = 200.0f;
+
+void cursor_fusion_defaults(struct cursor_fusion_config *cfg)
+{
+    cfg->q_pos = 400.0f;
+    cfg->q_drift = 100.0f;
+    cfg->r_camera = 16.0f;
+    cfg->gate = 4.0f;
+}
+
+static void ResetAxis(struct cursor_fusion_axis *a, float pos)
+{
+    a->pos = pos;
+    a->drift = 0.0f;
+    a->p[0][0] = FUSION_UNKNOWN_POS * FUSION_UNKNOWN_POS;
+    a->p[0][1] = a->p[1][0] = 0.0f;
+    a->p[1][1] = FUSION_UNKNOWN_DRIFT * FUSION_UNKNOWN_DRIFT;
+}
+
+void cursor_fusion_init(struct cursor_fusion *f, const struct cursor_fusion_config *cfg,
+                        const float pos[2])
+{
+    memset(f, 0, sizeof(*f));
+    if (cfg) {
+        f->cfg = *cfg;
+    } else {
+        cursor_fusion_defaults(&f->cfg);
+    }
+    ResetAxis(&f->axis[0], pos[0]);
+    ResetAxis(&f->axis[1], pos[1]);
+}
+
+void cursor_fusion_imu(struct cursor_fusion *f, double t, const float vel[2], float dt)
+{
+    for (int i = 0; i < 2; i++) {
+        struct cursor_fusion_axis *a = &f->axis[i];
+
+        // x += (v - drift) dt, so F = [1 -dt; 0 1]
+        a->pos += (vel[i] - a->drift) * dt;
+
+        float p00 = a->p[0][0] - dt * (a->p[1][0] + a->p[0][1]) + dt * dt * a->p[1][1];
+        float p01 = a->p[0][1] - dt * a->p[1][1];
+
+        a->p[0][0] = p00 + f->cfg.q_pos * dt;
+        a->p[0][1] = a->p[1][0] = p01;
+        a->p[1][1] += f->cfg.q_drift * dt;
+    }
+
+    int slot = (f->hist_head + f->hist_count) % FUSION_HISTORY;
+
+    if (f->hist_count == FUSION_HISTORY) {
+        f->hist_head = (f->hist_head + 1) % FUSION_HISTORY;
+    } else {
+        f->hist_count++;
+    }
+    f->hist_t[slot] = t;
+    f->hist_pos[slot][0] = f->axis[0].pos;
+    f->hist_pos[slot][1] = f->axis[1].pos;
+}
+
+// Position the filter had at time t; 0 if t is before the history
+static int PositionAt(const struct cursor_fusion *f, double t, float out[2])
+{
+    if (f->hist_count == 0) {
+        cursor_fusion_position(f, out);
+        return 1;
+    }
+    for (int k = f->hist_count - 1; k >= 0; k--) {
+        int slot = (f->hist_head + k) % FUSION_HISTORY;
+
+        if (f->hist_t[slot] <= t) {
+            out[0] = f->hist_pos[slot][0];
+            out[1] = f->hist_pos[slot][1];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// A correction moves the whole track, so the next late fix is compared
+// with corrected positions and not applied twice
+static void ShiftHistory(struct cursor_fusion *f, const float delta[2])
+{
+    for (int k = 0; k < f->hist_count; k++) {
+        int slot = (f->hist_head + k) % FUSION_HISTORY;
+
+        f->hist_pos[slot][0] += delta[0];
+        f->hist_pos[slot][1] += delta[1];
+    }
+}
+
+int cursor_fusion_camera(struct cursor_fusion *f, double t, const float pos[2])
+{
+    float then[2], innov[2], s[2], moved[2];
+
+    if (!PositionAt(f, t, then)) {
+        f->stale++;
+        return -1;
+    }
+
+    float d2 = 0.0f;
+
+    for (int i = 0; i < 2; i++) {
+        innov[i] = pos[i] - then[i];
+        s[i] = f->axis[i].p[0][0] + f->cfg.r_camera;
+        d2 += innov[i] * innov[i] / s[i];
+    }
+
+    // Far off: a bad track, unless the camera keeps saying so
+    if (f->have_fix && d2 > f->cfg.gate * f->cfg.gate) {
+        if (++f->rejects < FUSION_MAX_REJECTS) {
+            f->rejected++;
+            return 0;
+        }
+        for (int i = 0; i < 2; i++) {
+            // Where the camera says the glove was, moved on by the IMU since
+            ResetAxis(&f->axis[i], f->axis[i].pos + innov[i]);
+        }
+        ShiftHistory(f, innov);
+        f->resets++;
+        f->rejects = 0;
+        return 1;
+    }
+    f->rejects = 0;
+    f->have_fix = 1;
+    f->fixes++;
+
+    for (int i = 0; i < 2; i++) {
+        struct cursor_fusion_axis *a = &f->axis[i];
+        float k0 = a->p[0][0] / s[i];
+        float k1 = a->p[1][0] / s[i];
+        float p00 = a->p[0][0], p01 = a->p[0][1], p11 = a->p[1][1];
+
+        // The correction is for the position back then, applied to now
+        moved[i] = k0 * innov[i];
+        a->pos += moved[i];
+        a->drift += k1 * innov[i];
+        a->p[0][0] = (1.0f - k0) * p00;
+        a->p[0][1] = a->p[1][0] = (1.0f - k0) * p01;
+        a->p[1][1] = p11 - k1 * p01;
+    }
+    ShiftHistory(f, moved);
+    return 1;
+}
+
+void cursor_fusion_position(const struct cursor_fusion *f, float out[2])
+{
+    out[0] = f->axis[0].pos;
+    out[1] = f->axis[1].pos;
+}
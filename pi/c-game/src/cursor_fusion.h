@@ -0,0 +1,80 @@
+// Created by Robbie Leslie 2025
+
+#ifndef CURSOR_FUSION_H
+#define CURSOR_FUSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Absolute cursor position from the glove IMU and a camera. The IMU cursor
+   moves at the full sample rate but is integrated, so it drifts; the camera
+   (testFinalProject/vision.py's coloured blob) knows where the glove is but
+   comes at 30 Hz or less, late and sometimes not at all. Per screen axis a
+   small Kalman filter keeps the position and the drift of the IMU
+   velocity: every IMU sample moves the position by (velocity - drift) * dt,
+   every camera fix pulls the position back and teaches the drift.
+
+   Camera fixes are late by the capture and tracking time. A fix is
+   compared with the position the filter had when the frame was taken
+   (kept in a short history) and the correction is applied to the current
+   one. Fixes far outside the filter's uncertainty are dropped as bad
+   tracks until FUSION_MAX_REJECTS come in a row, which means the filter is
+   the one that is lost: it then jumps to the camera.
+
+   No raylib, so microcontroller/host/fusion_replay.c can run it offline.
+   Positions in screen pixels, times in seconds on one clock for both. */
+
+#define FUSION_HISTORY      64      /* IMU steps a late fix can reach back */
+#define FUSION_MAX_REJECTS  5
+
+struct cursor_fusion_config {
+    float q_pos;        /* IMU velocity noise, px^2/s */
+    float q_drift;      /* how fast the drift wanders, (px/s)^2/s */
+    float r_camera;     /* camera fix noise, px^2 */
+    float gate;         /* innovations beyond this many sigma are rejected */
+};
+
+struct cursor_fusion_axis {
+    float pos;          /* px */
+    float drift;        /* px/s the IMU velocity reads too high */
+    float p[2][2];      /* covariance of (pos, drift) */
+};
+
+struct cursor_fusion {
+    struct cursor_fusion_config cfg;
+    struct cursor_fusion_axis axis[2];
+
+    /* Past positions for late fixes, oldest overwritten */
+    double hist_t[FUSION_HISTORY];
+    float hist_pos[FUSION_HISTORY][2];
+    int hist_head, hist_count;
+
+    int rejects;        /* in a row */
+    int have_fix;
+
+    /* Counts since init */
+    unsigned fixes, rejected, resets, stale;
+};
+
+// Defaults for a 320x240 camera stretched to an 800x450 screen
+void cursor_fusion_defaults(struct cursor_fusion_config *cfg);
+
+// Start at pos with no idea where the glove is; cfg NULL for the defaults
+void cursor_fusion_init(struct cursor_fusion *f, const struct cursor_fusion_config *cfg,
+                        const float pos[2]);
+
+// One IMU step: the cursor velocity (px/s) over the dt ending at t
+void cursor_fusion_imu(struct cursor_fusion *f, double t, const float vel[2], float dt);
+
+// Camera fix: where the glove was at time t, px. Returns 1 if used,
+// 0 if rejected as a bad track, -1 if older than the history.
+int cursor_fusion_camera(struct cursor_fusion *f, double t, const float pos[2]);
+
+void cursor_fusion_position(const struct cursor_fusion *f, float out[2]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+// Created by Robbie Leslie 2025
+
+#include <math.h>
+
+#include "cursor_motion.h"
+
+// Air mode. Pixels per radian turned rise from GAIN_SLOW below SPEED_SLOW
+// to GAIN_FAST above SPEED_FAST: small turns for precise aim, a flick to
+// cross the screen.
+#define AIR_GAIN_SLOW     300.0f
+#define AIR_GAIN_FAST     900.0f
+#define AIR_SPEED_SLOW    0.5f      // rad/s
+#define AIR_SPEED_FAST    3.0f      // rad/s
+#define AIR_DEADBAND      0.02f     // rad/s left after the bias is hand tremor
+// Still: rate within STILL_RATE of the bias (STILL_RATE_COLD before the
+// first bias) for STILL_S. The first bias is the mean of one still period,
+// after that it follows with time constant BIAS_TAU_S.
+#define AIR_STILL_RATE      0.06f
+#define AIR_STILL_RATE_COLD 0.15f
+#define AIR_STILL_S         0.3f
+#define AIR_BIAS_TAU_S      2.0f
+
+static const char *mode_names[] = { "accel", "air" };
+
+const char *cursor_mode_name(int mode)
+{
+    if (mode < 0 || mode > CURSOR_MODE_AIR) return "?";
+    return mode_names[mode];
+}
+
+void cursor_accel_axes(const float accel[3], float out[2])
+{
+    // EXAMPLE: IMU rotated 90° clockwise relative to original
+    //   old_x -> -new_y
+    //   old_y ->  new_x
+    // Return (world_x, world_y)
+    out[0] = -accel[1];
+    out[1] = accel[0];
+
+    // Other common cases (pick ONE and delete the rest):
+    // 180° rotation:
+    // out[0] = -accel[0]; out[1] = -accel[1];
+    // 90° CCW:
+    // out[0] = -accel[1]; out[1] = accel[0];
+    // flipped X only:
+    // out[0] = -accel[0]; out[1] = accel[1];
+    // flipped Y only:
+    // out[0] = accel[0]; out[1] = -accel[1];
+}
+
+// Glove rates to screen axes for the same mounting as cursor_accel_axes:
+// glove x is screen up and -y screen right, so turning about x pans and
+// turning about y tilts. Positive rates are counter-clockwise.
+static void air_axes(const float rate[3], float out[2])
+{
+    out[0] = -rate[0];
+    out[1] = rate[1];
+}
+
+void accel_motion_step(float vel[2], const float lin[2], float dt)
+{
+    float damping = powf(CURSOR_DAMPING, dt * CURSOR_TUNED_RATE_HZ);
+
+    for (int i = 0; i < 2; i++) {
+        float a = lin[i];
+
+        // Apply deadzone
+        if (fabsf(a) < CURSOR_ACCEL_DEADZONE) a = 0.0f;
+
+        // Integrate to velocity
+        vel[i] += a * CURSOR_ACCEL_SCALE * dt;
+
+        // Damping
+        vel[i] *= damping;
+
+        // Velocity deadzone
+        if (fabsf(vel[i]) < CURSOR_VEL_DEADZONE) vel[i] = 0.0f;
+
+        // Clamp velocity
+        if (fabsf(vel[i]) > CURSOR_MAX_VEL) vel[i] = copysignf(CURSOR_MAX_VEL, vel[i]);
+    }
+}
+
+void cursor_position_step(float pos[2], float vel[2], float dt,
+                          float width, float height)
+{
+    // Integrate to position
+    pos[0] += vel[0] * dt;
+    pos[1] += vel[1] * dt;
+
+    // Clamp to screen
+    if (pos[0] < 0) { pos[0] = 0; vel[0] = 0; }
+    if (pos[1] < 0) { pos[1] = 0; vel[1] = 0; }
+    if (pos[0] > width) { pos[0] = width; vel[0] = 0; }
+    if (pos[1] > height) { pos[1] = height; vel[1] = 0; }
+}
+
+void air_motion_init(struct air_motion *m)
+{
+    m->bias[0] = m->bias[1] = m->bias[2] = 0.0f;
+    m->still_s = 0.0f;
+    m->bias_count = 0;
+    m->bias_valid = 0;
+}
+
+static void track_bias(struct air_motion *m, const float gyro[3], float dt)
+{
+    float limit = m->bias_valid ? AIR_STILL_RATE : AIR_STILL_RATE_COLD;
+    float d[3], n;
+
+    for (int i = 0; i < 3; i++) d[i] = gyro[i] - m->bias[i];
+    n = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+    if (n > limit) {
+        m->still_s = 0.0f;
+        if (!m->bias_valid) m->bias_count = 0;
+        return;
+    }
+    m->still_s += dt;
+    if (m->still_s < AIR_STILL_S && m->bias_valid) return;
+
+    if (!m->bias_valid) {
+        // Running mean; the reference moves with it, which is fine at rest
+        m->bias_count++;
+        for (int i = 0; i < 3; i++) m->bias[i] += d[i] / (float)m->bias_count;
+        if (m->still_s >= AIR_STILL_S) m->bias_valid = 1;
+        return;
+    }
+
+    float k = dt / AIR_BIAS_TAU_S;
+    if (k > 1.0f) k = 1.0f;
+    for (int i = 0; i < 3; i++) m->bias[i] += k * d[i];
+}
+
+int air_motion_update(struct air_motion *m, const float gyro[3], float dt,
+                      float vel[2])
+{
+    float rate[3], screen[2];
+
+    track_bias(m, gyro, dt);
+    if (!m->bias_valid) {
+        vel[0] = vel[1] = 0.0f;
+        return 0;
+    }
+
+    for (int i = 0; i < 3; i++) rate[i] = gyro[i] - m->bias[i];
+    air_axes(rate, screen);
+
+    float speed = sqrtf(screen[0] * screen[0] + screen[1] * screen[1]);
+    if (speed < AIR_DEADBAND) {
+        vel[0] = vel[1] = 0.0f;
+        return 1;
+    }
+
+    // Soft deadband so speed picks up from zero, then the gain curve
+    float t = (speed - AIR_SPEED_SLOW) / (AIR_SPEED_FAST - AIR_SPEED_SLOW);
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    float gain = AIR_GAIN_SLOW + (AIR_GAIN_FAST - AIR_GAIN_SLOW) * t * t * (3.0f - 2.0f * t);
+    float scale = gain * (speed - AIR_DEADBAND) / speed;
+
+    vel[0] = screen[0] * scale;
+    vel[1] = screen[1] * scale;
+    return 1;
+}
@@ -0,0 +1,64 @@
+// Created by Robbie Leslie 2025
+
+#ifndef CURSOR_MOTION_H
+#define CURSOR_MOTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* How a glove moves its cursor. No raylib, so the host tools can run the
+   same code (microcontroller/host/cursor_bench.c). Velocities are screen
+   pixels per second, x right, y down.
+
+   CURSOR_MODE_ACCEL integrates gravity-free acceleration twice; it needs
+   damping and deadzones to stay put, which costs lag.
+   CURSOR_MODE_AIR turns the glove's angular rate straight into cursor
+   speed, like an air mouse: nothing is integrated, so it cannot drift
+   once the gyro bias is tracked. */
+// Acceleration mode tuning
+#define CURSOR_ACCEL_SCALE    2700.0f
+#define CURSOR_DAMPING        0.9f
+#define CURSOR_VEL_DEADZONE   8.0f
+#define CURSOR_ACCEL_DEADZONE 0.05f
+#define CURSOR_MAX_VEL        2500.0f
+// Damping is per step at this rate, scaled to the real dt
+#define CURSOR_TUNED_RATE_HZ  60.0f
+
+enum cursor_mode {
+    CURSOR_MODE_ACCEL,
+    CURSOR_MODE_AIR,
+};
+
+// Glove accel x/y (m/s^2) to screen axes, x right and y up
+void cursor_accel_axes(const float accel[3], float out[2]);
+
+// One acceleration step: lin is accel along the screen axes (x right,
+// y down) with gravity and the at-rest offset removed. Updates vel in place.
+void accel_motion_step(float vel[2], const float lin[2], float dt);
+
+// Move by vel for dt and stop at the screen edges
+void cursor_position_step(float pos[2], float vel[2], float dt,
+                          float width, float height);
+
+struct air_motion {
+    float bias[3];      /* gyro bias, rad/s */
+    float still_s;      /* how long the glove has been held still */
+    int bias_count;     /* still samples averaged into the first bias */
+    int bias_valid;
+};
+
+void air_motion_init(struct air_motion *m);
+
+/* gyro in rad/s. Tracks the bias while the glove is still and sets vel.
+   Returns 1 once a bias has been learned; before that vel is 0. */
+int air_motion_update(struct air_motion *m, const float gyro[3], float dt,
+                      float vel[2]);
+
+const char *cursor_mode_name(int mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+// Created by Robbie Leslie 2025
+
+#include "cursor_predict.h"
+#include <math.h>
+
+void cursor_predict_gains(float lambda, float *alpha, float *beta)
+{
+    float r = (4.0f + lambda - sqrtf(8.0f * lambda + lambda * lambda)) / 4.0f;
+
+    *alpha = 1.0f - r * r;
+    *beta = 2.0f * (1.0f - r) * (1.0f - r);
+}
+
+void cursor_predict_init(struct cursor_predict *p, float lambda)
+{
+    cursor_predict_gains(lambda, &p->alpha, &p->beta);
+    cursor_predict_reset(p);
+}
+
+void cursor_predict_reset(struct cursor_predict *p)
+{
+    p->pos[0] = p->pos[1] = 0.0f;
+    p->vel[0] = p->vel[1] = 0.0f;
+    p->initialized = 0;
+}
+
+void cursor_predict_update(struct cursor_predict *p, const float pos[2], float dt)
+{
+    if (!p->initialized || dt <= 0.0f) {
+        p->pos[0] = pos[0];
+        p->pos[1] = pos[1];
+        p->initialized = 1;
+        return;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        float predicted = p->pos[i] + p->vel[i] * dt;
+        float residual = pos[i] - predicted;
+
+        p->pos[i] = predicted + p->alpha * residual;
+        p->vel[i] += p->beta / dt * residual;
+    }
+}
+
+int cursor_predict_at(const struct cursor_predict *p, float lead, float out[2])
+{
+    if (!p->initialized) return 0;
+
+    if (lead < 0.0f) lead = 0.0f;
+    if (lead > CURSOR_PREDICT_MAX_LEAD) lead = CURSOR_PREDICT_MAX_LEAD;
+    out[0] = p->pos[0] + p->vel[0] * lead;
+    out[1] = p->pos[1] + p->vel[1] * lead;
+    return 1;
+}
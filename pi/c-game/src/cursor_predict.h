@@ -0,0 +1,52 @@
+// Created by Robbie Leslie 2025
+
+#ifndef CURSOR_PREDICT_H
+#define CURSOR_PREDICT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Latency compensation for a cursor. By the time a frame is on screen the
+   newest glove sample is radio, dongle, USB, parsing and up to a frame of
+   render queueing old, so the cursor is drawn where the hand was. An
+   alpha-beta filter tracks the cursor's position and velocity from every
+   sample and extrapolates to the time the frame will be shown.
+
+   The gains are the steady-state Kalman gains of a constant-velocity model
+   (Kalata), set by one tracking index:
+     lambda = sigma_accel * dt^2 / sigma_meas
+   Small lambda trusts the model (smooth, slow to turn), large lambda trusts
+   the samples. No raylib, so microcontroller/host/predict_eval.c can score
+   it on recorded captures. Positions in pixels, times in seconds. */
+
+#define CURSOR_PREDICT_LAMBDA   2.0f    /* default tracking index */
+#define CURSOR_PREDICT_MAX_LEAD 0.05f   /* never extrapolate further, s */
+
+struct cursor_predict {
+    float alpha, beta;
+    float pos[2];
+    float vel[2];       /* px/s */
+    int initialized;
+};
+
+// Steady-state alpha and beta for tracking index lambda (> 0)
+void cursor_predict_gains(float lambda, float *alpha, float *beta);
+
+void cursor_predict_init(struct cursor_predict *p, float lambda);
+
+// Forget the track, e.g. after the cursor was moved by hand
+void cursor_predict_reset(struct cursor_predict *p);
+
+// One measured position, dt after the last one
+void cursor_predict_update(struct cursor_predict *p, const float pos[2], float dt);
+
+// Position lead seconds after the last update; lead is capped at
+// CURSOR_PREDICT_MAX_LEAD. Returns 0 (and leaves out alone) with no track.
+int cursor_predict_at(const struct cursor_predict *p, float lead, float out[2]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,16 +7,46 @@
 #include <termios.h>
 #include <errno.h>
 #include <math.h>
+#include <time.h>
 
 #include "dongleparse.h"
 
 #define HEADER0 0x77
 #define HEADER1 0x55
 #define HEADER2 0xAA
+#define HEADER2_EXT 0xAB   // extended frame: type + len + body
 
 #define PAYLOAD_SIZE 28   // 1 + 1 + 2 + 6*4
 #define CRC_SIZE 2
 
+// Extended frame types, see microcontroller/common/glove_proto.h
+#define EXT_TYPE_AHRS 1
+#define AHRS_BODY_SIZE 32  // 1 + 1 + 2 + 7*4
+#define EXT_TYPE_GESTURE 2
+#define GESTURE_BODY_SIZE 12  // 1 + 1 + 1 + 4 + 3 + 2
+#define EXT_TYPE_STATS 3
+#define STATS_BODY_SIZE (4 + 2 + 2 + DP_PIPES * 12)
+#define EXT_TYPE_SAMPLE_TS 4
+#define SAMPLE_TS_BODY_SIZE (4 + 4 + 4 + 6 * 4)
+#define EXT_TYPE_MULTI 5
+#define MULTI_ENTRY_SIZE (1 + 2 + 6 * 4)  // button:u8 seq:u16 accel:3f gyro:3f
+#define EXT_TYPE_GLOVE_STATUS 6
+#define GLOVE_STATUS_BODY_SIZE (1 + 1 + 1 + 7)  // pipe, id, rejected, settings
+#define SETTINGS_SIZE 7  // odr:u16 accel_fs:u8 gyro_fs:u16 batch:u8 stream:u8
+#define EXT_TYPE_BUTTON 7
+#define BUTTON_BODY_SIZE (1 + 1 + 1 + 4 + 4)  // pipe, seq, pressed, t_us, age_us
+
+// Host -> dongle commands, same extended framing
+#define CMD_GLOVE_CONFIG 1
+
+// Glove payload kinds for enum dp_stream, see glove_proto.h
+#define KIND_RAW 0
+#define KIND_AHRS 1
+#define KIND_RAW_AHRS 2
+
+// Clock offset creep per timed sample, well above crystal drift at 100 Hz
+#define LATENCY_OFFSET_CREEP_US 1
+
 static uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
     uint16_t crc = 0xFFFF;
     for (size_t i = 0; i < len; ++i) {
@@ -45,7 +75,8 @@ static ssize_t read_exact(int fd, void *buf, size_t n) {
 }
 
 static int open_serial(const char *path, int baud) {
-    int fd = open(path, O_RDONLY | O_NOCTTY);
+    // Written to for dp_set_glove_config
+    int fd = open(path, O_RDWR | O_NOCTTY);
     if (fd < 0) return -1;
     struct termios tty;
     if (tcgetattr(fd, &tty) != 0) { close(fd); return -1; }
@@ -68,17 +99,240 @@ static int open_serial(const char *path, int baud) {
 }
 // ...existing code...
 
+/* Rest of the last combined frame, handed out by dp_read_packet before it
+   reads again */
+static struct {
+    int fd;
+    int next;
+    struct dp_multi multi;
+} pending = { -1, 0, { 0 } };
+
 int dp_open(const char *path, int baud) {
-    return open_serial(path, baud);
+    int fd = open_serial(path, baud);
+    // A reopened device can get the fd number back
+    if (fd >= 0 && pending.fd == fd) pending.fd = -1;
+    return fd;
 }
 
 void dp_close(int fd) {
     if (fd >= 0) close(fd);
 }
 
-/* Blocking read of next valid packet; removes main() and returns parsed data */
-int dp_read_packet(int fd, struct dp_packet *pkt) {
-    if (fd < 0 || pkt == NULL) return -1;
+/* Reject values no IMU can produce; a CRC match on garbage is rare but not impossible */
+static int values_bad(const float *vals, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (isnan(vals[i]) || isinf(vals[i]) || fabs(vals[i]) > 1e5f) return 1;
+    }
+    return 0;
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/* Parse a legacy sample payload. Returns 1 if valid. */
+static int parse_sample(const uint8_t *buf, struct dp_packet *pkt) {
+    // parse payload (little-endian)
+    pkt->pipe = buf[0];
+    pkt->button = buf[1];
+    pkt->seq = (uint16_t)buf[2] | ((uint16_t)buf[3] << 8);
+
+    /* Read 6 floats: accel x,y,z then gyro x,y,z */
+    float vals[6];
+    for (int i = 0; i < 6; ++i) {
+        memcpy(&vals[i], &buf[4 + i*4], sizeof(float));
+    }
+
+    // sanity check
+    if (values_bad(vals, 6)) return 0;
+
+    // map into accel / gyro structs
+    pkt->accel.x = vals[0];
+    pkt->accel.y = vals[1];
+    pkt->accel.z = vals[2];
+    pkt->gyro.x  = vals[3];
+    pkt->gyro.y  = vals[4];
+    pkt->gyro.z  = vals[5];
+    pkt->timed = 0;
+    pkt->rx_us = 0;
+    pkt->out_us = 0;
+
+    return 1;
+}
+
+/* pipe:u8 button:u8 seq:u16 q:4f lin_accel:3f */
+static int parse_ahrs(const uint8_t *body, size_t len, struct dp_ahrs *ahrs) {
+    if (len < AHRS_BODY_SIZE) return 0;
+
+    ahrs->pipe = body[0];
+    ahrs->button = body[1];
+    ahrs->seq = (uint16_t)body[2] | ((uint16_t)body[3] << 8);
+
+    float vals[7];
+    memcpy(vals, &body[4], sizeof(vals));
+    if (values_bad(vals, 7)) return 0;
+
+    for (int i = 0; i < 4; ++i) ahrs->q[i] = vals[i];
+    ahrs->lin_accel.x = vals[4];
+    ahrs->lin_accel.y = vals[5];
+    ahrs->lin_accel.z = vals[6];
+
+    return 1;
+}
+
+/* pipe:u8 button:u8 type:u8 t_ms:u32 dir:3*i8 magnitude:u16 (0.01 m/s^2) */
+static int parse_gesture(const uint8_t *body, size_t len, struct dp_gesture *g) {
+    if (len < GESTURE_BODY_SIZE) return 0;
+
+    g->pipe = body[0];
+    g->button = body[1];
+    g->type = body[2];
+    g->t_ms = (uint32_t)body[3] | ((uint32_t)body[4] << 8) |
+              ((uint32_t)body[5] << 16) | ((uint32_t)body[6] << 24);
+    g->dir.x = (int8_t)body[7] / 127.0f;
+    g->dir.y = (int8_t)body[8] / 127.0f;
+    g->dir.z = (int8_t)body[9] / 127.0f;
+    g->magnitude = ((uint16_t)body[10] | ((uint16_t)body[11] << 8)) / 100.0f;
+
+    return 1;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* uptime_ms:u32 ring_high_water:u16 ring_size:u16
+   then per pipe: received:u32 queue_dropped:u32 fifo_overrun:u32 */
+static int parse_stats(const uint8_t *body, size_t len, struct dp_stats *st) {
+    if (len < STATS_BODY_SIZE) return 0;
+
+    st->uptime_ms = get_u32(&body[0]);
+    st->ring_high_water = (uint16_t)body[4] | ((uint16_t)body[5] << 8);
+    st->ring_size = (uint16_t)body[6] | ((uint16_t)body[7] << 8);
+    for (int i = 0; i < DP_PIPES; ++i) {
+        const uint8_t *p = &body[8 + i * 12];
+        st->pipe[i].received = get_u32(&p[0]);
+        st->pipe[i].queue_dropped = get_u32(&p[4]);
+        st->pipe[i].fifo_overrun = get_u32(&p[8]);
+    }
+
+    return 1;
+}
+
+/* pipe:u8 button:u8 seq:u16 rx_us:u32 out_us:u32 accel:3f gyro:3f */
+static int parse_sample_ts(const uint8_t *body, size_t len, struct dp_packet *pkt) {
+    if (len < SAMPLE_TS_BODY_SIZE) return 0;
+
+    // Same layout as the legacy payload once the two times are taken out
+    uint8_t buf[PAYLOAD_SIZE];
+    memcpy(buf, body, 4);
+    memcpy(&buf[4], &body[12], 6 * 4);
+    if (!parse_sample(buf, pkt)) return 0;
+
+    pkt->timed = 1;
+    pkt->rx_us = get_u32(&body[4]);
+    pkt->out_us = get_u32(&body[8]);
+
+    return 1;
+}
+
+/* present:u8, then button:u8 seq:u16 accel:3f gyro:3f for each set bit */
+static int parse_multi(const uint8_t *body, size_t len, struct dp_multi *m) {
+    if (len < 1) return 0;
+
+    m->present = body[0];
+    m->count = 0;
+    size_t off = 1;
+    for (int pipe = 0; pipe < DP_PIPES; ++pipe) {
+        if (!(m->present & (1u << pipe))) continue;
+        if (off + MULTI_ENTRY_SIZE > len) return 0;
+
+        // Entry is the legacy payload without its pipe byte
+        uint8_t buf[PAYLOAD_SIZE];
+        buf[0] = (uint8_t)pipe;
+        memcpy(&buf[1], &body[off], MULTI_ENTRY_SIZE);
+        off += MULTI_ENTRY_SIZE;
+
+        // One bad entry only costs that glove its sample
+        if (parse_sample(buf, &m->sample[m->count])) m->count++;
+    }
+
+    return m->count > 0;
+}
+
+static enum dp_stream stream_from_kind(uint8_t kind) {
+    switch (kind) {
+        case KIND_RAW: return DP_STREAM_RAW;
+        case KIND_AHRS: return DP_STREAM_AHRS;
+        case KIND_RAW_AHRS: return DP_STREAM_RAW_AHRS;
+        default: return DP_STREAM_UNCHANGED;
+    }
+}
+
+/* pipe:u8 id:u8 rejected:u8 odr:u16 accel_fs:u8 gyro_fs:u16 batch:u8 stream:u8 */
+static int parse_glove_status(const uint8_t *body, size_t len, struct dp_glove_status *st) {
+    if (len < GLOVE_STATUS_BODY_SIZE) return 0;
+
+    st->pipe = body[0];
+    st->id = body[1];
+    st->rejected = body[2];
+    st->odr_hz = (uint16_t)body[3] | ((uint16_t)body[4] << 8);
+    st->accel_fs_g = body[5];
+    st->gyro_fs_dps = (uint16_t)body[6] | ((uint16_t)body[7] << 8);
+    st->batch = body[8];
+    st->stream = stream_from_kind(body[9]);
+
+    return 1;
+}
+
+/* pipe:u8 seq:u8 pressed:u8 t_us:u32 age_us:u32 */
+static int parse_button(const uint8_t *body, size_t len, struct dp_button *b) {
+    if (len < BUTTON_BODY_SIZE) return 0;
+
+    b->pipe = body[0];
+    b->seq = body[1];
+    b->pressed = body[2] ? 1 : 0;
+    b->t_us = get_u32(&body[3]);
+    b->age_us = get_u32(&body[7]);
+
+    return 1;
+}
+
+/* Extended frame body. Returns 1 if it produced a frame, 0 to keep searching. */
+static int parse_ext(uint8_t type, const uint8_t *body, size_t len, struct dp_frame *frame) {
+    switch (type) {
+        case EXT_TYPE_AHRS:
+            frame->type = DP_FRAME_AHRS;
+            return parse_ahrs(body, len, &frame->u.ahrs);
+        case EXT_TYPE_GESTURE:
+            frame->type = DP_FRAME_GESTURE;
+            return parse_gesture(body, len, &frame->u.gesture);
+        case EXT_TYPE_STATS:
+            frame->type = DP_FRAME_STATS;
+            return parse_stats(body, len, &frame->u.stats);
+        case EXT_TYPE_SAMPLE_TS:
+            frame->type = DP_FRAME_SAMPLE;
+            return parse_sample_ts(body, len, &frame->u.sample);
+        case EXT_TYPE_MULTI:
+            frame->type = DP_FRAME_MULTI;
+            return parse_multi(body, len, &frame->u.multi);
+        case EXT_TYPE_GLOVE_STATUS:
+            frame->type = DP_FRAME_GLOVE_STATUS;
+            return parse_glove_status(body, len, &frame->u.glove_status);
+        case EXT_TYPE_BUTTON:
+            frame->type = DP_FRAME_BUTTON;
+            return parse_button(body, len, &frame->u.button);
+        default:
+            return 0; // newer dongle firmware, frame type we don't know
+    }
+}
+
+/* Blocking read of next valid frame of any type */
+int dp_read_frame(int fd, struct dp_frame *frame) {
+    if (fd < 0 || frame == NULL) return -1;
 
     uint8_t sync[3] = {0};
     for (;;) {
@@ -91,53 +345,232 @@ int dp_read_packet(int fd, struct dp_packet *pkt) {
             sync[0] = sync[1];
             sync[1] = sync[2];
             sync[2] = b;
-            if (sync[0] == HEADER0 && sync[1] == HEADER1 && sync[2] == HEADER2) break;
+            if (sync[0] == HEADER0 && sync[1] == HEADER1 &&
+                (sync[2] == HEADER2 || sync[2] == HEADER2_EXT)) break;
         }
 
-        // read payload + crc
-        uint8_t buf[PAYLOAD_SIZE + CRC_SIZE];
-        ssize_t r = read_exact(fd, buf, sizeof(buf));
+        if (sync[2] == HEADER2) {
+            // read payload + crc
+            uint8_t buf[PAYLOAD_SIZE + CRC_SIZE];
+            ssize_t r = read_exact(fd, buf, sizeof(buf));
+            if (r < 0) return -1;
+            if (r == 0) return 0;
+            if (r != (ssize_t)sizeof(buf)) return -1;
+
+            uint16_t crc_recv = (uint16_t)buf[PAYLOAD_SIZE] | ((uint16_t)buf[PAYLOAD_SIZE + 1] << 8);
+            uint16_t crc_calc = crc16_ccitt(buf, PAYLOAD_SIZE);
+            if (crc_calc != crc_recv) {
+                // discard and keep searching
+                continue;
+            }
+
+            if (!parse_sample(buf, &frame->u.sample)) continue;
+            frame->type = DP_FRAME_SAMPLE;
+            frame->u.sample.host_us = now_us();
+            return 1; // success
+        }
+
+        // extended frame: type + len, then body + crc
+        uint8_t buf[2 + UINT8_MAX + CRC_SIZE];
+        ssize_t r = read_exact(fd, buf, 2);
         if (r < 0) return -1;
         if (r == 0) return 0;
-        if (r != (ssize_t)sizeof(buf)) return -1;
 
-        uint16_t crc_recv = (uint16_t)buf[PAYLOAD_SIZE] | ((uint16_t)buf[PAYLOAD_SIZE + 1] << 8);
-        uint16_t crc_calc = crc16_ccitt(buf, PAYLOAD_SIZE);
-        if (crc_calc != crc_recv) {
-            // discard and keep searching
-            continue;
-        }
+        size_t len = buf[1];
+        r = read_exact(fd, &buf[2], len + CRC_SIZE);
+        if (r < 0) return -1;
+        if (r == 0) return 0;
 
-        // parse payload (little-endian)
-        pkt->pipe = buf[0];
-        pkt->button = buf[1];
-        pkt->seq = (uint16_t)buf[2] | ((uint16_t)buf[3] << 8);
+        uint16_t crc_recv = (uint16_t)buf[2 + len] | ((uint16_t)buf[2 + len + 1] << 8);
+        if (crc16_ccitt(buf, 2 + len) != crc_recv) continue;
 
-        /* Read 6 floats: accel x,y,z then gyro x,y,z */
-        float vals[6];
-        for (int i = 0; i < 6; ++i) {
-            memcpy(&vals[i], &buf[4 + i*4], sizeof(float));
+        if (parse_ext(buf[0], &buf[2], len, frame)) {
+            uint64_t t = now_us();
+            if (frame->type == DP_FRAME_SAMPLE) frame->u.sample.host_us = t;
+            if (frame->type == DP_FRAME_BUTTON) frame->u.button.host_us = t;
+            if (frame->type == DP_FRAME_MULTI) {
+                for (int i = 0; i < frame->u.multi.count; ++i) frame->u.multi.sample[i].host_us = t;
+            }
+            return 1;
         }
+    }
+    // unreachable
+    return -1;
+}
+
+void dp_button_queue_init(struct dp_button_queue *q) {
+    memset(q, 0, sizeof(*q));
+}
+
+int dp_button_push(struct dp_button_queue *q, const struct dp_button *ev) {
+    uint8_t pipe = ev->pipe % DP_PIPES;
+
+    // The dongle passes each edge on once; count what the glove lost
+    if (q->seen & (1u << pipe)) {
+        uint8_t gap = (uint8_t)(ev->seq - q->last_seq[pipe]);
+        if (gap > 1 && gap < 128) q->missed[pipe] += gap - 1u;
+    }
+    q->seen |= (uint8_t)(1u << pipe);
+    q->last_seq[pipe] = ev->seq;
+
+    unsigned head = q->head;
+    if (head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) == DP_BUTTON_QUEUE) {
+        q->overflow++;
+        return 0;
+    }
+    q->ev[head % DP_BUTTON_QUEUE] = *ev;
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int dp_button_pop(struct dp_button_queue *q, struct dp_button *ev) {
+    unsigned tail = q->tail;
+    if (tail == __atomic_load_n(&q->head, __ATOMIC_ACQUIRE)) return 0;
+
+    *ev = q->ev[tail % DP_BUTTON_QUEUE];
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Blocking read of next valid packet; removes main() and returns parsed data */
+int dp_read_packet(int fd, struct dp_packet *pkt) {
+    return dp_read_input(fd, pkt, NULL);
+}
+
+int dp_read_input(int fd, struct dp_packet *pkt, struct dp_button_queue *q) {
+    if (fd < 0 || pkt == NULL) return -1;
+
+    if (pending.fd == fd && pending.next < pending.multi.count) {
+        *pkt = pending.multi.sample[pending.next++];
+        return 1;
+    }
 
-        // sanity check
-        int bad = 0;
-        for (int i = 0; i < 6; ++i) {
-            if (isnan(vals[i]) || isinf(vals[i]) || fabs(vals[i]) > 1e5f) { bad = 1; break; }
+    struct dp_frame frame;
+    for (;;) {
+        int r = dp_read_frame(fd, &frame);
+        if (r != 1) return r;
+        if (frame.type == DP_FRAME_SAMPLE) {
+            *pkt = frame.u.sample;
+            return 1;
         }
-        if (bad) {
+        if (frame.type == DP_FRAME_BUTTON && q != NULL) {
+            dp_button_push(q, &frame.u.button);
             continue;
         }
+        if (frame.type == DP_FRAME_MULTI) {
+            pending.fd = fd;
+            pending.multi = frame.u.multi;
+            pending.next = 1;
+            *pkt = pending.multi.sample[0];
+            return 1;
+        }
+    }
+}
 
-        // map into accel / gyro structs
-        pkt->accel.x = vals[0];
-        pkt->accel.y = vals[1];
-        pkt->accel.z = vals[2];
-        pkt->gyro.x  = vals[3];
-        pkt->gyro.y  = vals[4];
-        pkt->gyro.z  = vals[5];
+void dp_latency_init(struct dp_latency *lat) {
+    memset(lat, 0, sizeof(*lat));
+}
+
+int dp_latency_update(struct dp_latency *lat, const struct dp_packet *pkt) {
+    if (lat == NULL || pkt == NULL || !pkt->timed) return 0;
 
-        return 1; // success
+    int64_t offset = (int64_t)pkt->host_us - pkt->out_us;
+    if (!lat->have_offset) {
+        lat->clock_offset_us = offset;
+        lat->have_offset = 1;
+    } else {
+        // out_us wraps every ~71 minutes; an offset jump that size is a wrap
+        int64_t step = offset - lat->clock_offset_us;
+        if (step > (int64_t)INT32_MAX || step < -(int64_t)INT32_MAX) {
+            lat->clock_offset_us += step > 0 ? ((int64_t)1 << 32) : -((int64_t)1 << 32);
+        }
+        lat->clock_offset_us += LATENCY_OFFSET_CREEP_US;
+        if (offset < lat->clock_offset_us) lat->clock_offset_us = offset;
     }
-    // unreachable
-    return -1;
-}
\ No newline at end of file
+
+    lat->dongle_us = pkt->out_us - pkt->rx_us;
+    lat->usb_us = (uint32_t)(offset - lat->clock_offset_us);
+
+    uint8_t pipe = pkt->pipe % DP_PIPES;
+    uint32_t interval = pkt->rx_us - lat->last_rx_us[pipe];
+    // Samples unpacked from one radio packet share rx_us; keep the packet spacing
+    if (interval != 0) {
+        lat->rx_interval_us[pipe] = lat->last_rx_us[pipe] ? interval : 0;
+        lat->last_rx_us[pipe] = pkt->rx_us;
+    }
+
+    return 1;
+}
+
+static ssize_t write_all(int fd, const uint8_t *buf, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t w = write(fd, buf + done, n - done);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += w;
+    }
+    return (ssize_t)done;
+}
+
+int dp_set_glove_config(int fd, uint8_t pipe, const struct dp_glove_config *cfg) {
+    // Ids only need to differ from the last one sent to the same glove. The
+    // glove remembers that across host restarts, so a restarted host starting
+    // from 0 could repeat it and be ignored: start somewhere random instead.
+    static uint8_t next_id[DP_PIPES];
+    static int seeded = 0;
+
+    if (fd < 0 || cfg == NULL || pipe >= DP_PIPES) return -1;
+
+    if (!seeded) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint32_t x = (uint32_t)ts.tv_nsec ^ (uint32_t)ts.tv_sec * 2654435761u ^
+                     (uint32_t)getpid() * 40503u;
+        for (int i = 0; i < DP_PIPES; i++) {
+            x = x * 1664525u + 1013904223u;
+            next_id[i] = (uint8_t)(x >> 24);
+        }
+        seeded = 1;
+    }
+
+    uint8_t fields = 0;
+    if (cfg->odr_hz) fields |= DP_CONFIG_ODR;
+    if (cfg->accel_fs_g) fields |= DP_CONFIG_ACCEL_FS;
+    if (cfg->gyro_fs_dps) fields |= DP_CONFIG_GYRO_FS;
+    if (cfg->batch) fields |= DP_CONFIG_BATCH;
+    if (cfg->stream != DP_STREAM_UNCHANGED) fields |= DP_CONFIG_STREAM;
+
+    uint8_t kind = KIND_RAW;
+    if (cfg->stream == DP_STREAM_AHRS) kind = KIND_AHRS;
+    if (cfg->stream == DP_STREAM_RAW_AHRS) kind = KIND_RAW_AHRS;
+
+    uint8_t id = next_id[pipe]++;
+    uint8_t msg[3 + 2 + 3 + SETTINGS_SIZE + CRC_SIZE];
+    size_t n = 0;
+
+    msg[n++] = HEADER0;
+    msg[n++] = HEADER1;
+    msg[n++] = HEADER2_EXT;
+    msg[n++] = CMD_GLOVE_CONFIG;
+    msg[n++] = 3 + SETTINGS_SIZE;
+    msg[n++] = pipe;
+    msg[n++] = id;
+    msg[n++] = fields;
+    msg[n++] = (uint8_t)(cfg->odr_hz & 0xFF);
+    msg[n++] = (uint8_t)(cfg->odr_hz >> 8);
+    msg[n++] = cfg->accel_fs_g;
+    msg[n++] = (uint8_t)(cfg->gyro_fs_dps & 0xFF);
+    msg[n++] = (uint8_t)(cfg->gyro_fs_dps >> 8);
+    msg[n++] = cfg->batch;
+    msg[n++] = kind;
+
+    uint16_t crc = crc16_ccitt(&msg[3], n - 3);
+    msg[n++] = (uint8_t)(crc & 0xFF);
+    msg[n++] = (uint8_t)(crc >> 8);
+
+    if (write_all(fd, msg, n) != (ssize_t)n) return -1;
+    return id;
+}
@@ -71,7 +71,7 @@ int UpdateFruitPosition(Fruit *fruit){
     return 1;
 }
 
-bool CursorColision(IMUCursor *cursor, Fruit *fruit){
+bool CursorColision(const IMUCursor *cursor, Fruit *fruit){
     bool isColliding = CheckCollisionCircles(cursor->pos, cursor->rad, fruit->pos, FRUIT_DEFS[fruit->type].radius);
     
     bool hit = isColliding && !fruit->wasHit;
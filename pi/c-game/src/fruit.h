@@ -42,6 +42,6 @@ void DrawFruit(Fruit *fruit);
  */
 int UpdateFruitPosition(Fruit *fruit);
 
-bool CursorColision(IMUCursor *cursor, Fruit *fruit);
+bool CursorColision(const IMUCursor *cursor, Fruit *fruit);
 
 #endif
\ No newline at end of file
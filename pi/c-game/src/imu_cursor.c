@@ -6,33 +6,45 @@
 #include <stdio.h>
 #include <math.h>
 #include <pthread.h>
+#include <string.h>
+#include <time.h>
 
-// Shared tuning parameters
-static const int IMU_CALIB_SAMPLES   = 120;
-static const float ACCEL_SCALE       = 2700.0f;
-static const float VELOCITY_DAMPING  = 0.9f;
-static const float VELOCITY_DEADZONE = 8.0f;
-static const float ACCEL_DEADZONE    = 0.05f;
-static const float MAX_VEL           = 2500.0f;
-static const float HP_ALPHA          = 0.995f;
+// Sample clock. Arrival spacing is averaged over a window because batched
+// samples arrive together; a longer silence than SAMPLE_GAP_S is a dropout,
+// not time to integrate over.
+static const float SAMPLE_PERIOD_DEFAULT = 1.0f / 104.0f;
+static const float SAMPLE_PERIOD_MIN     = 1.0f / 2000.0f;
+static const float SAMPLE_PERIOD_MAX     = 0.1f;
+static const float SAMPLE_GAP_S          = 0.1f;
+static const int   SAMPLE_WINDOW         = 64;
+static const float SAMPLE_PERIOD_GAIN    = 0.25f;
+// A window this far off is a rate change (one the glove refused, say), not
+// jitter: take it outright instead of easing over several windows
+static const float SAMPLE_PERIOD_SNAP    = 0.25f;
+
+// Gravity removal, see imu_gravity.h
+static const int CURSOR_GRAVITY_MODE = IMU_GRAVITY_MAHONY;
+
+// How often a glove's refined bias is written back to the cache
+static const int CALIB_STORE_S = 60;
+
+// Bias drift per glove over the whole run
+static struct bias_metrics metrics[DP_PIPES];
+
+// Movement for new cursors, see cursor_motion.h
+static int default_mode = CURSOR_MODE_ACCEL;
+
+// Prediction for new cursors, see cursor_predict.h; off by default
+static float predict_lambda = 0.0f;
+static float predict_pipe_s = CURSOR_PIPE_LATENCY_S;
 
 static Vector2 TransformImuAccel(Vector2 raw)
 {
-    // EXAMPLE: IMU rotated 90° clockwise relative to original
-    //   old_x -> -new_y
-    //   old_y ->  new_x
-    // Return (world_x, world_y)
-    return (Vector2){ -raw.y, raw.x };
+    float in[3] = { raw.x, raw.y, 0.0f };
+    float out[2];
 
-    // Other common cases (pick ONE and delete the rest):
-    // 180° rotation:
-    // return (Vector2){ -raw.x, -raw.y };
-    // 90° CCW:
-    // return (Vector2){ -raw.y, raw.x };
-    // flipped X only:
-    // return (Vector2){ -raw.x, raw.y };
-    // flipped Y only:
-    // return (Vector2){ raw.x, -raw.y };
+    cursor_accel_axes(in, out);
+    return (Vector2){ out[0], out[1] };
 }
 
 void InitCursor(IMUCursor *cursor, Vector2 pos, Color color, const char *text)
@@ -40,113 +52,301 @@ void InitCursor(IMUCursor *cursor, Vector2 pos, Color color, const char *text)
     cursor->pos = pos;
     cursor->vel = (Vector2){0, 0};
     cursor->bias = (Vector2){0, 0};
-    cursor->calib_accum = (Vector2){0, 0};
-    cursor->lp_accel = (Vector2){0, 0};
-    cursor->calib_count = 0;
     cursor->calibrated = 0;
-    cursor->gravity_initialized = 0;
+    imu_gravity_init(&cursor->gravity, CURSOR_GRAVITY_MODE);
+    cursor->mode = default_mode;
+    air_motion_init(&cursor->air);
+    bias_tracker_init(&cursor->tracker);
+    cursor->pipe = -1;
+    cursor->calib_stored = 0;
+    cursor->cache_checking = 0;
+    cursor_predict_init(&cursor->predict, predict_lambda > 0 ? predict_lambda : CURSOR_PREDICT_LAMBDA);
+    cursor->predict_host_us = 0;
+    cursor->draw_pos = pos;
     cursor->debug_ax = cursor->debug_ay = 0;
     cursor->debug_linear_ax = cursor->debug_linear_ay = 0;
+    cursor->last_sample_us = 0;
+    cursor->window_start_us = 0;
+    cursor->window_count = 0;
+    cursor->have_sample = 0;
+    cursor->last_timed = 0;
+    cursor->sample_period = SAMPLE_PERIOD_DEFAULT;
     cursor->rad = 20;
     cursor->color = color;
     cursor->text = text; // Single char to tell which cursor this is
 }
 
-// Returns 1 if still calibrating, 0 if ready to process
-int UpdateCursorCalibration(IMUCursor *cursor, Vector2 accel)
-{   
-    Vector2 a = TransformImuAccel(accel);
+void SetCursorPrediction(float lambda, float pipe_latency_s)
+{
+    predict_lambda = lambda;
+    predict_pipe_s = pipe_latency_s;
+}
 
-    if (cursor->calibrated) return 0;
-    
-    cursor->calib_accum.x += a.x;
-    cursor->calib_accum.y += a.y;
-    cursor->calib_count++;
-    
-    if (cursor->calib_count >= IMU_CALIB_SAMPLES) {
-        cursor->bias.x = cursor->calib_accum.x / (float)IMU_CALIB_SAMPLES;
-        cursor->bias.y = cursor->calib_accum.y / (float)IMU_CALIB_SAMPLES;
-        cursor->calibrated = 1;
-    }
-    return 1; // Still calibrating
+void SetCursorMode(IMUCursor *cursor, int mode)
+{
+    cursor->mode = mode;
+    cursor->vel = (Vector2){0, 0};
+    cursor->bias = (Vector2){0, 0};
+    cursor->calibrated = 0;
+    imu_gravity_init(&cursor->gravity, CURSOR_GRAVITY_MODE);
+    air_motion_init(&cursor->air);
+    bias_tracker_init(&cursor->tracker);
+    cursor->calib_stored = 0;
+    cursor->cache_checking = 0;
+    cursor_predict_reset(&cursor->predict);
+    cursor->draw_pos = cursor->pos;
 }
 
-void InitCursors(IMUCursor *right_cursor, IMUCursor *left_cursor){
-    // Init cursors
-    Vector2 temp_pos = (Vector2){screenWidth/2 + 50, screenHeight/2};
-    InitCursor(right_cursor, temp_pos, PURPLE, "R");
-    
-    temp_pos = (Vector2){screenWidth/2 - 50, screenHeight/2};
-    InitCursor(left_cursor, temp_pos, BLUE, "L");
+void SetDefaultCursorMode(int mode)
+{
+    default_mode = mode;
+}
+
+static void MoveCursor(IMUCursor *cursor, float dt)
+{
+    float pos[2] = { cursor->pos.x, cursor->pos.y };
+    float vel[2] = { cursor->vel.x, cursor->vel.y };
+
+    cursor_position_step(pos, vel, dt, GetScreenWidth(), GetScreenHeight());
+    cursor->pos = (Vector2){ pos[0], pos[1] };
+    cursor->vel = (Vector2){ vel[0], vel[1] };
+}
+
+// Feed the sample's position to the predictor
+static void TrackCursor(IMUCursor *cursor, const struct dp_packet *pkt, float dt)
+{
+    float pos[2] = { cursor->pos.x, cursor->pos.y };
+
+    cursor_predict_update(&cursor->predict, pos, dt);
+    cursor->predict_host_us = pkt->host_us;
 }
 
 void UpdateCursorMovement(IMUCursor *cursor, Vector2 accel, float dt)
 {   
     Vector2 a = TransformImuAccel(accel);
 
-    // Subtract bias and apply orientation correction
-    float ax = (a.x - cursor->bias.x);
-    float ay = -(a.y - cursor->bias.y);  // Screen Y up
-    
-    cursor->debug_ax = ax;
-    cursor->debug_ay = ay;
-    
-    // Initialize gravity filter
-    if (!cursor->gravity_initialized) {
-        cursor->lp_accel.x = ax;
-        cursor->lp_accel.y = ay;
-        cursor->gravity_initialized = 1;
-        return;
-    }
-    
-    // High-pass filter for gravity removal
-    cursor->lp_accel.x = HP_ALPHA * cursor->lp_accel.x + (1.0f - HP_ALPHA) * ax;
-    cursor->lp_accel.y = HP_ALPHA * cursor->lp_accel.y + (1.0f - HP_ALPHA) * ay;
-    
-    float linear_ax = ax - cursor->lp_accel.x;
-    float linear_ay = ay - cursor->lp_accel.y;
+    cursor->debug_ax = a.x;
+    cursor->debug_ay = a.y;
+
+    // Subtract the at-rest offset and apply orientation correction
+    float linear_ax = (a.x - cursor->bias.x);
+    float linear_ay = -(a.y - cursor->bias.y);  // Screen Y down
     
     cursor->debug_linear_ax = linear_ax;
     cursor->debug_linear_ay = linear_ay;
     
-    // Apply deadzone
-    if (fabsf(linear_ax) < ACCEL_DEADZONE) linear_ax = 0.0f;
-    if (fabsf(linear_ay) < ACCEL_DEADZONE) linear_ay = 0.0f;
-    
-    // Integrate to velocity
-    cursor->vel.x += linear_ax * ACCEL_SCALE * dt;
-    cursor->vel.y += linear_ay * ACCEL_SCALE * dt;
-    
-    // Damping
-    cursor->vel.x *= VELOCITY_DAMPING;
-    cursor->vel.y *= VELOCITY_DAMPING;
-    
-    // Velocity deadzone
-    if (fabsf(cursor->vel.x) < VELOCITY_DEADZONE) cursor->vel.x = 0.0f;
-    if (fabsf(cursor->vel.y) < VELOCITY_DEADZONE) cursor->vel.y = 0.0f;
-    
-    // Clamp velocity
-    if (fabsf(cursor->vel.x) > MAX_VEL) cursor->vel.x = copysignf(MAX_VEL, cursor->vel.x);
-    if (fabsf(cursor->vel.y) > MAX_VEL) cursor->vel.y = copysignf(MAX_VEL, cursor->vel.y);
-    
-    // Integrate to position
-    cursor->pos.x += cursor->vel.x * dt;
-    cursor->pos.y += cursor->vel.y * dt;
-    
-    // Clamp to screen
-    if (cursor->pos.x < 0) { cursor->pos.x = 0; cursor->vel.x = 0; }
-    if (cursor->pos.y < 0) { cursor->pos.y = 0; cursor->vel.y = 0; }
-    if (cursor->pos.x > GetScreenWidth()) { cursor->pos.x = GetScreenWidth(); cursor->vel.x = 0; }
-    if (cursor->pos.y > GetScreenHeight()) { cursor->pos.y = GetScreenHeight(); cursor->vel.y = 0; }
+    float lin[2] = { linear_ax, linear_ay };
+    float vel[2] = { cursor->vel.x, cursor->vel.y };
+
+    accel_motion_step(vel, lin, dt);
+    cursor->vel = (Vector2){ vel[0], vel[1] };
+    MoveCursor(cursor, dt);
+}
+
+float CursorSampleDt(IMUCursor *cursor, const struct dp_packet *pkt)
+{
+    // The dongle's receive time has no USB jitter in it; use it when sent
+    uint64_t now = pkt->timed ? pkt->rx_us : pkt->host_us;
+
+    if (!cursor->have_sample || cursor->last_timed != pkt->timed) {
+        cursor->have_sample = 1;
+        cursor->last_timed = pkt->timed;
+        cursor->last_sample_us = now;
+        cursor->window_start_us = now;
+        cursor->window_count = 0;
+        return cursor->sample_period;
+    }
+
+    // rx_us wraps at 32 bits
+    uint64_t gap = pkt->timed ? (uint32_t)(now - cursor->last_sample_us)
+                              : now - cursor->last_sample_us;
+    cursor->last_sample_us = now;
+
+    if (gap > (uint64_t)(SAMPLE_GAP_S * 1e6f)) {
+        // Glove went quiet: don't coast on the old velocity across the gap
+        cursor->vel = (Vector2){0, 0};
+        cursor->window_start_us = now;
+        cursor->window_count = 0;
+        return cursor->sample_period;
+    }
+
+    if (++cursor->window_count >= SAMPLE_WINDOW) {
+        uint64_t span = pkt->timed ? (uint32_t)(now - cursor->window_start_us)
+                                   : now - cursor->window_start_us;
+        float measured = (float)span * 1e-6f / (float)cursor->window_count;
+
+        if (fabsf(measured - cursor->sample_period) > SAMPLE_PERIOD_SNAP * cursor->sample_period) {
+            cursor->sample_period = measured;
+        } else {
+            cursor->sample_period += SAMPLE_PERIOD_GAIN * (measured - cursor->sample_period);
+        }
+        if (cursor->sample_period < SAMPLE_PERIOD_MIN) cursor->sample_period = SAMPLE_PERIOD_MIN;
+        if (cursor->sample_period > SAMPLE_PERIOD_MAX) cursor->sample_period = SAMPLE_PERIOD_MAX;
+        cursor->window_start_us = now;
+        cursor->window_count = 0;
+    }
+    return cursor->sample_period;
+}
+
+// Take this glove's cached calibration, if there is a fresh one
+static void ApplyCachedCalibration(IMUCursor *cursor)
+{
+    const struct calib_entry *e = calib_cache_get(cursor->pipe, time(NULL));
+
+    if (!e) return;
+    memcpy(cursor->air.bias, e->gyro_bias, sizeof(cursor->air.bias));
+    cursor->air.bias_valid = 1;
+    imu_gravity_set_gyro_bias(&cursor->gravity, e->gyro_bias);
+    if (e->have_accel) {
+        cursor->bias = (Vector2){ e->accel_bias[0], e->accel_bias[1] };
+        bias_tracker_seed(&cursor->tracker, e->accel_bias, e->gyro_bias, e->gravity_norm);
+    }
+    cursor->calibrated = 1;
+    cursor->cache = *e;
+    cursor->cache_checking = 1;
+    calib_check_init(&cursor->check);
+}
+
+// Keep the tracked bias for the next screen and the next run
+static void StoreCalibration(IMUCursor *cursor)
+{
+    struct calib_entry e;
+
+    if (cursor->pipe < 0 || !cursor->tracker.valid) return;
+    memset(&e, 0, sizeof(e));
+    e.pipe = (uint8_t)cursor->pipe;
+    e.saved = time(NULL);
+    e.have_accel = 1;
+    memcpy(e.accel_bias, cursor->tracker.accel_bias, sizeof(e.accel_bias));
+    memcpy(e.gyro_bias, cursor->tracker.gyro_bias, sizeof(e.gyro_bias));
+    e.gravity_norm = cursor->tracker.gravity_norm;
+    calib_cache_put(&e);
+    cursor->calib_stored = e.saved;
+}
+
+// A cached calibration is confirmed (and kept fresh) or thrown away the
+// first time the glove is held still
+static void CheckCachedCalibration(IMUCursor *cursor, const float raw[3], const float gyro[3], float dt)
+{
+    int r = calib_check_update(&cursor->check, &cursor->cache, raw, gyro, dt);
+
+    if (r > 0) return;
+    cursor->cache_checking = 0;
+    if (r == 0) {
+        cursor->cache.saved = time(NULL);
+        calib_cache_put(&cursor->cache);
+        return;
+    }
+    printf("Cached calibration for pipe %d no longer matches, recalibrating\n", cursor->pipe);
+    calib_cache_forget(cursor->pipe);
+    SetCursorMode(cursor, cursor->mode);
+}
+
+void UpdateCursorSample(IMUCursor *cursor, const struct dp_packet *pkt)
+{
+    float dt = CursorSampleDt(cursor, pkt);
+    float raw[3] = { pkt->accel.x, pkt->accel.y, pkt->accel.z };
+    float gyro[3] = { pkt->gyro.x, pkt->gyro.y, pkt->gyro.z };
+    float lin[3];
+
+    if (cursor->pipe != pkt->pipe) {
+        cursor->pipe = pkt->pipe;
+        if (!cursor->calibrated) ApplyCachedCalibration(cursor);
+    }
+    if (cursor->cache_checking) {
+        CheckCachedCalibration(cursor, raw, gyro, dt);
+    }
+
+    imu_gravity_update(&cursor->gravity, raw, gyro, dt, lin);
+    Vector2 accel = (Vector2){ lin[0], lin[1] };
+
+    // Refine the bias whenever the glove rests
+    Vector2 at_rest = TransformImuAccel(accel);
+    float offset[2] = { at_rest.x, at_rest.y };
+    int changed = bias_tracker_update(&cursor->tracker, raw, gyro, offset, dt);
+
+    if (cursor->pipe < DP_PIPES) {
+        bias_metrics_update(&metrics[cursor->pipe], &cursor->tracker, changed, dt);
+    }
+    if (changed) {
+        cursor->bias = (Vector2){ cursor->tracker.accel_bias[0], cursor->tracker.accel_bias[1] };
+        if (!cursor->calib_stored || time(NULL) - cursor->calib_stored >= CALIB_STORE_S) {
+            StoreCalibration(cursor);
+        }
+    }
+
+    if (cursor->mode == CURSOR_MODE_AIR) {
+        float vel[2];
+
+        // Calibrated once the glove has been held still long enough to
+        // learn the gyro bias
+        cursor->calibrated = air_motion_update(&cursor->air, gyro, dt, vel);
+        cursor->vel = (Vector2){ vel[0], vel[1] };
+        MoveCursor(cursor, dt);
+        TrackCursor(cursor, pkt, dt);
+        return;
+    }
+
+    // Usable from the first sample, the bias catches up at the first rest
+    cursor->calibrated = 1;
+    UpdateCursorMovement(cursor, accel, dt);
+    TrackCursor(cursor, pkt, dt);
+}
+
+void SetCursorSampleRate(IMUCursor *cursor, float hz)
+{
+    if (hz <= 0) return;
+    cursor->sample_period = fminf(fmaxf(1.0f / hz, SAMPLE_PERIOD_MIN), SAMPLE_PERIOD_MAX);
+    // What the window holds so far was at the old rate
+    cursor->window_start_us = cursor->last_sample_us;
+    cursor->window_count = 0;
 }
 
 void ResetCursor(IMUCursor *cursor, Vector2 pos)
 {
     cursor->pos = pos;
     cursor->vel = (Vector2){0, 0};
+    cursor_predict_reset(&cursor->predict);
+    cursor->draw_pos = pos;
+}
+
+void PredictCursor(IMUCursor *cursor, float display_lead)
+{
+    struct timespec ts;
+    float ahead[2];
+
+    cursor->draw_pos = cursor->pos;
+    if (predict_lambda <= 0 || !cursor->predict.initialized) return;
+
+    // host_us is CLOCK_MONOTONIC, see dongleparse.c
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+    float age = (float)(now - cursor->predict_host_us) * 1e-6f;
+
+    // A quiet glove is not moving on its own
+    if (age > SAMPLE_GAP_S) return;
+
+    if (cursor_predict_at(&cursor->predict, age + predict_pipe_s + display_lead, ahead)) {
+        cursor->draw_pos.x = fminf(fmaxf(ahead[0], 0), GetScreenWidth());
+        cursor->draw_pos.y = fminf(fmaxf(ahead[1], 0), GetScreenHeight());
+    }
+}
+
+void PrintCursorMetrics(void)
+{
+    for (int pipe = 0; pipe < DP_PIPES; pipe++) {
+        const struct bias_metrics *m = &metrics[pipe];
+
+        if (m->session_s <= 0) continue;
+        printf("Pipe %d: %.1f min, at rest %.0f%% (%u times), %u bias updates, "
+               "accel bias drift %.4f m/s^2 (max %.4f), gyro %.4f rad/s (max %.4f)\n",
+               pipe, m->session_s / 60.0f, 100.0f * m->rest_s / m->session_s,
+               (unsigned)m->rest_periods, (unsigned)m->updates, m->accel_drift,
+               m->max_accel_drift, m->gyro_drift, m->max_gyro_drift);
+    }
 }
 
-void DrawCursor(IMUCursor *cursor){
-    DrawCircleV(cursor->pos, cursor->rad, cursor->color);
-    DrawText(cursor->text, cursor->pos.x-5, cursor->pos.y-5, 15, BLACK);
+void DrawCursor(const IMUCursor *cursor){
+    DrawCircleV(cursor->draw_pos, cursor->rad, cursor->color);
+    DrawText(cursor->text, cursor->draw_pos.x-5, cursor->draw_pos.y-5, 15, BLACK);
 }
\ No newline at end of file
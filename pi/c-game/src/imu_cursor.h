@@ -4,6 +4,13 @@
 #define IMU_CURSOR_H
 
 #include "raylib.h"
+#include "dongleparse.h"
+#include "imu_gravity.h"
+#include "cursor_motion.h"
+#include "calib_cache.h"
+#include "bias_tracker.h"
+#include "cursor_predict.h"
+#include <stdint.h>
 
 //----------------------------------------------------------------------------------
 // Cursor State Structure
@@ -12,13 +19,36 @@ typedef struct {
     Vector2 pos;
     Vector2 vel;
     Vector2 bias;
-    Vector2 calib_accum;
-    Vector2 lp_accel;
-    int calib_count;
     int calibrated;
-    int gravity_initialized;
+    struct imu_gravity gravity;
+    int mode;                   // enum cursor_mode
+    struct air_motion air;
+
+    // Bias found while the glove rests, see bias_tracker.h
+    struct bias_tracker tracker;
+
+    // Calibration reuse, see calib_cache.h. pipe is -1 until the first sample.
+    int pipe;
+    time_t calib_stored;
+    int cache_checking;
+    struct calib_entry cache;
+    struct calib_check check;
+
+    // Latency compensation, see cursor_predict.h. draw_pos is where the
+    // cursor is drawn: pos carried forward to when the frame is shown.
+    struct cursor_predict predict;
+    uint64_t predict_host_us;
+    Vector2 draw_pos;
     int rad;
     Color color;
+
+    // Sample clock: dt between samples, learned from their arrival times
+    uint64_t last_sample_us;
+    uint64_t window_start_us;
+    int window_count;
+    int have_sample;
+    int last_timed;
+    float sample_period;
     const char *text;
     
     // Debug
@@ -28,14 +58,41 @@ typedef struct {
 
 void InitCursor(IMUCursor *cursor, Vector2 pos, Color color, const char *text);
 
-void InitCursors(IMUCursor *right_cursor, IMUCursor *left_cursor);
+// Switch between acceleration and air-mouse movement; recalibrates
+void SetCursorMode(IMUCursor *cursor, int mode);
+
+// Mode InitCursor gives new cursors
+void SetDefaultCursorMode(int mode);
+
+// Radio, dongle and USB before a sample is stamped with host_us;
+// pipeline_sim -bench measures it
+#define CURSOR_PIPE_LATENCY_S 0.004f
 
-int UpdateCursorCalibration(IMUCursor *cursor, Vector2 accel);
+// Draw new cursors ahead by their latency: tracking index lambda (0 is
+// off) and the sample's age when it reaches this process
+void SetCursorPrediction(float lambda, float pipe_latency_s);
 
+// accel here is glove x/y with gravity already removed, m/s^2
 void UpdateCursorMovement(IMUCursor *cursor, Vector2 accel, float dt);
 
+// Seconds this sample covers
+float CursorSampleDt(IMUCursor *cursor, const struct dp_packet *pkt);
+
+// The glove was asked for a new sample rate: take dt from that rather than
+// wait for the sample clock to learn it
+void SetCursorSampleRate(IMUCursor *cursor, float hz);
+
+// Calibrate or move by one glove sample; call for every sample, in order
+void UpdateCursorSample(IMUCursor *cursor, const struct dp_packet *pkt);
+
 void ResetCursor(IMUCursor *cursor, Vector2 pos);
 
-void DrawCursor(IMUCursor *cursor);
+// Set draw_pos for a frame shown display_lead seconds from now
+void PredictCursor(IMUCursor *cursor, float display_lead);
+
+// Bias drift per glove since the game started, to stdout
+void PrintCursorMetrics(void);
+
+void DrawCursor(const IMUCursor *cursor);
 
 #endif
\ No newline at end of file
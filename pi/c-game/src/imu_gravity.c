@@ -0,0 +1,91 @@
+// Created by Robbie Leslie 2025
+
+#include <math.h>
+
+#include "imu_gravity.h"
+
+// High-pass: HP_ALPHA per step at HP_RATE_HZ, scaled to the real dt
+#define HP_ALPHA 0.995f
+#define HP_RATE_HZ 60.0f
+
+// Attitude filter gains. The integral term soaks up gyro bias.
+#define MAHONY_KP 1.0f
+#define MAHONY_KI 0.05f
+#define MADGWICK_BETA 0.1f
+
+// While |accel| is this far from 1 g the hand is accelerating and accel is
+// not a gravity reference: run on the gyro alone.
+#define ACCEL_TRUST_MS2 1.0f
+
+static const char *mode_names[] = { "highpass", "mahony", "madgwick" };
+
+void imu_gravity_init(struct imu_gravity *g, int mode)
+{
+    g->mode = mode;
+    g->initialized = 0;
+    g->lp[0] = g->lp[1] = g->lp[2] = 0.0f;
+    ahrs_init(&g->filter, MAHONY_KP, MAHONY_KI, MADGWICK_BETA);
+}
+
+const char *imu_gravity_name(int mode)
+{
+    if (mode < 0 || mode > IMU_GRAVITY_MADGWICK) return "?";
+    return mode_names[mode];
+}
+
+void imu_gravity_set_gyro_bias(struct imu_gravity *g, const float bias[3])
+{
+    // The integral term is added to the gyro, so it holds minus the bias
+    for (int i = 0; i < 3; i++) g->filter.e_int[i] = -bias[i];
+}
+
+// Start level with the measured gravity instead of converging from identity
+static void seed_attitude(struct ahrs *f, const float a[3])
+{
+    float roll = atan2f(a[1], a[2]);
+    float pitch = atan2f(-a[0], sqrtf(a[1] * a[1] + a[2] * a[2]));
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+
+    f->q[0] = cr * cp;
+    f->q[1] = sr * cp;
+    f->q[2] = cr * sp;
+    f->q[3] = -sr * sp;
+}
+
+void imu_gravity_update(struct imu_gravity *g, const float accel[3],
+                        const float gyro[3], float dt, float lin[3])
+{
+    if (!g->initialized) {
+        g->lp[0] = accel[0];
+        g->lp[1] = accel[1];
+        g->lp[2] = accel[2];
+        seed_attitude(&g->filter, accel);
+        g->initialized = 1;
+        lin[0] = lin[1] = lin[2] = 0.0f;
+        return;
+    }
+
+    if (g->mode == IMU_GRAVITY_HIGHPASS) {
+        float alpha = powf(HP_ALPHA, dt * HP_RATE_HZ);
+
+        for (int i = 0; i < 3; i++) {
+            g->lp[i] = alpha * g->lp[i] + (1.0f - alpha) * accel[i];
+            lin[i] = accel[i] - g->lp[i];
+        }
+        return;
+    }
+
+    float norm = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+    int trust = fabsf(norm - AHRS_GRAVITY) < ACCEL_TRUST_MS2;
+
+    if (g->mode == IMU_GRAVITY_MADGWICK) {
+        g->filter.beta = trust ? MADGWICK_BETA : 0.0f;
+        ahrs_madgwick_update(&g->filter, gyro, accel, dt);
+    } else {
+        g->filter.kp = trust ? MAHONY_KP : 0.0f;
+        g->filter.ki = trust ? MAHONY_KI : 0.0f;
+        ahrs_mahony_update(&g->filter, gyro, accel, dt);
+    }
+    ahrs_linear_accel(&g->filter, accel, lin);
+}
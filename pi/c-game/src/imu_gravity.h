@@ -0,0 +1,50 @@
+// Created by Robbie Leslie 2025
+
+#ifndef IMU_GRAVITY_H
+#define IMU_GRAVITY_H
+
+#include "ahrs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Gravity removal for one glove's raw samples, no raylib so the host tools
+   can benchmark it (microcontroller/host/gravity_bench.c).
+
+   IMU_GRAVITY_HIGHPASS is the old cursor filter: a per-axis high-pass that
+   leaks gravity while the glove is held tilted and lags quick moves.
+   The AHRS modes track attitude from the gyro (ahrs.c, built from
+   microcontroller/imu_tx/src) and subtract gravity along it. */
+enum imu_gravity_mode {
+    IMU_GRAVITY_HIGHPASS,
+    IMU_GRAVITY_MAHONY,
+    IMU_GRAVITY_MADGWICK,
+};
+
+struct imu_gravity {
+    int mode;
+    int initialized;
+    struct ahrs filter;
+    float lp[3];        /* high-pass mode: low-passed accel */
+};
+
+void imu_gravity_init(struct imu_gravity *g, int mode);
+
+/* accel in m/s^2, gyro in rad/s, dt in s. lin gets accel minus gravity,
+   glove body frame, m/s^2. The first sample only seeds the filter and
+   gives lin = 0. */
+void imu_gravity_update(struct imu_gravity *g, const float accel[3],
+                        const float gyro[3], float dt, float lin[3]);
+
+/* Start from a known gyro bias (rad/s), e.g. a cached calibration.
+   Only the Mahony filter estimates bias; the other modes ignore it. */
+void imu_gravity_set_gyro_bias(struct imu_gravity *g, const float bias[3]);
+
+const char *imu_gravity_name(int mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
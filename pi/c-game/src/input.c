@@ -0,0 +1,97 @@
+// Created by Robbie Leslie 2025
+
+#include "input.h"
+#include "screens.h"
+
+static IMUCursor cursors[GLOVE_COUNT];
+static int pending[GLOVE_COUNT];     // presses not handed out yet
+static bool pressed[GLOVE_COUNT];    // this frame's press
+
+// Glove pipes on the dongle: 1 is the right hand, 2 the left
+static int GlovePipe(Glove glove)
+{
+    return glove == GLOVE_RIGHT ? 1 : 2;
+}
+
+static Vector2 HomePosition(Glove glove)
+{
+    float dx = glove == GLOVE_RIGHT ? 50 : -50;
+    return (Vector2){ screenWidth/2 + dx, screenHeight/2 };
+}
+
+void InitInput(void)
+{
+    InitCursor(&cursors[GLOVE_RIGHT], HomePosition(GLOVE_RIGHT), PURPLE, "R");
+    InitCursor(&cursors[GLOVE_LEFT], HomePosition(GLOVE_LEFT), BLUE, "L");
+
+    for (int g = 0; g < GLOVE_COUNT; g++) {
+        pending[g] = 0;
+        pressed[g] = false;
+    }
+}
+
+void UpdateInput(void)
+{
+    struct dp_packet sample;
+
+    pthread_mutex_lock(&pkt_mutex);
+    pending[GLOVE_RIGHT] += right_button_events;
+    right_button_events = 0;
+    pending[GLOVE_LEFT] += left_button_events;
+    left_button_events = 0;
+    pthread_mutex_unlock(&pkt_mutex);
+
+    // Every sample since the last frame, each with its own dt
+    while (PopGloveSample(GlovePipe(GLOVE_RIGHT), &sample)) {
+        UpdateCursorSample(&cursors[GLOVE_RIGHT], &sample);
+    }
+
+    // Use mouse for left cursor control
+    #ifdef _DEBUG
+    while (PopGloveSample(GlovePipe(GLOVE_LEFT), &sample)) {}
+    cursors[GLOVE_LEFT].pos = GetMousePosition();
+    cursors[GLOVE_LEFT].calibrated = true;
+    if (IsGestureDetected(GESTURE_TAP)) {
+        pending[GLOVE_LEFT]++;
+    }
+    #else
+    while (PopGloveSample(GlovePipe(GLOVE_LEFT), &sample)) {
+        UpdateCursorSample(&cursors[GLOVE_LEFT], &sample);
+    }
+    #endif
+
+    for (int g = 0; g < GLOVE_COUNT; g++) {
+        pressed[g] = pending[g] > 0;
+        if (pressed[g]) pending[g]--;
+
+        // This frame goes on screen about one frame from now
+        PredictCursor(&cursors[g], GetFrameTime());
+    }
+}
+
+const IMUCursor *GetGloveCursor(Glove glove)
+{
+    return &cursors[glove];
+}
+
+bool GlovePressed(Glove glove)
+{
+    return pressed[glove];
+}
+
+bool GloveConnected(Glove glove)
+{
+    return glove == GLOVE_RIGHT ? right_connected : left_connected;
+}
+
+void HomeGloveCursors(void)
+{
+    for (int g = 0; g < GLOVE_COUNT; g++) {
+        ResetCursor(&cursors[g], HomePosition(g));
+    }
+}
+
+void SetGloveSampleRate(Glove glove, float hz)
+{
+    SetCursorSampleRate(&cursors[glove], hz);
+}
@@ -0,0 +1,35 @@
+// Created by Robbie Leslie 2025
+//
+// Glove input for the whole game. The two cursors and the button presses
+// live here, not in the screens, so changing screen keeps each glove's
+// calibration, bias and sample clock. UpdateInput runs once per frame,
+// before the current screen's Update; screens only read.
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+#include "imu_cursor.h"
+
+typedef enum { GLOVE_RIGHT = 0, GLOVE_LEFT, GLOVE_COUNT } Glove;
+
+// Once at startup, after SetDefaultCursorMode
+void InitInput(void);
+
+// Take every glove sample and button press since the last frame
+void UpdateInput(void);
+
+const IMUCursor *GetGloveCursor(Glove glove);
+
+// True on the frame a button press is handed out; one press per frame
+bool GlovePressed(Glove glove);
+
+bool GloveConnected(Glove glove);
+
+// Both cursors back to their start positions; calibration is kept
+void HomeGloveCursors(void);
+
+// The glove was asked for a new sensor rate, Hz
+void SetGloveSampleRate(Glove glove, float hz);
+
+#endif
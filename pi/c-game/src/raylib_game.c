@@ -15,7 +15,11 @@
 #include "raylib.h"
 #include "screens.h"    // NOTE: Declares global (extern) variables and screens functions
 #include "dongleparse.h"
+#include "imu_cursor.h"
+#include "input.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include <time.h>
 #include <unistd.h>
@@ -44,6 +48,19 @@ struct dp_packet right_pkt, left_pkt;
 int right_button_events = 0;
 int left_button_events  = 0;
 
+// Button edges from the gloves, filled by the reader thread
+static struct dp_button_queue button_queue;
+
+// Every sample from each glove, oldest first, so cursors integrate all of
+// them and not just the latest at each frame. Guarded by pkt_mutex.
+#define GLOVE_SAMPLE_QUEUE 64
+static struct {
+    struct dp_packet pkt[GLOVE_SAMPLE_QUEUE];
+    unsigned head;
+    unsigned count;
+    unsigned dropped;
+} glove_samples[2];
+
 bool playing = true;
 
 //----------------------------------------------------------------------------------
@@ -57,6 +74,12 @@ static bool transFadeOut = false;
 static int transFromScreen = -1;
 static GameScreen transToScreen = UNKNOWN;
 
+// Glove sensor rate per screen: menus only need a cursor, gameplay wants every sample
+#define GLOVE_ODR_MENU_HZ       52
+#define GLOVE_ODR_GAMEPLAY_HZ   104
+static int gloveRateScreen[GLOVE_COUNT] = { UNKNOWN, UNKNOWN };   // Screen each glove's rate was sent for
+static int gloveRateFailed[GLOVE_COUNT] = { UNKNOWN, UNKNOWN };   // Screen a send last failed on, to report once
+
 bool right_connected = true;
 bool left_connected =true;
 
@@ -73,6 +96,38 @@ static void UpdateTransition(void);         // Update transition effect
 static void DrawTransition(void);           // Draw transition effect (full-screen rectangle)
 
 static void UpdateDrawFrame(void);          // Update and draw one frame
+static void UpdateGloveRate(int dongle);    // Lower glove sensor rate outside gameplay
+static void DrainButtonEvents(void);        // Count glove button presses for the screens
+
+static void PushGloveSample(int glove, const struct dp_packet *pkt)
+{
+    // Called with pkt_mutex held. A stalled frame loses the oldest samples.
+    if (glove_samples[glove].count == GLOVE_SAMPLE_QUEUE) {
+        glove_samples[glove].head = (glove_samples[glove].head + 1) % GLOVE_SAMPLE_QUEUE;
+        glove_samples[glove].count--;
+        glove_samples[glove].dropped++;
+    }
+    unsigned tail = (glove_samples[glove].head + glove_samples[glove].count) % GLOVE_SAMPLE_QUEUE;
+    glove_samples[glove].pkt[tail] = *pkt;
+    glove_samples[glove].count++;
+}
+
+int PopGloveSample(int pipe, struct dp_packet *pkt)
+{
+    int glove = pipe == 1 ? 0 : pipe == 2 ? 1 : -1;
+    int got = 0;
+
+    if (glove < 0) return 0;
+    pthread_mutex_lock(&pkt_mutex);
+    if (glove_samples[glove].count > 0) {
+        *pkt = glove_samples[glove].pkt[glove_samples[glove].head];
+        glove_samples[glove].head = (glove_samples[glove].head + 1) % GLOVE_SAMPLE_QUEUE;
+        glove_samples[glove].count--;
+        got = 1;
+    }
+    pthread_mutex_unlock(&pkt_mutex);
+    return got;
+}
 
 // thread function: reads packets and updates right_pkt/left_pkt
 static void *dongle_thread_fn(void *arg)
@@ -84,25 +139,22 @@ static void *dongle_thread_fn(void *arg)
     int prev_seq_l = 0;
     
     while (dongle_thread_run) {
-        int r = dp_read_packet(fd, &pkt);
+        int r = dp_read_input(fd, &pkt, &button_queue);
         if (r == 1) {
             //printf("\nseq=%u pipe=%u button=%u", pkt.seq, pkt.pipe, pkt.button);
-            if(pkt.button){
-                printf("\nButton Pressed");
-            }
             pthread_mutex_lock(&pkt_mutex);
             switch (pkt.pipe) {
                 case 1:
                     right_pkt = pkt;
+                    PushGloveSample(0, &pkt);
                     prev_seq_r = pkt.seq;
                     prev_time_r = time(NULL);
-                    if (pkt.button) right_button_events++;
                     break;
                 case 2:
                     left_pkt = pkt;
+                    PushGloveSample(1, &pkt);
                     prev_seq_l = pkt.seq;
                     prev_time_l = time(NULL);
-                    if (pkt.button) left_button_events++;
                     break;
                 default: break;
             }
@@ -140,6 +192,28 @@ int main(void)
     printf("\nStarting game in debug mode");
     #endif
 
+    // Gloves calibrated in an earlier run skip the "Keep Still!" wait
+    calib_cache_load(CALIB_CACHE_FILE);
+
+    // GLOVE_CURSOR=air points with the gyro instead of integrating accel
+    const char *cursor_mode = getenv("GLOVE_CURSOR");
+    if (cursor_mode && strcmp(cursor_mode, "air") == 0) {
+        SetDefaultCursorMode(CURSOR_MODE_AIR);
+    }
+
+    // GLOVE_PREDICT=on draws the cursors ahead by their latency, a number
+    // sets the tracking index (see cursor_predict.h); GLOVE_PREDICT_MS is
+    // how old a sample is when it gets here
+    const char *predict = getenv("GLOVE_PREDICT");
+    if (predict) {
+        float lambda = strcmp(predict, "on") == 0 ? CURSOR_PREDICT_LAMBDA : atof(predict);
+        const char *pipe_ms = getenv("GLOVE_PREDICT_MS");
+        SetCursorPrediction(lambda, pipe_ms ? atof(pipe_ms) * 1e-3f : CURSOR_PIPE_LATENCY_S);
+    }
+
+    // Both gloves' cursors, kept for the whole run
+    InitInput();
+
     InitAudioDevice();      // Initialize audio device
 
     // Load global data (assets that must be available in all screens, i.e. font)
@@ -186,6 +260,7 @@ int main(void)
     }
     
      // start reader thread (pass fd by value)
+    dp_button_queue_init(&button_queue);
     int dongle_fd = dongle;
     if (pthread_create(&dongle_thread, NULL, dongle_thread_fn, &dongle_fd) != 0) {
         printf("Failed to start dongle thread\n");
@@ -229,6 +304,9 @@ int main(void)
             }
         }
 
+        UpdateGloveRate(dongle);
+        DrainButtonEvents();
+        UpdateInput();          // Before the screen reads the gloves
         UpdateDrawFrame();
 
     }
@@ -255,6 +333,8 @@ int main(void)
 
     dp_close(dongle);               // causes dp_read_packet to return / unblock
     pthread_mutex_destroy(&pkt_mutex);
+
+    PrintCursorMetrics();
     
 
     // Unload global data loaded
@@ -301,6 +381,32 @@ static void ChangeToScreen(int screen)
     currentScreen = screen;
 }
 
+// Send the gloves a new sensor rate when the screen changes
+static void UpdateGloveRate(int dongle)
+{
+    static const int pipes[GLOVE_COUNT] = { 1, 2 };     // Right glove is pipe 1, left is pipe 2
+
+    if (dongle < 0) return;
+
+    struct dp_glove_config cfg = { 0 };
+    cfg.odr_hz = (currentScreen == GAMEPLAY) ? GLOVE_ODR_GAMEPLAY_HZ : GLOVE_ODR_MENU_HZ;
+
+    for (int g = 0; g < GLOVE_COUNT; g++) {
+        if (gloveRateScreen[g] == currentScreen) continue;
+
+        // A failed send is tried again next frame
+        if (dp_set_glove_config(dongle, pipes[g], &cfg) < 0) {
+            if (gloveRateFailed[g] != currentScreen) printf("Failed to send glove %d rate\n", pipes[g]);
+            gloveRateFailed[g] = currentScreen;
+            continue;
+        }
+        gloveRateScreen[g] = currentScreen;
+
+        // Else the cursor integrates with the old rate's dt until it learns it
+        SetGloveSampleRate(g, cfg.odr_hz);
+    }
+}
+
 // Request transition to next screen
 static void TransitionToScreen(int screen)
 {
@@ -451,3 +557,19 @@ static void UpdateDrawFrame(void)
     EndDrawing();
     //----------------------------------------------------------------------------------
 }
+
+// Every press counts once, however quickly it follows the last one
+static void DrainButtonEvents(void)
+{
+    struct dp_button ev;
+
+    while (dp_button_pop(&button_queue, &ev)) {
+        if (!ev.pressed) continue;
+
+        printf("\nButton pressed (pipe %u, %u us before sending)", ev.pipe, ev.age_us);
+        pthread_mutex_lock(&pkt_mutex);
+        if (ev.pipe == 1) right_button_events++;
+        else if (ev.pipe == 2) left_button_events++;
+        pthread_mutex_unlock(&pkt_mutex);
+    }
+}
@@ -25,10 +25,9 @@
 
 #include "raylib.h"
 #include "screens.h"
-#include "imu_cursor.h"
+#include "input.h"
 #include "button.h"
 #include <stdio.h>
-#include <pthread.h>
 
 //----------------------------------------------------------------------------------
 // Global variable definitions
@@ -41,20 +40,10 @@ int local_high_score;
 static int framesCounter = 0;
 static int finishScreen = 0;
 
-// Two cursors
-static IMUCursor right_cursor;
-static IMUCursor left_cursor;
-
 //Buttons
 static Button play_again_button;
 static Button quit_button;
 
-extern pthread_mutex_t pkt_mutex;
-extern struct dp_packet right_pkt;
-extern struct dp_packet left_pkt;  // Add this extern
-static int right_events = 0;
-static int left_events = 0;
-
 //----------------------------------------------------------------------------------
 // Ending Screen Functions Definition
 //----------------------------------------------------------------------------------
@@ -72,8 +61,7 @@ void InitEndingScreen(void)
     temp_rect = (Rectangle){screenWidth/2 + 250, screenHeight/2 + 130, 200, 80};
     InitButton(&quit_button, temp_rect, RED, BLUE, "Quit");
     
-    //Init cursors
-    InitCursors(&right_cursor, &left_cursor);
+    HomeGloveCursors();
     
     if(score > local_high_score){
         local_high_score = score;
@@ -83,61 +71,18 @@ void InitEndingScreen(void)
 // Ending Screen Update logic
 void UpdateEndingScreen(void)
 {
-    struct dp_packet right_local, left_local;
-
-    pthread_mutex_lock(&pkt_mutex);
-    right_local = right_pkt;
-    left_local = left_pkt;
-    right_events += right_button_events;
-    right_button_events = 0;
-    left_events += left_button_events;
-    left_button_events = 0;
-    pthread_mutex_unlock(&pkt_mutex);
-    
-    float dt = GetFrameTime();
-    if (dt > 0.1f) dt = 0.016f;
-    
-    // Update right cursor
-    if(right_connected){
-        if (!UpdateCursorCalibration(&right_cursor, (Vector2){right_local.accel.x, right_local.accel.y})) {
-            UpdateCursorMovement(&right_cursor, (Vector2){right_local.accel.x, right_local.accel.y}, dt);
-        }
-    }
+    const IMUCursor *right_cursor = GetGloveCursor(GLOVE_RIGHT);
+    const IMUCursor *left_cursor = GetGloveCursor(GLOVE_LEFT);
+    bool right_pressed = GlovePressed(GLOVE_RIGHT);
+    bool left_pressed = GlovePressed(GLOVE_LEFT);
     
-    // Update left cursor
-    if(left_connected){
-        if (!UpdateCursorCalibration(&left_cursor, (Vector2){left_local.accel.x, left_local.accel.y})) {
-            UpdateCursorMovement(&left_cursor, (Vector2){left_local.accel.x, left_local.accel.y}, dt);
-        }
-    }
-    
-    //Use mouse for left cursor control
-    #ifdef _DEBUG
-    left_cursor.pos = GetMousePosition();
-    if(IsGestureDetected(GESTURE_TAP)){
-        left_events++;
-    }
-    #endif
-    
-    bool right_pressed = false;
-    if(right_events > 0){
-        right_pressed = true;
-        right_events--;
-    }
-    
-    bool left_pressed = false;
-    if(left_events > 0){
-        left_pressed = true;
-        left_events--;
-    }
-    
-    bool play_again_r = IsButtonPressed(&play_again_button, right_cursor.pos, right_pressed);
-    bool play_again_l = IsButtonPressed(&play_again_button, left_cursor.pos, left_pressed);
+    bool play_again_r = IsButtonPressed(&play_again_button, right_cursor->pos, right_pressed);
+    bool play_again_l = IsButtonPressed(&play_again_button, left_cursor->pos, left_pressed);
     
     bool play_again = play_again_l || play_again_r;
     
-    bool quit_r = IsButtonPressed(&quit_button, right_cursor.pos, right_pressed);
-    bool quit_l = IsButtonPressed(&quit_button, left_cursor.pos, left_pressed);
+    bool quit_r = IsButtonPressed(&quit_button, right_cursor->pos, right_pressed);
+    bool quit_l = IsButtonPressed(&quit_button, left_cursor->pos, left_pressed);
     
     bool quit = quit_l || quit_r;
     
@@ -160,7 +105,10 @@ void DrawEndingScreen(void)
     // Draw background
     DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), WHITE);
     
-    if (!right_cursor.calibrated && !left_cursor.calibrated) {
+    const IMUCursor *right_cursor = GetGloveCursor(GLOVE_RIGHT);
+    const IMUCursor *left_cursor = GetGloveCursor(GLOVE_LEFT);
+    
+    if (!right_cursor->calibrated && !left_cursor->calibrated) {
         DrawText("Calibrating IMUs - Keep Still!", screenWidth / 2 - 150, 150, 20, MAROON);
     }
     
@@ -183,8 +131,8 @@ void DrawEndingScreen(void)
     DrawButton(&play_again_button);
     DrawButton(&quit_button);
     
-    DrawCursor(&left_cursor);
-    DrawCursor(&right_cursor);
+    DrawCursor(left_cursor);
+    DrawCursor(right_cursor);
     }
 
 // Ending Screen Unload logic
@@ -27,11 +27,10 @@
 
 #include "raylib.h"
 #include "screens.h"
-#include "imu_cursor.h"
+#include "input.h"
 #include "fruit.h"
 #include <stdio.h>
 #include <math.h>
-#include <pthread.h>
 #include <time.h>
 #include <stdlib.h>
 
@@ -47,15 +46,6 @@ int score;
 static int framesCounter = 0;
 static int finishScreen = 0;
 
-// Two cursors
-static IMUCursor right_cursor;
-static IMUCursor left_cursor;
-
-extern pthread_mutex_t pkt_mutex;
-extern struct dp_packet right_pkt;
-extern struct dp_packet left_pkt;  // Add this extern
-static int events = 0;
-
 //static Fruit testFruit;
 //static Fruit testFruit2;
 
@@ -74,13 +64,7 @@ void InitGameplayScreen(void)
 
     score = 0;
 
-
-    Vector2 temp_pos = (Vector2){screenWidth/2 + 50, screenHeight/2};
-    InitCursor(&right_cursor, temp_pos, PURPLE, "R");
-
-    temp_pos = (Vector2){screenWidth/2 - 50, screenHeight/2};
-    InitCursor(&left_cursor, temp_pos, BLUE, "L");
-
+    HomeGloveCursors();
 
 
     srand(time(NULL));  // Only once!
@@ -93,41 +77,13 @@ void InitGameplayScreen(void)
 
 void UpdateGameplayScreen(void)
 {
-    struct dp_packet right_local, left_local;
-
-    pthread_mutex_lock(&pkt_mutex);
-    right_local = right_pkt;
-    left_local = left_pkt;
-    events = right_button_events;
-    right_button_events = 0;
-    pthread_mutex_unlock(&pkt_mutex);
-
-    float dt = GetFrameTime();
-    if (dt > 0.1f) dt = 0.016f;
-
-    // Update right cursor
-    if (!UpdateCursorCalibration(&right_cursor, (Vector2){right_local.accel.x, right_local.accel.y})) {
-        UpdateCursorMovement(&right_cursor, (Vector2){right_local.accel.x, right_local.accel.y}, dt);
-    }
-
-    // Update left cursor
-    #ifdef _DEBUG
-    left_cursor.pos = GetMousePosition();
-    left_cursor.calibrated = true;
-    #else
-    if (!UpdateCursorCalibration(&left_cursor, (Vector2){left_local.accel.x, left_local.accel.y})) {
-        UpdateCursorMovement(&left_cursor, (Vector2){left_local.accel.x, left_local.accel.y}, dt);
-    }
-    #endif
+    const IMUCursor *right_cursor = GetGloveCursor(GLOVE_RIGHT);
+    const IMUCursor *left_cursor = GetGloveCursor(GLOVE_LEFT);
 
     // Button event: reset both cursors
-    if (events > 0) {
+    if (GlovePressed(GLOVE_RIGHT)) {
         printf("\nResetting cursors");
-        Vector2 temp_pos = (Vector2){screenWidth/2 + 50, screenHeight/2};
-        ResetCursor(&right_cursor, temp_pos);
-        temp_pos = (Vector2){screenWidth/2 - 50, screenHeight/2};
-        ResetCursor(&left_cursor, temp_pos);
-        events--;
+        HomeGloveCursors();
     }
 
 
@@ -135,7 +91,7 @@ void UpdateGameplayScreen(void)
     //     printf("\nTest fruit offscreen");
     //     InitFruit(&testFruit);
     // }
-    if(left_cursor.calibrated == 1 && right_cursor.calibrated == 1){
+    if(left_cursor->calibrated == 1 && right_cursor->calibrated == 1){
         for(int i = 0; i < NUM_FRUITS; i++){
             if(UpdateFruitPosition(&fruits[i]) == 2){
                 InitFruit(&fruits[i]);
@@ -150,7 +106,7 @@ void UpdateGameplayScreen(void)
     // }
 
     for(int i = 0; i < NUM_FRUITS; i++){
-        if(CursorColision(&right_cursor, &fruits[i])){
+        if(CursorColision(right_cursor, &fruits[i])){
 
             if(fruits[i].type == BOMB){
                 printf("\nHit bomb. Game over");
@@ -161,7 +117,7 @@ void UpdateGameplayScreen(void)
             }
         }
 
-        if(CursorColision(&left_cursor, &fruits[i])){
+        if(CursorColision(left_cursor, &fruits[i])){
 
             if(fruits[i].type == BOMB){
                 printf("\nHit bomb. Game over");
@@ -181,7 +137,10 @@ void DrawGameplayScreen(void)
     // Draw background
     DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), WHITE);
 
-    if (!right_cursor.calibrated || !left_cursor.calibrated) {
+    const IMUCursor *right_cursor = GetGloveCursor(GLOVE_RIGHT);
+    const IMUCursor *left_cursor = GetGloveCursor(GLOVE_LEFT);
+
+    if (!right_cursor->calibrated || !left_cursor->calibrated) {
         DrawText("Calibrating IMUs - Keep Still!", screenWidth / 2 - 150, 150, 20, MAROON);
     }
 
@@ -196,15 +155,15 @@ void DrawGameplayScreen(void)
 
     #ifdef _DEBUG
     // Right cursor debug (left side of screen)
-    sprintf(buffer, "R Vel: %.1f, %.1f", right_cursor.vel.x, right_cursor.vel.y);
+    sprintf(buffer, "R Vel: %.1f, %.1f", right_cursor->vel.x, right_cursor->vel.y);
     DrawText(buffer, 10, 40, 16, BLACK);
-    sprintf(buffer, "R Pos: %.0f, %.0f", right_cursor.pos.x, right_cursor.pos.y);
+    sprintf(buffer, "R Pos: %.0f, %.0f", right_cursor->pos.x, right_cursor->pos.y);
     DrawText(buffer, 10, 56, 16, BLACK);
 
     // Left cursor debug (right side of screen)
-    sprintf(buffer, "L Vel: %.1f, %.1f", left_cursor.vel.x, left_cursor.vel.y);
+    sprintf(buffer, "L Vel: %.1f, %.1f", left_cursor->vel.x, left_cursor->vel.y);
     DrawText(buffer, 10, 76, 16, BLACK);
-    sprintf(buffer, "L Pos: %.0f, %.0f", left_cursor.pos.x, left_cursor.pos.y);
+    sprintf(buffer, "L Pos: %.0f, %.0f", left_cursor->pos.x, left_cursor->pos.y);
     DrawText(buffer, 10, 92, 16, BLACK);
     #endif
 
@@ -212,15 +171,15 @@ void DrawGameplayScreen(void)
     // DrawFruit(&testFruit);
     // DrawFruit(&testFruit2);
 
-    if(left_cursor.calibrated == 1 && right_cursor.calibrated == 1){
+    if(left_cursor->calibrated == 1 && right_cursor->calibrated == 1){
         for(int i = 0; i < NUM_FRUITS; i++){
             DrawFruit(&fruits[i]);
         }
     }
 
     // Draw cursors
-    DrawCursor(&right_cursor);
-    DrawCursor(&left_cursor);
+    DrawCursor(right_cursor);
+    DrawCursor(left_cursor);
 }
 
 // Gameplay Screen Unload logic
@@ -25,12 +25,11 @@
 
 #include "raylib.h"
 #include "screens.h"
-#include "imu_cursor.h"
+#include "input.h"
 #include "button.h"
 #include "fruit.h"
 #include <stdio.h>
 #include <math.h>
-#include <pthread.h>
 #include <stdlib.h>
 
 //----------------------------------------------------------------------------------
@@ -39,20 +38,10 @@
 static int framesCounter = 0;
 static int finishScreen = 0;
 
-// Two cursors
-static IMUCursor right_cursor;
-static IMUCursor left_cursor;
-
 // Buttons
 static Button start_button;
 static Button quit_button;
 
-extern pthread_mutex_t pkt_mutex;
-extern struct dp_packet right_pkt;
-extern struct dp_packet left_pkt;  // Add this extern
-static int right_events = 0;
-static int left_events = 0;
-
 // Fruits for how to play
 static Fruit demo_fruits[FRUIT_TYPE_COUNT];
 
@@ -66,12 +55,7 @@ void InitTitleScreen(void)
     framesCounter = 0;
     finishScreen = 0;
     
-    // Init cursors
-    Vector2 temp_pos = (Vector2){screenWidth/2 + 50, screenHeight/2};
-    InitCursor(&right_cursor, temp_pos, PURPLE, "R");
-    
-    temp_pos = (Vector2){screenWidth/2 - 50, screenHeight/2};
-    InitCursor(&left_cursor, temp_pos, BLUE, "L");
+    HomeGloveCursors();
     
     // Init buttons
     Rectangle temp_rect = (Rectangle){screenWidth/2, screenHeight/2 + 130, 150, 80};
@@ -99,62 +83,19 @@ void InitTitleScreen(void)
 // Title Screen Update logic
 void UpdateTitleScreen(void)
 {
-    struct dp_packet right_local, left_local;
-    
-    pthread_mutex_lock(&pkt_mutex);
-    right_local = right_pkt;
-    left_local = left_pkt;
-    right_events += right_button_events;
-    right_button_events = 0;
-    left_events += left_button_events;
-    left_button_events = 0;
-    pthread_mutex_unlock(&pkt_mutex);
-    
-    float dt = GetFrameTime();
-    if (dt > 0.1f) dt = 0.016f;
-    
-    // Update right cursor
-    if(right_connected){
-        if (!UpdateCursorCalibration(&right_cursor, (Vector2){right_local.accel.x, right_local.accel.y})) {
-            UpdateCursorMovement(&right_cursor, (Vector2){right_local.accel.x, right_local.accel.y}, dt);
-        }
-    }
+    const IMUCursor *right_cursor = GetGloveCursor(GLOVE_RIGHT);
+    const IMUCursor *left_cursor = GetGloveCursor(GLOVE_LEFT);
+    bool right_pressed = GlovePressed(GLOVE_RIGHT);
+    bool left_pressed = GlovePressed(GLOVE_LEFT);
     
-    // Update left cursor
-    if(left_connected){
-        if (!UpdateCursorCalibration(&left_cursor, (Vector2){left_local.accel.x, left_local.accel.y})) {
-            UpdateCursorMovement(&left_cursor, (Vector2){left_local.accel.x, left_local.accel.y}, dt);
-        }
-    }
+    bool start_game_r = IsButtonPressed(&start_button, right_cursor->pos, right_pressed);
     
-    //Use mouse for left cursor control
-    #ifdef _DEBUG
-    left_cursor.pos = GetMousePosition();
-    if(IsGestureDetected(GESTURE_TAP)){
-        left_events++;
-    }
-    #endif
-    
-    bool right_pressed = false;
-    if(right_events > 0){
-        right_pressed = true;
-        right_events--;
-    }
-    
-    bool left_pressed = false;
-    if(left_events > 0){
-        left_pressed = true;
-        left_events--;
-    }
-    
-    bool start_game_r = IsButtonPressed(&start_button, right_cursor.pos, right_pressed);
-    
-    bool start_game_l = IsButtonPressed(&start_button, left_cursor.pos, left_pressed);
+    bool start_game_l = IsButtonPressed(&start_button, left_cursor->pos, left_pressed);
     
     bool start_game = start_game_r || start_game_l;
     
-    bool quit_r = IsButtonPressed(&quit_button, right_cursor.pos, right_pressed);
-    bool quit_l = IsButtonPressed(&quit_button, left_cursor.pos, left_pressed);
+    bool quit_r = IsButtonPressed(&quit_button, right_cursor->pos, right_pressed);
+    bool quit_l = IsButtonPressed(&quit_button, left_cursor->pos, left_pressed);
     
     bool quit = quit_l || quit_r;
     
@@ -181,8 +122,11 @@ void DrawTitleScreen(void)
     DrawButton(&start_button);
     DrawButton(&quit_button);
     
-    if(right_connected && left_connected){
-        if (!right_cursor.calibrated && !left_cursor.calibrated) {
+    const IMUCursor *right_cursor = GetGloveCursor(GLOVE_RIGHT);
+    const IMUCursor *left_cursor = GetGloveCursor(GLOVE_LEFT);
+    
+    if(GloveConnected(GLOVE_RIGHT) && GloveConnected(GLOVE_LEFT)){
+        if (!right_cursor->calibrated && !left_cursor->calibrated) {
             DrawText("Calibrating IMUs - Keep Still!", screenWidth / 2 - 150, 150, 20, MAROON);
         }
     } else {
@@ -230,8 +174,8 @@ void DrawTitleScreen(void)
     DrawText(bomb, 100, 410, fontSize, BLACK);
     
     // Draw cursors
-    DrawCursor(&right_cursor);
-    DrawCursor(&left_cursor);
+    DrawCursor(right_cursor);
+    DrawCursor(left_cursor);
 }
 
 // Title Screen Unload logic
@@ -27,6 +27,7 @@
 #define SCREENS_H
 
 #include "dongleparse.h"
+#include <pthread.h>
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
@@ -45,8 +46,6 @@ extern const int screenWidth;
 extern const int screenHeight;
 
 extern struct dp_packet right_pkt, left_pkt;
-extern int right_button_events;
-extern int left_button_events;
 
 extern bool right_connected;
 extern bool left_connected;
@@ -56,6 +55,11 @@ extern int local_high_score;
 
 extern bool playing;
 
+// Filled by the dongle thread, guarded by pkt_mutex
+extern pthread_mutex_t pkt_mutex;
+extern int right_button_events;
+extern int left_button_events;
+
 #ifdef __cplusplus
 extern "C" {            // Prevents name mangling of functions
 #endif
@@ -105,6 +109,12 @@ void DrawEndingScreen(void);
 void UnloadEndingScreen(void);
 int FinishEndingScreen(void);
 
+//----------------------------------------------------------------------------------
+// Glove Sample Queue (raylib_game.c)
+//----------------------------------------------------------------------------------
+// Oldest queued sample from glove pipe 1 (right) or 2 (left); 0 if none
+int PopGloveSample(int pipe, struct dp_packet *pkt);
+
 #ifdef __cplusplus
 }
 #endif
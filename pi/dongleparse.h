@@ -19,9 +19,169 @@ struct dp_packet {
     uint16_t seq;
     Sensor accel;
     Sensor gyro;
+    /* Dongle built with CONFIG_DONGLE_RX_TIMESTAMP only, else timed = 0.
+       Dongle clock in us, wraps at 2^32: compare with (int32_t)(a - b). */
+    uint8_t timed;
+    uint32_t rx_us;     /* packet came off the radio */
+    uint32_t out_us;    /* frame queued for USB on the dongle */
+    uint64_t host_us;   /* CLOCK_MONOTONIC when the frame was read here */
 };
 
+/* On-glove attitude estimate (imu_tx built with CONFIG_IMU_TX_AHRS).
+   seq matches the raw dp_packet of the same sample when both are streamed. */
+struct dp_ahrs {
+    uint8_t pipe;
+    uint8_t button;
+    uint16_t seq;
+    float q[4];         /* w, x, y, z */
+    Sensor lin_accel;   /* body frame, gravity removed, m/s^2 */
+};
+
+/* Slash detected on the glove (imu_tx built with CONFIG_IMU_TX_GESTURE) */
+struct dp_gesture {
+    uint8_t pipe;
+    uint8_t button;
+    uint8_t type;       /* 1 = slash */
+    uint32_t t_ms;      /* glove uptime at the acceleration peak */
+    Sensor dir;         /* unit vector, glove body frame */
+    float magnitude;    /* peak linear accel, m/s^2 */
+};
+
+#define DP_PIPES 8
+
+/* Button press or release on a glove (glove and dongle firmware with button
+   edges). Each edge comes exactly once however often the radio repeated it. */
+struct dp_button {
+    uint8_t pipe;
+    uint8_t seq;        /* per glove, wraps; a gap means the glove dropped edges */
+    uint8_t pressed;    /* 1 = press, 0 = release */
+    uint32_t t_us;      /* glove clock at the edge, wraps: diff two for press length */
+    uint32_t age_us;    /* edge to the glove building the packet that carried it */
+    uint64_t host_us;   /* CLOCK_MONOTONIC when the frame was read here */
+};
+
+/* Dongle health, sent every second or so. Counters run from dongle boot;
+   diff two frames to get rates. */
+struct dp_pipe_stats {
+    uint32_t received;        /* radio packets from this glove */
+    uint32_t queue_dropped;   /* samples lost on the dongle before USB */
+    uint32_t fifo_overrun;    /* times the radio FIFO filled with this glove sending */
+};
 
+struct dp_stats {
+    uint32_t uptime_ms;
+    uint16_t ring_high_water; /* deepest the dongle's USB queue got since the last frame */
+    uint16_t ring_size;
+    struct dp_pipe_stats pipe[DP_PIPES];
+};
+
+/* Samples from several gloves in one frame (dongle built with
+   CONFIG_DONGLE_RX_AGGREGATE). sample[0..count-1] in pipe order. */
+struct dp_multi {
+    uint8_t present;    /* bit n set: pipe n has a sample */
+    uint8_t count;
+    struct dp_packet sample[DP_PIPES];
+};
+
+/* What each glove sample carries */
+enum dp_stream {
+    DP_STREAM_UNCHANGED = 0,
+    DP_STREAM_RAW,          /* accel + gyro, dp_packet */
+    DP_STREAM_AHRS,         /* attitude only, dp_ahrs (glove built with CONFIG_IMU_TX_AHRS) */
+    DP_STREAM_RAW_AHRS,     /* both, sharing seq */
+};
+
+/* Glove settings for dp_set_glove_config. Fields left at 0 are not changed. */
+struct dp_glove_config {
+    uint16_t odr_hz;        /* sensor rate: 12, 26, 52, 104, 208, 416, 833, 1666 */
+    uint8_t accel_fs_g;     /* 2, 4, 8, 16 */
+    uint16_t gyro_fs_dps;   /* 125, 245, 500, 1000, 2000 */
+    uint8_t batch;          /* raw samples per radio packet, 1 to the glove's CONFIG_IMU_TX_BATCH_MAX */
+    enum dp_stream stream;
+};
+
+/* A glove's answer to dp_set_glove_config: the settings now in force */
+struct dp_glove_status {
+    uint8_t pipe;
+    uint8_t id;             /* as returned by dp_set_glove_config */
+    uint8_t rejected;       /* DP_CONFIG_* bits the glove could not apply */
+    uint16_t odr_hz;
+    uint8_t accel_fs_g;
+    uint16_t gyro_fs_dps;
+    uint8_t batch;
+    enum dp_stream stream;
+};
+
+#define DP_CONFIG_ODR       0x01
+#define DP_CONFIG_ACCEL_FS  0x02
+#define DP_CONFIG_GYRO_FS   0x04
+#define DP_CONFIG_BATCH     0x08
+#define DP_CONFIG_STREAM    0x10
+
+enum dp_frame_type {
+    DP_FRAME_SAMPLE = 0,
+    DP_FRAME_AHRS,
+    DP_FRAME_GESTURE,
+    DP_FRAME_STATS,
+    DP_FRAME_MULTI,
+    DP_FRAME_GLOVE_STATUS,
+    DP_FRAME_BUTTON,
+};
+
+struct dp_frame {
+    enum dp_frame_type type;
+    union {
+        struct dp_packet sample;
+        struct dp_ahrs ahrs;
+        struct dp_gesture gesture;
+        struct dp_stats stats;
+        struct dp_multi multi;
+        struct dp_glove_status glove_status;
+        struct dp_button button;
+    } u;
+};
+
+#define DP_BUTTON_QUEUE 32
+
+/* Button edges in arrival order. dp_read_input fills it in the reader
+   thread and dp_button_pop empties it from another; with one of each no
+   lock is needed. */
+struct dp_button_queue {
+    struct dp_button ev[DP_BUTTON_QUEUE];
+    unsigned head;              /* written by the reader only */
+    unsigned tail;              /* written by the popper only */
+    uint32_t overflow;          /* edges lost with the queue full */
+    uint32_t missed[DP_PIPES];  /* edges the glove dropped, from seq gaps */
+    uint8_t last_seq[DP_PIPES];
+    uint8_t seen;               /* bit n: pipe n has sent an edge */
+};
+
+void dp_button_queue_init(struct dp_button_queue *q);
+
+/* Queue an edge. Returns 1 if queued, 0 if it was full. */
+int dp_button_push(struct dp_button_queue *q, const struct dp_button *ev);
+
+/* Oldest queued edge. Returns 1 if ev was filled, 0 if the queue is empty. */
+int dp_button_pop(struct dp_button_queue *q, struct dp_button *ev);
+
+
+/* Where a timed sample's latency went. The dongle and Pi clocks are not
+   synchronised, so USB/host delay is measured above the fastest frame seen:
+   clock_offset_us tracks the smallest host_us - out_us and creeps up slowly
+   so crystal drift between the two cannot pin it. */
+struct dp_latency {
+    int have_offset;
+    int64_t clock_offset_us;
+    uint32_t dongle_us;   /* last sample: radio to USB queue on the dongle */
+    uint32_t usb_us;      /* last sample: USB queue to read here, above the fastest */
+    uint32_t last_rx_us[DP_PIPES];
+    uint32_t rx_interval_us[DP_PIPES]; /* between the last two packets of a pipe, 0 if unknown */
+};
+
+void dp_latency_init(struct dp_latency *lat);
+
+/* Feed every sample. Returns 0 (and changes nothing) for untimed samples. */
+int dp_latency_update(struct dp_latency *lat, const struct dp_packet *pkt);
 
 /* Open the dongle serial device. Returns a file descriptor or -1 on error. */
 int dp_open(const char *path, int baud);
@@ -29,7 +189,8 @@ int dp_open(const char *path, int baud);
 /* Close device opened by dp_open. */
 void dp_close(int fd);
 
-/* Blocking read for next valid packet.
+/* Blocking read for next valid packet. Combined frames are handed out one
+   sample per call, so use a single reader per process.
    Returns:
      1  - packet successfully read and filled into pkt
      0  - EOF (peer closed)
@@ -37,6 +198,21 @@ void dp_close(int fd);
 */
 int dp_read_packet(int fd, struct dp_packet *pkt);
 
+/* dp_read_packet that also pushes the button edges it meets onto q
+   (NULL to skip them). Edges are queued as soon as they are read, ahead of
+   the sample returned. */
+int dp_read_input(int fd, struct dp_packet *pkt, struct dp_button_queue *q);
+
+/* Blocking read for the next valid frame of any type. Same return values as
+   dp_read_packet. dp_read_packet is this with non-sample frames skipped. */
+int dp_read_frame(int fd, struct dp_frame *frame);
+
+/* Change a glove's settings at runtime. The dongle passes the change on
+   with the glove's next packets and keeps repeating it until the glove
+   confirms with a DP_FRAME_GLOVE_STATUS carrying the returned id.
+   Returns the id (0-255), or -1 on a write error. */
+int dp_set_glove_config(int fd, uint8_t pipe, const struct dp_glove_config *cfg);
+
 #ifdef __cplusplus
 }
 #endif
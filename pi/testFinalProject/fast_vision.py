@@ -0,0 +1,111 @@
+# fast_vision.py
+#
+# CameraTracker with the vectorised blob tracker in pi/blobtrack instead of
+# OpenCV's blur/inRange/morphology/contours. Same interface and colours as
+# vision.py; OpenCV is only used to read the camera.
+#
+# Build the library first: make -C ../blobtrack
+import ctypes
+import os
+import time
+
+import cv2
+import numpy as np
+from datatypes import VisionData
+from vision import COLORS
+
+LIB_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                        "..", "blobtrack", "libblobtrack.so")
+
+_lib = None
+
+
+def load_lib():
+    """Loads libblobtrack.so once; OSError if it has not been built."""
+    global _lib
+    if _lib is None:
+        lib = ctypes.CDLL(LIB_PATH)
+        u8p = ctypes.POINTER(ctypes.c_uint8)
+        lib.blobtrack_new.argtypes = [ctypes.c_int, ctypes.c_int, u8p, u8p]
+        lib.blobtrack_new.restype = ctypes.c_void_p
+        lib.blobtrack_free.argtypes = [ctypes.c_void_p]
+        lib.blobtrack_free.restype = None
+        lib.blobtrack_track.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t,
+                                        ctypes.POINTER(ctypes.c_float)]
+        lib.blobtrack_track.restype = ctypes.c_int
+        lib.blobtrack_reset.argtypes = [ctypes.c_void_p]
+        lib.blobtrack_reset.restype = None
+        lib.blobtrack_isa.argtypes = []
+        lib.blobtrack_isa.restype = ctypes.c_char_p
+        _lib = lib
+    return _lib
+
+
+class FastCameraTracker:
+
+    def __init__(self, camera_id=0, width=320, height=240):
+        self.lib = load_lib()
+        self.cap = cv2.VideoCapture(camera_id)
+        if not self.cap.isOpened():
+            print(f"Warning: Camera {camera_id} failed to open.")
+
+        self.cap.set(cv2.CAP_PROP_FRAME_WIDTH, width)
+        self.cap.set(cv2.CAP_PROP_FRAME_HEIGHT, height)
+
+        self.colors = COLORS
+        # One native tracker per color; each remembers where its blob was.
+        # Keyed on the frame size too, as the camera may not honour ours.
+        self.trackers = {}
+        self.out = (ctypes.c_float * 3)()
+
+    def isa(self):
+        return self.lib.blobtrack_isa().decode()
+
+    def _tracker(self, target_color, w, h):
+        key = (target_color, w, h)
+        t = self.trackers.get(key)
+        if t is None:
+            lower, upper = self.colors[target_color]
+            lo = (ctypes.c_uint8 * 3)(*[min(int(v), 255) for v in lower])
+            hi = (ctypes.c_uint8 * 3)(*[min(int(v), 255) for v in upper])
+            t = self.lib.blobtrack_new(w, h, lo, hi)
+            if not t:
+                raise ValueError(f"blobtrack: can't track {w}x{h} frames")
+            self.trackers[key] = t
+        return t
+
+    def get_position(self, target_color="green") -> VisionData:
+        """
+        Reads a frame and finds the position of the specified color.
+        """
+        success, frame = self.cap.read()
+        if not success:
+            return VisionData(valid=False, timestamp=time.time())
+        return self.find(frame, target_color)
+
+    def find(self, frame, target_color="green") -> VisionData:
+        """
+        Finds the specified color in one BGR frame, as read from the camera.
+        """
+        if frame.dtype != np.uint8 or frame.ndim != 3 or frame.shape[2] != 3:
+            raise ValueError("expected an 8-bit BGR frame")
+        if frame.strides[1:] != (3, 1):
+            frame = np.ascontiguousarray(frame)
+
+        h, w, _ = frame.shape
+        t = self._tracker(target_color, w, h)
+        found = self.lib.blobtrack_track(t, frame.ctypes.data, frame.strides[0], self.out)
+        if found:
+            return VisionData(True, self.out[0], self.out[1], target_color, time.time())
+        return VisionData(valid=False, timestamp=time.time())
+
+    def reset(self):
+        """Forget where the blobs were, e.g. after the camera has moved."""
+        for t in self.trackers.values():
+            self.lib.blobtrack_reset(t)
+
+    def close(self):
+        for t in self.trackers.values():
+            self.lib.blobtrack_free(t)
+        self.trackers = {}
+        self.cap.release()
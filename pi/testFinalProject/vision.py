@@ -4,6 +4,15 @@ import numpy as np
 import time
 from datatypes import VisionData
 
+# Color Configuration Dictionary
+# Format: "name": (Lower_HSV, Upper_HSV)
+# Shared with fast_vision.py
+COLORS = {
+    "green": (np.array([40, 40, 40]), np.array([80, 255, 255])),
+    # Red is tricky in HSV (it wraps around 0). This covers 170-180 range.
+    "red":   (np.array([170, 100, 100]), np.array([180, 255, 255])) 
+}
+
 class CameraTracker:
 
     def __init__(self, camera_id=0, width=320, height=240):
@@ -17,13 +26,7 @@ class CameraTracker:
         self.cap.set(cv2.CAP_PROP_FRAME_WIDTH, width)
         self.cap.set(cv2.CAP_PROP_FRAME_HEIGHT, height)
 
-        # Color Configuration Dictionary
-        # Format: "name": (Lower_HSV, Upper_HSV)
-        self.colors = {
-            "green": (np.array([40, 40, 40]), np.array([80, 255, 255])),
-            # Red is tricky in HSV (it wraps around 0). This covers 170-180 range.
-            "red":   (np.array([170, 100, 100]), np.array([180, 255, 255])) 
-        }
+        self.colors = COLORS
 
 
     def get_position(self, target_color="green") -> VisionData:
@@ -34,6 +37,18 @@ class CameraTracker:
         if not success:
             return VisionData(valid=False, timestamp=time.time())
 
+        result = self.find(frame, target_color)
+
+        # Optional: show frame for debugging
+        # cv2.imshow(f"Tracker - {target_color}", frame)
+        cv2.waitKey(1)
+
+        return result
+
+    def find(self, frame, target_color="green") -> VisionData:
+        """
+        Finds the specified color in one BGR frame, as read from the camera.
+        """
         # Preprocessing
         frame = cv2.flip(frame, 1)
         blurred = cv2.GaussianBlur(frame, (11, 11), 0)
@@ -63,14 +78,9 @@ class CameraTracker:
                 # Optional: Show debug window
                 # cv2.circle(frame, (int(x), int(y)), int(radius), (0, 255, 255), 2)
                 # cv2.imshow(f"Tracker - {target_color}", frame)
-                cv2.waitKey(1)
 
                 return VisionData(True, norm_x, norm_y, target_color, time.time())
 
-        # If nothing found, show frame anyway for debugging
-        # cv2.imshow(f"Tracker - {target_color}", frame)
-        cv2.waitKey(1)
-        
         return VisionData(valid=False, timestamp=time.time())
 
     def close(self):